@@ -0,0 +1,49 @@
+#!/bin/bash
+
+# Run one of the recorder's bpftrace scripts against a running recorder.
+# The .bt files name the binary as @RECORDER@; this fills in the real path
+# (USDT probes are attached per binary) and limits tracing to that process.
+#
+# Usage: sudo ./trace.sh <script.bt> [recorder pid]
+#   e.g. sudo ./trace.sh capture_to_disk.bt
+#        sudo ./trace.sh ring_sync.bt $(pidof recorder)
+#
+# List the probes compiled into a binary with:
+#   sudo bpftrace -l 'usdt:/path/to/recorder:robodaq:*'
+
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+
+if [[ $# -lt 1 || "$1" == "--help" || "$1" == "-h" ]]; then
+    echo "Usage: $0 <script.bt> [recorder pid]"
+    echo "Scripts:"
+    ls "$SCRIPT_DIR"/*.bt | xargs -n1 basename | sed 's/^/  /'
+    exit 0
+fi
+
+script="$1"
+if [[ ! -f "$script" ]]; then
+    script="$SCRIPT_DIR/$script"
+fi
+if [[ ! -f "$script" ]]; then
+    echo "No such script: $1"
+    exit 1
+fi
+
+pid="${2:-$(pgrep -xo recorder || true)}"
+if [[ -z "$pid" ]]; then
+    echo "No running recorder found; pass its pid"
+    exit 1
+fi
+
+binary="$(readlink -f "/proc/$pid/exe")"
+if ! command -v bpftrace &> /dev/null; then
+    echo "bpftrace not found. Install with: sudo apt install bpftrace"
+    exit 1
+fi
+
+generated="$(mktemp --suffix=.bt)"
+trap 'rm -f "$generated"' EXIT
+sed "s|@RECORDER@|$binary|g" "$script" > "$generated"
+bpftrace -p "$pid" "$generated"
@@ -0,0 +1,263 @@
+/*
+Goal: measure what SharedFrameRing costs across processes: how long after the
+recorder completes a frame a reader process sees it, and that a slow reader
+costs the writer nothing.
+
+The writer (this process) publishes --width x --height YUYV frames at --rate Hz
+(0 = flat out) for --seconds. Reader processes are forked and open the ring by
+name, like an external tool would. Each configuration runs with 1, 2, 4 ...
+--max-readers spinning readers, plus one extra reader that sleeps --slow-ms per
+frame.
+
+Every frame carries its ring sequence in its first and last 8 bytes. Readers
+check both in place and then still_valid(), so the bench doubles as a check
+that a reader never accepts a torn frame.
+
+Reported per reader: frames read, dropped, torn (rejected by still_valid),
+errors (accepted but wrong), publish-to-read latency p50/p99/max (us).
+Reported for the writer: publish time (begin_write..end_write incl. the
+frame copy) p50/p99/max (us).
+
+Usage:
+  frame_shm_bench [--seconds S] [--rate HZ] [--width W] [--height H]
+                  [--slots N] [--max-readers N] [--slow-ms MS] [--json out.json]
+*/
+
+#include "../src/shared_frame_ring.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct LatencyStats {
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+LatencyStats summarize(std::vector<uint64_t>& samples_ns) {
+    LatencyStats stats;
+    if (samples_ns.empty()) {
+        return stats;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    stats.p50 = samples_ns[samples_ns.size() / 2] / 1000.0;
+    stats.p99 = samples_ns[std::min(samples_ns.size() - 1, samples_ns.size() * 99 / 100)] / 1000.0;
+    stats.max = samples_ns.back() / 1000.0;
+    return stats;
+}
+
+struct BenchConfig {
+    double seconds = 2.0;
+    int rate_hz = 30;
+    uint32_t width = 640;
+    uint32_t height = 480;
+    int slots = FRAME_SHM_DEFAULT_SLOTS;
+    int max_readers = 4;
+    int slow_ms = 50;
+};
+
+// Runs in the forked child; writes one JSON line to out_fd
+void run_reader(const std::string& shm_name, int reader_id, int sleep_ms, int out_fd) {
+    SharedFrameReader reader;
+    std::string line;
+    if (!reader.open(shm_name)) {
+        line = "{\"reader\":" + std::to_string(reader_id) + ",\"error\":\"open failed\"}\n";
+        (void)!write(out_fd, line.data(), line.size());
+        return;
+    }
+
+    uint64_t frames = 0;
+    uint64_t torn = 0;
+    uint64_t errors = 0;
+    std::vector<uint64_t> latency_ns;
+    latency_ns.reserve(1 << 16);
+    while (true) {
+        SharedFrameView view;
+        if (!reader.next(view)) {
+            if (reader.writer_closed()) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        uint64_t seen_ns = frame_ring_now_ns();
+        uint64_t head;
+        uint64_t tail;
+        std::memcpy(&head, view.data, sizeof(head));
+        std::memcpy(&tail, view.data + view.info.size_bytes - sizeof(tail), sizeof(tail));
+        if (sleep_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        }
+        if (!reader.still_valid(view)) {
+            torn++;
+            continue;
+        }
+        if (head != view.ring_sequence || tail != view.ring_sequence) {
+            errors++;
+        }
+        frames++;
+        latency_ns.push_back(seen_ns - view.info.publish_ns);
+    }
+
+    LatencyStats latency = summarize(latency_ns);
+    std::ostringstream json;
+    json << "{\"reader\":" << reader_id
+         << ",\"slow\":" << (sleep_ms > 0 ? "true" : "false")
+         << ",\"frames\":" << frames
+         << ",\"dropped\":" << reader.dropped()
+         << ",\"torn\":" << torn
+         << ",\"errors\":" << errors
+         << ",\"latency_p50_us\":" << latency.p50
+         << ",\"latency_p99_us\":" << latency.p99
+         << ",\"latency_max_us\":" << latency.max
+         << "}\n";
+    line = json.str();
+    (void)!write(out_fd, line.data(), line.size());
+}
+
+// Returns JSON lines: one for the writer, one per reader
+std::vector<std::string> run_config(const BenchConfig& config, int readers, bool with_slow_reader, uint64_t& errors) {
+    const std::string shm_name = "/robodaq_frame_shm_bench_" + std::to_string(getpid());
+    const uint32_t frame_bytes = config.width * config.height * 2;
+    SharedFrameWriter writer;
+    if (!writer.create(shm_name, config.slots, frame_bytes)) {
+        return {};
+    }
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0) {
+        return {};
+    }
+    std::vector<pid_t> children;
+    const int total_readers = readers + (with_slow_reader ? 1 : 0);
+    for (int r = 0; r < total_readers; r++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            run_reader(shm_name, r, r == readers ? config.slow_ms : 0, pipe_fds[1]);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    close(pipe_fds[1]);
+    // Let the readers map the ring before the clock starts
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::vector<uint64_t> publish_ns;
+    std::vector<uint8_t> source(frame_bytes, 0x80);
+    const uint64_t period_ns = config.rate_hz > 0 ? 1'000'000'000ull / config.rate_hz : 0;
+    const uint64_t end_ns = frame_ring_now_ns() + static_cast<uint64_t>(config.seconds * 1e9);
+    uint64_t next_ns = frame_ring_now_ns();
+    for (uint64_t sequence = 0; frame_ring_now_ns() < end_ns; sequence++) {
+        if (period_ns) {
+            while (frame_ring_now_ns() < next_ns) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            next_ns += period_ns;
+        }
+        std::memcpy(source.data(), &sequence, sizeof(sequence));
+        std::memcpy(source.data() + frame_bytes - sizeof(sequence), &sequence, sizeof(sequence));
+
+        uint64_t start = frame_ring_now_ns();
+        SharedFrameInfo info;
+        info.frame_sequence = sequence;
+        info.timestamp_us = start / 1000;
+        info.width = config.width;
+        info.height = config.height;
+        info.fourcc = FRAME_FOURCC_YUYV;
+        info.size_bytes = frame_bytes;
+        writer.publish(info, source.data());
+        publish_ns.push_back(frame_ring_now_ns() - start);
+    }
+    const uint64_t published = writer.published();
+    // Readers stop once they see the writer close
+    writer.close();
+
+    std::string output;
+    char buffer[4096];
+    ssize_t n;
+    while ((n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) {
+        output.append(buffer, n);
+    }
+    close(pipe_fds[0]);
+    for (pid_t pid : children) {
+        waitpid(pid, nullptr, 0);
+    }
+
+    LatencyStats publish = summarize(publish_ns);
+    std::ostringstream writer_json;
+    writer_json << "{\"role\":\"writer\",\"readers\":" << readers
+                << ",\"slow_reader\":" << (with_slow_reader ? "true" : "false")
+                << ",\"rate_hz\":" << config.rate_hz
+                << ",\"frame_bytes\":" << frame_bytes
+                << ",\"published\":" << published
+                << ",\"publish_p50_us\":" << publish.p50
+                << ",\"publish_p99_us\":" << publish.p99
+                << ",\"publish_max_us\":" << publish.max
+                << "}";
+    std::vector<std::string> lines{writer_json.str()};
+    std::istringstream reader_lines(output);
+    std::string line;
+    while (std::getline(reader_lines, line)) {
+        if (line.find("\"errors\":0,") == std::string::npos) {
+            errors++;
+        }
+        lines.push_back("{\"role\":\"reader\",\"readers\":" + std::to_string(readers) + "," + line.substr(1));
+    }
+    return lines;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    std::string json_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) config.seconds = std::stod(argv[++i]);
+        else if (arg == "--rate" && i + 1 < argc) config.rate_hz = std::stoi(argv[++i]);
+        else if (arg == "--width" && i + 1 < argc) config.width = std::stoul(argv[++i]);
+        else if (arg == "--height" && i + 1 < argc) config.height = std::stoul(argv[++i]);
+        else if (arg == "--slots" && i + 1 < argc) config.slots = std::stoi(argv[++i]);
+        else if (arg == "--max-readers" && i + 1 < argc) config.max_readers = std::stoi(argv[++i]);
+        else if (arg == "--slow-ms" && i + 1 < argc) config.slow_ms = std::stoi(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc) json_path = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--seconds S] [--rate HZ] [--width W] [--height H]"
+                      << " [--slots N] [--max-readers N] [--slow-ms MS] [--json out.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t errors = 0;
+    std::vector<std::string> results;
+    for (int readers = 1; readers <= config.max_readers; readers *= 2) {
+        for (bool slow : {false, true}) {
+            for (const auto& line : run_config(config, readers, slow, errors)) {
+                std::cout << line << std::endl;
+                results.push_back(line);
+            }
+        }
+    }
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        for (const auto& line : results) {
+            out << line << "\n";
+        }
+        std::cout << "Results written to: " << json_path << std::endl;
+    }
+    if (errors) {
+        std::cerr << errors << " readers accepted corrupted frames or failed to open the ring" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+Goal: show what a latest-value read/write costs under contention, so the
+teleop/VR paths can pick LatestValueMailbox over a lock or a queue with numbers.
+
+One writer publishes a 64-byte pose (at --rate Hz, or flat out with --rate 0)
+while N readers spin reading it. Each configuration runs three ways:
+  seqlock      LatestValueMailbox, in-process storage
+  seqlock_shm  LatestValueMailbox over a POSIX shm object
+  mutex        std::mutex around a plain value, for comparison
+
+Reported per configuration: publish and read latency (p50/p99/max, ns; every
+reader samples one read in READ_SAMPLE_EVERY), reads per second, the fraction
+of seqlock read attempts that raced a write, and staleness (now minus the
+timestamp in the value read, p99, us), and hardware counters per operation
+(publish or read; see perf_counters.hpp), null where not permitted.
+
+Usage:
+  latest_value_bench [--seconds S] [--rate HZ] [--max-readers N] [--json out.json]
+*/
+
+#include "../src/latest_value_mailbox.hpp"
+#include "../src/perf_counters.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+constexpr int READ_SAMPLE_EVERY = 64;
+
+// Same shape as a VR controller pose: timestamp, position, orientation
+struct Pose {
+    uint64_t timestamp_ns;
+    double position[3];
+    double orientation[4];
+};
+static_assert(sizeof(Pose) == 64, "bench payload is one cache line");
+
+uint64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class MutexValue {
+public:
+    void publish(const Pose& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_ = value;
+        has_value_ = true;
+    }
+    bool try_read(Pose& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value = value_;
+        return has_value_;
+    }
+private:
+    std::mutex mutex_;
+    Pose value_{};
+    bool has_value_ = false;
+};
+
+struct LatencyStats {
+    double p50 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+LatencyStats summarize(std::vector<uint64_t>& samples) {
+    LatencyStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.p50 = samples[samples.size() / 2];
+    stats.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    stats.max = samples.back();
+    return stats;
+}
+
+struct BenchResult {
+    std::string mode;
+    int readers = 0;
+    int rate_hz = 0;
+    uint64_t publishes = 0;
+    uint64_t reads = 0;
+    double reads_per_sec = 0;
+    double retry_fraction = 0;
+    LatencyStats publish_ns;
+    LatencyStats read_ns;
+    LatencyStats staleness_us;
+    std::string counters;         // PerfCounters::json_fields per publish/read
+};
+
+template<typename Box>
+BenchResult run_bench(Box& box, const std::string& mode, int readers, int rate_hz, double seconds,
+                      PerfCounters& counters) {
+    std::atomic<bool> running{true};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> publish_samples;
+    std::vector<std::vector<uint64_t>> read_samples(readers);
+    std::vector<std::vector<uint64_t>> stale_samples(readers);
+    std::vector<uint64_t> reads(readers, 0);
+    std::vector<uint64_t> attempts(readers, 0);
+    uint64_t publishes = 0;
+
+    counters.reset();
+    std::thread writer([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        while (!go.load()) {}
+        const uint64_t period_ns = rate_hz > 0 ? 1'000'000'000ull / rate_hz : 0;
+        uint64_t next_ns = steady_now_ns();
+        Pose pose{};
+        while (running.load(std::memory_order_relaxed)) {
+            if (period_ns) {
+                // Spin rather than sleep so publish timing isn't scheduler noise
+                while (steady_now_ns() < next_ns) {}
+                next_ns += period_ns;
+            }
+            pose.position[0] += 1e-3;
+            uint64_t start = steady_now_ns();
+            pose.timestamp_ns = start;
+            box.publish(pose);
+            uint64_t end = steady_now_ns();
+            if (period_ns || publishes % READ_SAMPLE_EVERY == 0) {
+                publish_samples.push_back(end - start);
+            }
+            publishes++;
+        }
+    });
+
+    std::vector<std::thread> reader_threads;
+    for (int r = 0; r < readers; r++) {
+        reader_threads.emplace_back([&, r]() {
+            PerfCounters::ThreadScope scope(counters);
+            while (!go.load()) {}
+            Pose pose;
+            uint64_t local_reads = 0;
+            uint64_t local_attempts = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                bool sample = local_reads % READ_SAMPLE_EVERY == 0;
+                uint64_t start = sample ? steady_now_ns() : 0;
+                bool ok = false;
+                while (!ok && running.load(std::memory_order_relaxed)) {
+                    local_attempts++;
+                    ok = box.try_read(pose);
+                }
+                if (!ok) {
+                    break;
+                }
+                if (sample) {
+                    uint64_t end = steady_now_ns();
+                    read_samples[r].push_back(end - start);
+                    stale_samples[r].push_back((end - pose.timestamp_ns) / 1000);
+                }
+                local_reads++;
+            }
+            reads[r] = local_reads;
+            attempts[r] = local_attempts;
+        });
+    }
+
+    // Readers need something to read before the clock starts
+    box.publish(Pose{steady_now_ns(), {0, 0, 0}, {1, 0, 0, 0}});
+    go.store(true);
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running.store(false);
+    writer.join();
+    for (auto& thread : reader_threads) {
+        thread.join();
+    }
+
+    BenchResult result;
+    result.mode = mode;
+    result.readers = readers;
+    result.rate_hz = rate_hz;
+    result.publishes = publishes;
+    std::vector<uint64_t> all_reads;
+    std::vector<uint64_t> all_stale;
+    uint64_t total_attempts = 0;
+    for (int r = 0; r < readers; r++) {
+        result.reads += reads[r];
+        total_attempts += attempts[r];
+        all_reads.insert(all_reads.end(), read_samples[r].begin(), read_samples[r].end());
+        all_stale.insert(all_stale.end(), stale_samples[r].begin(), stale_samples[r].end());
+    }
+    result.reads_per_sec = result.reads / seconds;
+    result.retry_fraction = total_attempts ? 1.0 - static_cast<double>(result.reads) / total_attempts : 0.0;
+    result.publish_ns = summarize(publish_samples);
+    result.read_ns = summarize(all_reads);
+    result.staleness_us = summarize(all_stale);
+    result.counters = counters.json_fields(result.publishes + result.reads);
+    return result;
+}
+
+std::string result_json(const BenchResult& r) {
+    std::ostringstream json;
+    json << "{\"mode\":\"" << r.mode << "\""
+         << ",\"readers\":" << r.readers
+         << ",\"rate_hz\":" << r.rate_hz
+         << ",\"publishes\":" << r.publishes
+         << ",\"reads_per_sec\":" << static_cast<uint64_t>(r.reads_per_sec)
+         << ",\"retry_fraction\":" << r.retry_fraction
+         << ",\"publish_p50_ns\":" << r.publish_ns.p50
+         << ",\"publish_p99_ns\":" << r.publish_ns.p99
+         << ",\"publish_max_ns\":" << r.publish_ns.max
+         << ",\"read_p50_ns\":" << r.read_ns.p50
+         << ",\"read_p99_ns\":" << r.read_ns.p99
+         << ",\"read_max_ns\":" << r.read_ns.max
+         << ",\"staleness_p99_us\":" << r.staleness_us.p99
+         << r.counters
+         << "}";
+    return json.str();
+}
+
+int main(int argc, char** argv) {
+    double seconds = 2.0;
+    int rate_hz = 1000;
+    int max_readers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::string json_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc) seconds = std::stod(argv[++i]);
+        else if (arg == "--rate" && i + 1 < argc) rate_hz = std::stoi(argv[++i]);
+        else if (arg == "--max-readers" && i + 1 < argc) max_readers = std::stoi(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc) json_path = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--seconds S] [--rate HZ] [--max-readers N] [--json out.json]" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string shm_name = "/robodaq_latest_value_bench_" + std::to_string(getpid());
+    PerfCounters counters;
+    if (!counters.open()) {
+        std::cout << "Hardware counters unavailable (" << counters.error() << ")" << std::endl;
+    }
+    std::vector<BenchResult> results;
+    for (int readers = 1; readers <= max_readers; readers *= 2) {
+        {
+            LatestValueMailbox<Pose> mailbox;
+            results.push_back(run_bench(mailbox, "seqlock", readers, rate_hz, seconds, counters));
+            std::cout << result_json(results.back()) << std::endl;
+        }
+        {
+            LatestValueMailbox<Pose> writer_side;
+            LatestValueMailbox<Pose> reader_side;
+            if (writer_side.create_shared(shm_name) && reader_side.open_shared(shm_name)) {
+                // Writes go through one mapping, reads through another, as across processes
+                struct SplitBox {
+                    LatestValueMailbox<Pose>& writer;
+                    LatestValueMailbox<Pose>& reader;
+                    void publish(const Pose& value) { writer.publish(value); }
+                    bool try_read(Pose& value) { return reader.try_read(value); }
+                } split{writer_side, reader_side};
+                results.push_back(run_bench(split, "seqlock_shm", readers, rate_hz, seconds, counters));
+                std::cout << result_json(results.back()) << std::endl;
+            }
+        }
+        {
+            MutexValue locked;
+            results.push_back(run_bench(locked, "mutex", readers, rate_hz, seconds, counters));
+            std::cout << result_json(results.back()) << std::endl;
+        }
+    }
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        for (const auto& result : results) {
+            out << result_json(result) << "\n";
+        }
+        std::cout << "Results written to: " << json_path << std::endl;
+    }
+    return 0;
+}
@@ -12,6 +12,7 @@ Implement a bounded blocking queue using std::mutex + std::condition_variable, t
 #include <chrono>
 #include <atomic>
 #include "../src/mpmc_ring_buffer.hpp"
+#include "../src/perf_counters.hpp"
 
 // [0,1,2,3,4]
 // [null, null, null, null, null]
@@ -71,6 +72,10 @@ int main() {
     std::cout << "Starting performance test..." << std::endl;
     std::cout << "Buffer size: " << buffer_size << std::endl;
     std::cout << "Items to process: " << num_items << std::endl;
+    PerfCounters counters;
+    if (!counters.open()) {
+        std::cout << "Hardware counters unavailable (" << counters.error() << ")" << std::endl;
+    }
     
     // Scenario A: 1 producer / 1 consumer
     std::cout << "\n=== Scenario A: 1 Producer / 1 Consumer ===" << std::endl;
@@ -81,11 +86,18 @@ int main() {
     stop_producer = false;
     stop_consumer = false;
 
+    counters.reset();
     auto start_time = std::chrono::steady_clock::now();
     
     // Create and start threads
-    std::thread producer(producer_thread, std::ref(ring_buffer), num_items);
-    std::thread consumer(consumer_thread, std::ref(ring_buffer), num_items);
+    std::thread producer([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        producer_thread(ring_buffer, num_items);
+    });
+    std::thread consumer([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        consumer_thread(ring_buffer, num_items);
+    });
     
     // Wait for both threads to complete
     producer.join();
@@ -98,6 +110,7 @@ int main() {
     std::cout << "Time taken: " << duration.count() << " ms" << std::endl;
     std::cout << "Total operations: " << (total_produced + total_consumed) << std::endl;
     std::cout << "Operations per second: " << (total_produced + total_consumed) * 1000 / duration.count() << std::endl;
+    std::cout << "Counters: {" << counters.json_fields(total_produced + total_consumed).substr(1) << "}" << std::endl;
     
     // Scenario B: 1 producer / 2 consumers
     std::cout << "\n=== Scenario B: 1 Producer / 2 Consumers ===" << std::endl;
@@ -108,12 +121,22 @@ int main() {
     stop_producer = false;
     stop_consumer = false;
 
+    counters.reset();
     start_time = std::chrono::steady_clock::now();
     
     // Create and start threads
-    std::thread producer2(producer_thread, std::ref(ring_buffer), num_items);
-    std::thread consumer1(consumer_thread, std::ref(ring_buffer), num_items / 2);
-    std::thread consumer2(consumer_thread, std::ref(ring_buffer), num_items / 2);
+    std::thread producer2([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        producer_thread(ring_buffer, num_items);
+    });
+    std::thread consumer1([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        consumer_thread(ring_buffer, num_items / 2);
+    });
+    std::thread consumer2([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        consumer_thread(ring_buffer, num_items / 2);
+    });
     
     // Wait for all threads to complete
     producer2.join();
@@ -127,6 +150,7 @@ int main() {
     std::cout << "Time taken: " << duration.count() << " ms" << std::endl;
     std::cout << "Total operations: " << (total_produced + total_consumed) << std::endl;
     std::cout << "Operations per second: " << (total_produced + total_consumed) * 1000 / duration.count() << std::endl;
+    std::cout << "Counters: {" << counters.json_fields(total_produced + total_consumed).substr(1) << "}" << std::endl;
     
     return 0;
 }
@@ -0,0 +1,636 @@
+/*
+Goal: measure how much the whole capture -> ring -> sync -> convert -> encode -> disk
+path can sustain on this box, so we know before deploying whether a change
+lowers the number of cameras per rig.
+
+Drives N synthetic YUYV cameras (one producer thread each, paced like v4l2)
+into BroadcastRing<CameraFrame>s sized like the recorder's default rings,
+matches them on a sync thread with the recorder's SyncMatcher (camera 0 is
+the trigger), and writes every camera in place through VideoWriter.
+For each resolution and frame rate, cameras are added until frames drop.
+
+Usage:
+  recorder_e2e_bench [--max-cameras N] [--seconds S] [--output-dir DIR]
+                     [--json out.json] [--compare baseline.json] [--tolerance 0.10]
+
+--compare exits with status 1 if any configuration regressed by more than
+--tolerance against the baseline (generate one on the reference rig with
+--json bench/baselines/recorder_e2e.json and commit it).
+
+  recorder_e2e_bench --alloc-check [--alloc-frames N] [--alloc-budget stage=N ...]
+
+--alloc-check instead runs the recorder's own frame path once (two cameras into
+BroadcastRings via a FrameCallback, then sync_next_bundle() -- the function
+Recorder::sync_thread_func calls -- with OutputStriper, SyncLogger and
+PerformanceMonitor) and counts allocations per stage over --alloc-frames
+bundles after a warmup. It exits with status 1 if any stage allocates more
+than its budget per bundle (default 0: steady-state recording must not
+allocate). Needs an instrumentation build (-DRECORDER_ALLOC_STATS=ON);
+.github/workflows/ci.yml runs it with the default budgets on every push.
+*/
+
+#include "../src/alloc_stats.hpp"
+#include "../src/broadcast_ring.hpp"
+#include "../src/jsonl_parse.hpp"
+#include "../src/performance_monitor.hpp"
+#include "../src/recorder.hpp"
+#include "../src/sync_bundle.hpp"
+#include "../src/sync_logger.hpp"
+#include "../src/video_writer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <unistd.h>
+
+constexpr double WARMUP_SECONDS = 0.5;          // latency samples before this are dropped
+constexpr double MAX_DROP_FRACTION = 0.001;     // "sustainable" = under 0.1% frames lost
+constexpr int ALLOC_CHECK_WARMUP_BUNDLES = 60;  // first-use allocations (reserve, encoder init) happen here
+constexpr int ALLOC_CHECK_FPS = 60;
+
+struct BenchConfig {
+    int cameras;
+    int width;
+    int height;
+    int fps;
+};
+
+struct BenchResult {
+    BenchConfig config;
+    double offered_fps = 0;       // frames/sec produced across all cameras
+    double written_fps = 0;       // frames/sec that made it to disk
+    uint64_t ring_drops = 0;
+    uint64_t sync_misses = 0;
+    double p50_latency_us = 0;
+    double p99_latency_us = 0;
+    double capture_cpu_pct = 0;   // summed over producer threads
+    double sync_cpu_pct = 0;      // matching only
+    double write_cpu_pct = 0;     // convert + encode + disk, on the sync thread
+    uint64_t bytes_written = 0;
+    bool sustainable = false;
+};
+
+double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Moving gradient + per-frame noise so the encoder does realistic work
+void fill_pattern(std::vector<uint8_t>& data, int width, int height, uint64_t seq, uint32_t& rng) {
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = data.data() + static_cast<size_t>(y) * width * 2;
+        for (int x = 0; x < width * 2; x += 2) {
+            rng = rng * 1664525u + 1013904223u;
+            row[x] = static_cast<uint8_t>((x / 2 + y + seq * 4) & 0xff) ^ ((rng >> 28) & 0x3);
+            row[x + 1] = static_cast<uint8_t>(128 + ((y + seq) & 0x1f));
+        }
+    }
+}
+
+void producer_thread(
+    int camera, const BenchConfig& config, BroadcastRing<CameraFrame>& ring,
+    std::atomic<bool>& running, std::atomic<uint64_t>& drops, std::atomic<uint64_t>& produced,
+    double& cpu_seconds
+) {
+    // A few pre-rendered frames stand in for the v4l2 buffers
+    const size_t frame_bytes = static_cast<size_t>(config.width) * config.height * 2;
+    std::vector<std::vector<uint8_t>> patterns(8, std::vector<uint8_t>(frame_bytes));
+    uint32_t rng = 12345 + camera;
+    for (size_t i = 0; i < patterns.size(); i++) {
+        fill_pattern(patterns[i], config.width, config.height, i, rng);
+    }
+
+    const auto period = std::chrono::nanoseconds(1'000'000'000LL / config.fps);
+    auto next = std::chrono::steady_clock::now();
+    uint64_t seq = 0;
+    const double cpu_start = thread_cpu_seconds();
+
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_until(next);
+        next += period;
+
+        // Same work as CameraPipeline::on_new_sample_: build a frame, copy the buffer
+        CameraFrame frame;
+        frame.sequence_number = ++seq;
+        frame.timestamp_us = steady_now_us();
+        frame.device_name = "/dev/cam_" + std::to_string(camera);
+        frame.width = config.width;
+        frame.height = config.height;
+        frame.format = CameraFormat::YUYV;
+        const std::vector<uint8_t>& src = patterns[seq % patterns.size()];
+        frame.image_data.resize(src.size());
+        std::memcpy(frame.image_data.data(), src.data(), src.size());
+
+        produced++;
+        if (!ring.push(frame)) {
+            drops++;
+        }
+    }
+    cpu_seconds = thread_cpu_seconds() - cpu_start;
+}
+
+BenchResult run_config(const BenchConfig& config, double seconds, const std::string& output_dir) {
+    BenchResult result;
+    result.config = config;
+
+    std::string run_dir = output_dir + "/e2e_" + std::to_string(config.cameras) + "x" 
+        + std::to_string(config.width) + "x" + std::to_string(config.height) + "@" + std::to_string(config.fps);
+    std::filesystem::create_directories(run_dir);
+
+    std::vector<std::unique_ptr<BroadcastRing<CameraFrame>>> rings;
+    std::vector<int> sync_consumers;
+    std::vector<std::unique_ptr<VideoWriter>> writers;
+    for (int c = 0; c < config.cameras; c++) {
+        rings.push_back(std::make_unique<BroadcastRing<CameraFrame>>(
+            ring_buffer_frames(RING_BUFFER_DEFAULT_SECONDS, config.fps)
+        ));
+        sync_consumers.push_back(rings.back()->add_consumer(ConsumerPolicy::BLOCKING));
+        writers.push_back(std::make_unique<VideoWriter>());
+        if (!writers.back()->initialize(run_dir + "/cam_" + std::to_string(c) + ".mp4", 
+                                        config.width, config.height, config.fps)) {
+            return result;
+        }
+    }
+
+    std::atomic<bool> producers_running{true};
+    std::atomic<bool> sync_running{true};
+    std::atomic<uint64_t> ring_drops{0};
+    std::atomic<uint64_t> produced{0};
+    std::vector<double> producer_cpu(config.cameras, 0.0);
+    uint64_t written = 0;
+    uint64_t sync_misses = 0;
+    double sync_cpu = 0, write_cpu = 0;
+    std::vector<int> latencies;
+    latencies.reserve(static_cast<size_t>(seconds * config.fps * config.cameras) + 16);
+    const uint64_t start_us = steady_now_us();
+    const uint64_t warmup_end_us = start_us + static_cast<uint64_t>(WARMUP_SECONDS * 1e6);
+
+    // Camera 0 is the trigger, like cam_front in Recorder; every other camera
+    // is matched to it with the recorder's default policy and tolerance
+    const SyncMatcher matcher(RecorderOptions().sync_policy, SYNC_TOLERANCE_US);
+    std::thread sync([&]() {
+        const double cpu_start = thread_cpu_seconds();
+        std::vector<const CameraFrame*> bundle(config.cameras);
+        while (sync_running.load(std::memory_order_relaxed)) {
+            bundle[0] = rings[0]->peek(sync_consumers[0]);
+            if (!bundle[0]) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+            bool matched = true;
+            for (int c = 1; c < config.cameras && matched; c++) {
+                SyncRingSource source(rings[c].get(), sync_consumers[c]);
+                matched = matcher.match(bundle[0]->timestamp_us, source).matched;
+                bundle[c] = matched ? source.peek() : nullptr;
+            }
+            if (!matched) {
+                sync_misses++;
+                rings[0]->release(sync_consumers[0]);
+                continue;
+            }
+
+            const double write_start = thread_cpu_seconds();
+            for (int c = 0; c < config.cameras; c++) {
+                int latency_us = 0;
+                writers[c]->write_frame(*bundle[c], latency_us);
+                if (bundle[c]->timestamp_us >= warmup_end_us) {
+                    latencies.push_back(latency_us);
+                }
+                written++;
+                rings[c]->release(sync_consumers[c]);
+            }
+            write_cpu += thread_cpu_seconds() - write_start;
+        }
+        sync_cpu = thread_cpu_seconds() - cpu_start - write_cpu;
+    });
+
+    std::vector<std::thread> producers;
+    for (int c = 0; c < config.cameras; c++) {
+        producers.emplace_back(producer_thread, c, std::cref(config), std::ref(*rings[c]),
+                               std::ref(producers_running), std::ref(ring_drops), std::ref(produced),
+                               std::ref(producer_cpu[c]));
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    producers_running.store(false);
+    for (auto& t : producers) {
+        t.join();
+    }
+    // Let the sync thread drain what's queued, then stop
+    while (!rings[0]->is_empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double wall_seconds = (steady_now_us() - start_us) * 1e-6;
+    sync_running.store(false);
+    sync.join();
+
+    for (int c = 0; c < config.cameras; c++) {
+        writers[c]->finalize();
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(run_dir)) {
+        result.bytes_written += std::filesystem::file_size(entry.path());
+    }
+    std::filesystem::remove_all(run_dir);
+
+    result.offered_fps = produced.load() / wall_seconds;
+    result.written_fps = written / wall_seconds;
+    result.ring_drops = ring_drops.load();
+    result.sync_misses = sync_misses;
+    for (double cpu : producer_cpu) {
+        result.capture_cpu_pct += cpu / wall_seconds * 100.0;
+    }
+    result.sync_cpu_pct = sync_cpu / wall_seconds * 100.0;
+    result.write_cpu_pct = write_cpu / wall_seconds * 100.0;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50_latency_us = latencies[latencies.size() / 2];
+        result.p99_latency_us = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+    }
+    const uint64_t lost = result.ring_drops + result.sync_misses * config.cameras;
+    result.sustainable = produced.load() > 0 && 
+        static_cast<double>(lost) / produced.load() <= MAX_DROP_FRACTION;
+    return result;
+}
+
+struct AllocCheckConfig {
+    int frames = 300;
+    std::map<std::string, double> budgets;  // stage name -> allocations per bundle
+    std::string output_dir;
+};
+
+// Returns the number of stages over budget, or -1 if the pipeline couldn't run
+int run_alloc_check(const AllocCheckConfig& check) {
+    const int width = 640;
+    const int height = 480;
+    const std::string run_dir = check.output_dir + "/alloc_check";
+    std::filesystem::create_directories(run_dir);
+
+    const std::vector<std::string> devices = {"/dev/cam_front", "/dev/cam_right"};
+    std::vector<std::unique_ptr<BroadcastRing<CameraFrame>>> rings;
+    std::vector<int> sync_consumers;
+    std::vector<std::unique_ptr<VideoWriter>> writers;
+    OutputStriper striper;
+    for (size_t c = 0; c < devices.size(); c++) {
+        rings.push_back(std::make_unique<BroadcastRing<CameraFrame>>(
+            ring_buffer_frames(RING_BUFFER_DEFAULT_SECONDS, ALLOC_CHECK_FPS)
+        ));
+        sync_consumers.push_back(rings.back()->add_consumer(ConsumerPolicy::BLOCKING));
+        writers.push_back(std::make_unique<VideoWriter>());
+        const std::string path = run_dir + "/cam_" + std::to_string(c) + ".mp4";
+        if (!writers.back()->initialize(path, width, height, ALLOC_CHECK_FPS) ||
+            !striper.add_writer(writers.back().get(), path, static_cast<int>(c), true)) {
+            return -1;
+        }
+    }
+    striper.hold_rings(rings[0].get(), sync_consumers[0], rings[1].get(), sync_consumers[1]);
+    striper.start();
+    SyncLogger sync_logger;
+    PerformanceMonitor performance_monitor;
+    if (!sync_logger.initialize(run_dir + "/sync.jsonl") || !performance_monitor.initialize(run_dir)) {
+        return -1;
+    }
+    const SyncMatcher matcher(RecorderOptions().sync_policy, SYNC_TOLERANCE_US);
+    SyncBundleStages stages;
+    stages.front_ring = rings[0].get();
+    stages.front_consumer = sync_consumers[0];
+    stages.right_ring = rings[1].get();
+    stages.right_consumer = sync_consumers[1];
+    stages.matcher = &matcher;
+    stages.striper = &striper;
+    stages.sync_logger = &sync_logger;
+    stages.performance_monitor = &performance_monitor;
+
+    std::atomic<uint64_t> ring_drops{0};
+    // Same shape as Recorder::on_camera_frame
+    FrameCallback on_frame = [&](const CameraFrame& frame, bool) {
+        ROBODAQ_ALLOC_STAGE(AllocStage::RING);
+        BroadcastRing<CameraFrame>& ring = *rings[frame.device_name == devices[0] ? 0 : 1];
+        if (ring.push(frame)) {
+            ROBODAQ_COUNT_COPY(frame.image_data.size());
+        } else {
+            ring_drops++;
+        }
+    };
+
+    const int total_bundles = ALLOC_CHECK_WARMUP_BUNDLES + check.frames;
+    std::atomic<int> bundles{0};
+    std::atomic<uint64_t> sync_misses{0};
+    std::atomic<bool> running{true};
+
+    // The recorder's sync loop, minus its tick flag: wait until both cameras
+    // have a frame queued so lockstep capture doesn't count as sync misses
+    std::thread sync([&]() {
+        alloc_stats::name_thread("sync");
+        while (running.load(std::memory_order_relaxed)) {
+            ROBODAQ_ALLOC_STAGE(AllocStage::SYNC);
+            if (rings[0]->is_empty() || rings[1]->is_empty()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                continue;
+            }
+            switch (sync_next_bundle(stages)) {
+                case SyncBundleResult::WRITTEN:
+                    bundles++;
+                    break;
+                case SyncBundleResult::SYNC_MISS:
+                    sync_misses++;
+                    break;
+                default:
+                    break;
+            }
+        }
+    });
+
+    // Same shape as CameraPipeline::on_new_sample_; cameras tick in lockstep
+    const size_t frame_bytes = static_cast<size_t>(width) * height * 2;
+    const auto period = std::chrono::nanoseconds(1'000'000'000LL / ALLOC_CHECK_FPS);
+    const auto first_tick = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    std::vector<std::thread> producers;
+    for (size_t c = 0; c < devices.size(); c++) {
+        producers.emplace_back([&, c]() {
+            alloc_stats::name_thread(c == 0 ? "capture_front" : "capture_right");
+            std::vector<uint8_t> source(frame_bytes);
+            uint32_t rng = 777 + c;
+            fill_pattern(source, width, height, c, rng);
+            CameraFrame frame;
+            auto next = first_tick;
+            for (uint64_t seq = 1; running.load(std::memory_order_relaxed); seq++) {
+                std::this_thread::sleep_until(next);
+                next += period;
+                ROBODAQ_ALLOC_STAGE(AllocStage::CAPTURE);
+                frame.sequence_number = seq;
+                frame.timestamp_us = steady_now_us();
+                frame.device_name = devices[c];
+                frame.width = width;
+                frame.height = height;
+                frame.format = CameraFormat::YUYV;
+                frame.image_data.resize(source.size());
+                std::memcpy(frame.image_data.data(), source.data(), source.size());
+                ROBODAQ_COUNT_COPY(source.size());
+                on_frame(frame, c == 0);
+            }
+        });
+    }
+
+    // Snapshots are taken here, outside the frame path; their own
+    // allocations land in this thread's "other" stage
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10 + total_bundles / ALLOC_CHECK_FPS * 4);
+    auto wait_for_bundles = [&](int target) {
+        while (bundles.load() < target && std::chrono::steady_clock::now() < timeout) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    wait_for_bundles(ALLOC_CHECK_WARMUP_BUNDLES);
+    const int start_bundles = bundles.load();
+    std::vector<AllocCounters> before = alloc_stats::totals_by_stage(alloc_stats::snapshot());
+    wait_for_bundles(total_bundles);
+    const int measured = bundles.load() - start_bundles;
+    std::vector<AllocCounters> after = alloc_stats::totals_by_stage(alloc_stats::snapshot());
+
+    running.store(false);
+    for (auto& t : producers) {
+        t.join();
+    }
+    sync.join();
+    striper.stop();
+    for (auto& writer : writers) {
+        writer->finalize();
+    }
+    sync_logger.finalize();
+    std::filesystem::remove_all(run_dir);
+
+    if (measured <= 0) {
+        std::cerr << "alloc-check: no bundles written (ring drops " << ring_drops.load()
+                  << ", sync misses " << sync_misses.load() << ")" << std::endl;
+        return -1;
+    }
+
+    std::cout << "Steady-state allocations per bundle over " << measured << " bundles ("
+              << ring_drops.load() << " ring drops, " << sync_misses.load() << " sync misses):" << std::endl;
+    std::cout << "  " << std::left << std::setw(10) << "stage" << std::right
+              << std::setw(12) << "allocs" << std::setw(12) << "bytes"
+              << std::setw(12) << "copies" << std::setw(14) << "copied KB"
+              << std::setw(10) << "budget" << std::endl;
+    int over_budget = 0;
+    // "other" is not on the frame path (snapshots, setup) and has no budget
+    for (int s = static_cast<int>(AllocStage::OTHER) + 1; s < static_cast<int>(AllocStage::NUM_STAGES); s++) {
+        const std::string stage = alloc_stats::stage_name(static_cast<AllocStage>(s));
+        const double allocs = static_cast<double>(after[s].allocations - before[s].allocations) / measured;
+        const double bytes = static_cast<double>(after[s].bytes_allocated - before[s].bytes_allocated) / measured;
+        const double copies = static_cast<double>(after[s].copies - before[s].copies) / measured;
+        const double copied_kb = (after[s].bytes_copied - before[s].bytes_copied) / 1024.0 / measured;
+        auto budget_it = check.budgets.find(stage);
+        const double budget = budget_it != check.budgets.end() ? budget_it->second : 0.0;
+        const bool over = allocs > budget;
+        over_budget += over ? 1 : 0;
+        std::cout << "  " << std::left << std::setw(10) << stage << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << allocs << std::setw(12) << bytes
+                  << std::setw(12) << copies << std::setw(14) << copied_kb
+                  << std::setw(10) << budget << (over ? "  OVER" : "") << std::endl;
+    }
+    return over_budget;
+}
+
+// One configuration per line so --compare can read it back with jsonl_parse
+std::string result_json(const BenchResult& r) {
+    std::ostringstream out;
+    out << "{\"cameras\":" << r.config.cameras
+        << ",\"width\":" << r.config.width
+        << ",\"height\":" << r.config.height
+        << ",\"fps\":" << r.config.fps
+        << ",\"offered_fps\":" << r.offered_fps
+        << ",\"written_fps\":" << r.written_fps
+        << ",\"ring_drops\":" << r.ring_drops
+        << ",\"sync_misses\":" << r.sync_misses
+        << ",\"p50_latency_us\":" << r.p50_latency_us
+        << ",\"p99_latency_us\":" << r.p99_latency_us
+        << ",\"capture_cpu_pct\":" << r.capture_cpu_pct
+        << ",\"sync_cpu_pct\":" << r.sync_cpu_pct
+        << ",\"write_cpu_pct\":" << r.write_cpu_pct
+        << ",\"bytes_written\":" << r.bytes_written
+        << ",\"sustainable\":" << (r.sustainable ? "true" : "false")
+        << "}";
+    return out.str();
+}
+
+std::string config_key(int cameras, int width, int height, int fps) {
+    return std::to_string(cameras) + "x" + std::to_string(width) + "x" + std::to_string(height) + "@" + std::to_string(fps);
+}
+
+// Returns the number of regressions found.
+int compare_with_baseline(const std::vector<BenchResult>& results, double max_sustainable_fps,
+                          const std::string& baseline_path, double tolerance) {
+    std::ifstream baseline(baseline_path);
+    if (!baseline.is_open()) {
+        std::cerr << "Failed to open baseline " << baseline_path << std::endl;
+        return 1;
+    }
+
+    int regressions = 0;
+    std::string line;
+    while (std::getline(baseline, line)) {
+        double base_max = 0;
+        if (line.find("\"max_sustainable_fps\"") != std::string::npos &&
+            jsonl_get_double(line, "max_sustainable_fps", base_max)) {
+            if (max_sustainable_fps < base_max * (1.0 - tolerance)) {
+                std::cerr << "REGRESSION max_sustainable_fps: " << max_sustainable_fps 
+                          << " < baseline " << base_max << std::endl;
+                regressions++;
+            }
+            continue;
+        }
+
+        uint64_t cameras, width, height, fps;
+        double base_written_fps, base_p99;
+        if (!jsonl_get_uint(line, "cameras", cameras) || !jsonl_get_uint(line, "width", width) ||
+            !jsonl_get_uint(line, "height", height) || !jsonl_get_uint(line, "fps", fps) ||
+            !jsonl_get_double(line, "written_fps", base_written_fps) ||
+            !jsonl_get_double(line, "p99_latency_us", base_p99)) {
+            continue;
+        }
+        std::string key = config_key(cameras, width, height, fps);
+        for (const BenchResult& r : results) {
+            if (config_key(r.config.cameras, r.config.width, r.config.height, r.config.fps) != key) {
+                continue;
+            }
+            if (r.written_fps < base_written_fps * (1.0 - tolerance)) {
+                std::cerr << "REGRESSION " << key << " written_fps: " << r.written_fps 
+                          << " < baseline " << base_written_fps << std::endl;
+                regressions++;
+            }
+            if (base_p99 > 0 && r.p99_latency_us > base_p99 * (1.0 + tolerance)) {
+                std::cerr << "REGRESSION " << key << " p99_latency_us: " << r.p99_latency_us 
+                          << " > baseline " << base_p99 << std::endl;
+                regressions++;
+            }
+        }
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    int max_cameras = 8;
+    double seconds = 5.0;
+    double tolerance = 0.10;
+    std::string output_dir = "/tmp/robodaq_e2e_bench";
+    std::string json_path;
+    std::string baseline_path;
+    bool alloc_check = false;
+    AllocCheckConfig alloc_config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--alloc-check") {
+            alloc_check = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        if (arg == "--max-cameras") max_cameras = std::stoi(argv[++i]);
+        else if (arg == "--seconds") seconds = std::stod(argv[++i]);
+        else if (arg == "--tolerance") tolerance = std::stod(argv[++i]);
+        else if (arg == "--output-dir") output_dir = argv[++i];
+        else if (arg == "--json") json_path = argv[++i];
+        else if (arg == "--compare") baseline_path = argv[++i];
+        else if (arg == "--alloc-frames") alloc_config.frames = std::stoi(argv[++i]);
+        else if (arg == "--alloc-budget") {
+            std::string budget = argv[++i];
+            size_t eq = budget.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "--alloc-budget expects stage=allocations_per_bundle" << std::endl;
+                return 1;
+            }
+            alloc_config.budgets[budget.substr(0, eq)] = std::stod(budget.substr(eq + 1));
+        }
+        else {
+            std::cerr << "Unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (alloc_check) {
+        if (!alloc_stats::enabled()) {
+            std::cerr << "--alloc-check needs an instrumentation build: rebuild with -DRECORDER_ALLOC_STATS=ON" << std::endl;
+            return 1;
+        }
+        alloc_config.output_dir = output_dir;
+        int over_budget = run_alloc_check(alloc_config);
+        if (over_budget < 0) {
+            return 1;
+        }
+        if (over_budget > 0) {
+            std::cerr << over_budget << " stage(s) allocate in steady state beyond their budget" << std::endl;
+            return 1;
+        }
+        std::cout << "No steady-state allocations beyond budget" << std::endl;
+        return 0;
+    }
+
+    const std::vector<std::pair<int, int>> resolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+    const std::vector<int> frame_rates = {30, 60};
+
+    std::vector<BenchResult> results;
+    double max_sustainable_fps = 0;
+    for (const auto& [width, height] : resolutions) {
+        for (int fps : frame_rates) {
+            // Add cameras until this resolution/rate starts losing frames
+            for (int cameras = 1; cameras <= max_cameras; cameras++) {
+                BenchResult r = run_config({cameras, width, height, fps}, seconds, output_dir);
+                std::cout << result_json(r) << std::endl;
+                results.push_back(r);
+                if (!r.sustainable) {
+                    break;
+                }
+                max_sustainable_fps = std::max(max_sustainable_fps, r.written_fps);
+            }
+        }
+    }
+
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    std::ostringstream report;
+    report << "{\n\"host\":\"" << hostname << "\",\n"
+           << "\"cpus\":" << std::thread::hardware_concurrency() << ",\n"
+           << "\"seconds_per_config\":" << seconds << ",\n"
+           << "\"max_sustainable_fps\":" << max_sustainable_fps << ",\n"
+           << "\"configs\":[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        report << result_json(results[i]) << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    report << "]\n}\n";
+
+    std::cout << "\nMax sustainable frames/sec (all cameras): " << max_sustainable_fps << std::endl;
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        out << report.str();
+        std::cout << "Results written to: " << json_path << std::endl;
+    }
+
+    if (!baseline_path.empty()) {
+        int regressions = compare_with_baseline(results, max_sustainable_fps, baseline_path, tolerance);
+        if (regressions > 0) {
+            std::cerr << regressions << " regression(s) beyond " << tolerance * 100 << "% vs " << baseline_path << std::endl;
+            return 1;
+        }
+        std::cout << "No regressions beyond " << tolerance * 100 << "% vs " << baseline_path << std::endl;
+    }
+    return 0;
+}
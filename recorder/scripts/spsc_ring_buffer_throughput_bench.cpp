@@ -1,3 +1,4 @@
+#include "../src/perf_counters.hpp"
 #include "../src/spsc_ring_buffer.hpp"
 #include <iostream>
 #include <thread>
@@ -44,10 +45,21 @@ int main()
     SPSCRingBuffer<Item> ring_buffer(N, true); // drop oldest
     total_produced = 0;
     total_consumed = 0;
+    PerfCounters counters;
+    if (!counters.open()) {
+        std::cout << "Hardware counters unavailable (" << counters.error() << ")" << std::endl;
+    }
     
+    counters.reset();
     auto start_time = std::chrono::steady_clock::now();
-    std::thread producer(producer_thread, "p1", std::ref(ring_buffer), total_ops);
-    std::thread consumer(consumer_thread, "c1", std::ref(ring_buffer), total_ops);
+    std::thread producer([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        producer_thread("p1", ring_buffer, total_ops);
+    });
+    std::thread consumer([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        consumer_thread("c1", ring_buffer, total_ops);
+    });
     
     producer.join();
     consumer.join();
@@ -59,6 +71,7 @@ int main()
     std::cout << "Total produced: " << total_produced << std::endl;
     std::cout << "Total consumed: " << total_consumed << std::endl;
     std::cout << "Ops per sec: " << ops_per_sec << std::endl;
+    std::cout << "Counters: {" << counters.json_fields(total_produced + total_consumed).substr(1) << "}" << std::endl;
 
     return 0;
 }
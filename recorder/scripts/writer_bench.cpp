@@ -0,0 +1,338 @@
+/*
+Goal: know what VideoWriter::write_frame costs per codec, resolution and
+OpenCV thread count on this box, so encoder settings and cameras per rig are
+picked from numbers instead of trial and error on the rig.
+
+Each configuration feeds --frames YUYV frames, from --preload frames rendered
+up front, through one VideoWriter as fast as it accepts them. Backends:
+
+  mp4v   OpenCV/FFmpeg MPEG-4 Part 2 (the recorder default)
+  x264   H.264 through a GStreamer pipeline (GST_X264_VIDEO_CODEC)
+  raw    frames appended as captured (--raw-video)
+
+Backends this OpenCV build can't open are reported as unavailable.
+
+With --output-size every configuration writes a scaled (or centre-cropped)
+stream instead, the way the recorder's --output does: one fused YUYV resize +
+BGR conversion per frame, counted in convert_us.
+
+Reported per configuration, one JSON object per line:
+  convert_us_p50/p99   copy into a Mat + colour conversion
+  encode_us_p50/p99    encoder / file write
+  write_fps            frames/sec one writer sustained (wall clock)
+  cpu_ms_per_frame     process CPU per frame, including encoder threads
+  bitrate_mbps         output size at --fps playback rate
+  max_cameras_per_core_30fps / _60fps = 1 / (cpu per frame * fps)
+  cycles_per_op ... context_switches  hardware counters per frame on the
+                       writing thread (perf_counters.hpp), null where not permitted
+
+Usage:
+  writer_bench [--backends mp4v,x264,raw] [--resolutions 640x480,1280x720,1920x1080]
+               [--threads 1,2,4] [--frames N] [--preload N] [--fps F]
+               [--output-size WxH[:crop]] [--output-dir DIR] [--json out.jsonl]
+*/
+
+#include "../src/perf_counters.hpp"
+#include "../src/video_writer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+struct WriterBenchConfig {
+    std::string backend;
+    int width;
+    int height;
+    int threads;
+    int output_width = 0;     // 0 = write at capture size
+    int output_height = 0;
+    ResizeMode output_mode = ResizeMode::STRETCH;
+};
+
+struct WriterBenchResult {
+    WriterBenchConfig config;
+    bool available = false;
+    uint64_t frames = 0;
+    double convert_us_p50 = 0;
+    double convert_us_p99 = 0;
+    double encode_us_p50 = 0;
+    double encode_us_p99 = 0;
+    double write_fps = 0;
+    double cpu_ms_per_frame = 0;
+    double bitrate_mbps = 0;
+    double max_cameras_per_core_30fps = 0;
+    double max_cameras_per_core_60fps = 0;
+    std::string counters;
+};
+
+double process_cpu_seconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+// Moving gradient + noise, same as recorder_e2e_bench, so encoders do realistic work
+void fill_pattern(std::vector<uint8_t>& data, int width, int height, uint64_t seq, uint32_t& rng) {
+    for (int y = 0; y < height; y++) {
+        uint8_t* row = data.data() + static_cast<size_t>(y) * width * 2;
+        for (int x = 0; x < width * 2; x += 2) {
+            rng = rng * 1664525u + 1013904223u;
+            row[x] = static_cast<uint8_t>((x / 2 + y + seq * 4) & 0xff) ^ ((rng >> 28) & 0x3);
+            row[x + 1] = static_cast<uint8_t>(128 + ((y + seq) & 0x1f));
+        }
+    }
+}
+
+double percentile_us(std::vector<uint64_t>& samples_ns, double p) {
+    if (samples_ns.empty()) {
+        return 0;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    return samples_ns[std::min(samples_ns.size() - 1, static_cast<size_t>(samples_ns.size() * p))] / 1000.0;
+}
+
+WriterBenchResult run_config(const WriterBenchConfig& config, int frames, int preload, double fps,
+                             const std::string& output_dir, PerfCounters& counters) {
+    WriterBenchResult result;
+    result.config = config;
+    cv::setNumThreads(config.threads);
+
+    std::vector<CameraFrame> source(preload);
+    uint32_t rng = 4242;
+    for (int i = 0; i < preload; i++) {
+        CameraFrame& frame = source[i];
+        frame.device_name = "/dev/cam_bench";
+        frame.width = config.width;
+        frame.height = config.height;
+        frame.format = CameraFormat::YUYV;
+        frame.image_data.resize(static_cast<size_t>(config.width) * config.height * 2);
+        fill_pattern(frame.image_data, config.width, config.height, i, rng);
+    }
+
+    const std::string extension = config.backend != RAW_VIDEO_CODEC ? ".mp4" : config.output_width > 0 ? ".bgr" : ".yuyv";
+    const std::string path = output_dir + "/writer_" + config.backend + "_" + std::to_string(config.width) + "x"
+        + std::to_string(config.height) + "_t" + std::to_string(config.threads) + extension;
+    VideoWriter writer;
+    const bool opened = config.output_width > 0
+        ? writer.initialize_resized(path, config.width, config.height, config.output_width, config.output_height,
+                                    config.output_mode, fps, config.backend)
+        : writer.initialize(path, config.width, config.height, fps, config.backend);
+    if (!opened) {
+        return result;
+    }
+    result.available = true;
+
+    std::vector<uint64_t> convert_ns;
+    std::vector<uint64_t> encode_ns;
+    convert_ns.reserve(frames);
+    encode_ns.reserve(frames);
+    counters.reset();
+    const double cpu_start = process_cpu_seconds();
+    const auto wall_start = std::chrono::steady_clock::now();
+    {
+        // The calling thread; encoder threads the backend started are not counted
+        PerfCounters::ThreadScope scope(counters);
+        for (int i = 0; i < frames; i++) {
+            CameraFrame& frame = source[i % preload];
+            frame.sequence_number = i + 1;
+            frame.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int latency_us = 0;
+            if (!writer.write_frame(frame, latency_us)) {
+                break;
+            }
+            convert_ns.push_back(writer.last_write_timings().convert_ns);
+            encode_ns.push_back(writer.last_write_timings().encode_ns);
+            result.frames++;
+        }
+        // Encoders buffer frames; the flush on finalize is part of the cost
+        writer.finalize();
+    }
+    result.counters = counters.json_fields(result.frames);
+    const double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    const double cpu_seconds = process_cpu_seconds() - cpu_start;
+
+    std::error_code error;
+    const uint64_t bytes = std::filesystem::file_size(path, error);
+    std::filesystem::remove(path, error);
+
+    if (result.frames == 0) {
+        return result;
+    }
+    result.convert_us_p50 = percentile_us(convert_ns, 0.50);
+    result.convert_us_p99 = percentile_us(convert_ns, 0.99);
+    result.encode_us_p50 = percentile_us(encode_ns, 0.50);
+    result.encode_us_p99 = percentile_us(encode_ns, 0.99);
+    result.write_fps = result.frames / wall_seconds;
+    result.cpu_ms_per_frame = cpu_seconds * 1000.0 / result.frames;
+    result.bitrate_mbps = bytes * 8.0 / (result.frames / fps) / 1e6;
+    if (cpu_seconds > 0) {
+        const double cpu_per_frame = cpu_seconds / result.frames;
+        result.max_cameras_per_core_30fps = 1.0 / (cpu_per_frame * 30);
+        result.max_cameras_per_core_60fps = 1.0 / (cpu_per_frame * 60);
+    }
+    return result;
+}
+
+std::string result_json(const WriterBenchResult& r) {
+    std::ostringstream out;
+    out << "{\"backend\":\"" << r.config.backend << "\""
+        << ",\"width\":" << r.config.width
+        << ",\"height\":" << r.config.height
+        << ",\"threads\":" << r.config.threads;
+    if (r.config.output_width > 0) {
+        out << ",\"output\":\"" << r.config.output_width << "x" << r.config.output_height
+            << ":" << resize_mode_name(r.config.output_mode) << "\"";
+    }
+    out << ",\"available\":" << (r.available ? "true" : "false")
+        << ",\"frames\":" << r.frames
+        << ",\"convert_us_p50\":" << r.convert_us_p50
+        << ",\"convert_us_p99\":" << r.convert_us_p99
+        << ",\"encode_us_p50\":" << r.encode_us_p50
+        << ",\"encode_us_p99\":" << r.encode_us_p99
+        << ",\"write_fps\":" << r.write_fps
+        << ",\"cpu_ms_per_frame\":" << r.cpu_ms_per_frame
+        << ",\"bitrate_mbps\":" << r.bitrate_mbps
+        << ",\"max_cameras_per_core_30fps\":" << r.max_cameras_per_core_30fps
+        << ",\"max_cameras_per_core_60fps\":" << r.max_cameras_per_core_60fps
+        << r.counters
+        << "}";
+    return out.str();
+}
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n"
+              << "\nOptions:\n"
+              << "  --backends <list>     Comma-separated backends: mp4v, x264, raw (default: all)\n"
+              << "  --resolutions <list>  Comma-separated WxH (default: 640x480,1280x720,1920x1080)\n"
+              << "  --threads <list>      Comma-separated OpenCV thread counts (default: 1,2,4)\n"
+              << "  --frames <n>          Frames written per configuration (default: 300)\n"
+              << "  --preload <n>         Distinct frames rendered up front (default: 30)\n"
+              << "  --fps <f>             Playback rate used for bitrate (default: 30)\n"
+              << "  --output-size <spec>  Write WxH or WxH:crop instead of the source size\n"
+              << "  --output-dir <dir>    Where bench videos go (default: /tmp/robodaq_writer_bench)\n"
+              << "  --json <file>         Also write results as JSON lines\n"
+              << "  --help                Show this help message\n"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> backends = {"mp4v", GST_X264_VIDEO_CODEC, RAW_VIDEO_CODEC};
+    std::vector<std::pair<int, int>> resolutions = {{640, 480}, {1280, 720}, {1920, 1080}};
+    std::vector<int> thread_counts = {1, 2, 4};
+    int frames = 300;
+    int preload = 30;
+    double fps = 30;
+    std::string output_dir = "/tmp/robodaq_writer_bench";
+    std::string json_path;
+    int output_width = 0;
+    int output_height = 0;
+    ResizeMode output_mode = ResizeMode::STRETCH;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << "\n" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--backends") backends = split_list(value);
+            else if (arg == "--frames") frames = std::stoi(value);
+            else if (arg == "--preload") preload = std::stoi(value);
+            else if (arg == "--fps") fps = std::stod(value);
+            else if (arg == "--output-dir") output_dir = value;
+            else if (arg == "--json") json_path = value;
+            else if (arg == "--output-size") {
+                if (!parse_resize_spec(value, output_width, output_height, output_mode)) {
+                    std::cerr << "Error: --output-size looks like 224x224 or 224x224:crop\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            }
+            else if (arg == "--threads") {
+                thread_counts.clear();
+                for (const auto& item : split_list(value)) {
+                    thread_counts.push_back(std::stoi(item));
+                }
+            } else if (arg == "--resolutions") {
+                resolutions.clear();
+                for (const auto& item : split_list(value)) {
+                    size_t x = item.find('x');
+                    if (x == std::string::npos) {
+                        std::cerr << "Error: Resolutions look like 1280x720\n" << std::endl;
+                        print_usage(argv[0]);
+                        return 1;
+                    }
+                    resolutions.push_back({std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1))});
+                }
+            } else {
+                std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid value for " << arg << ": '" << value << "'\n" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (frames <= 0 || preload <= 0 || fps <= 0) {
+        std::cerr << "--frames, --preload and --fps must be positive" << std::endl;
+        return 1;
+    }
+    std::filesystem::create_directories(output_dir);
+
+    PerfCounters counters;
+    if (!counters.open()) {
+        std::cout << "Hardware counters unavailable (" << counters.error() << ")" << std::endl;
+    }
+    std::vector<std::string> results;
+    for (const auto& backend : backends) {
+        for (const auto& [width, height] : resolutions) {
+            for (int threads : thread_counts) {
+                WriterBenchConfig config{backend, width, height, threads, output_width, output_height, output_mode};
+                WriterBenchResult r = run_config(config, frames, preload, fps, output_dir, counters);
+                results.push_back(result_json(r));
+                std::cout << results.back() << std::endl;
+            }
+        }
+    }
+
+    char hostname[256] = {0};
+    gethostname(hostname, sizeof(hostname) - 1);
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        out << "{\"host\":\"" << hostname << "\",\"cpus\":" << sysconf(_SC_NPROCESSORS_ONLN)
+            << ",\"frames_per_config\":" << frames << "}\n";
+        for (const auto& line : results) {
+            out << line << "\n";
+        }
+        std::cout << "Results written to: " << json_path << std::endl;
+    }
+    return 0;
+}
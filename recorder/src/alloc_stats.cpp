@@ -0,0 +1,238 @@
+#include "alloc_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <new>
+
+namespace {
+
+constexpr int NUM_STAGES = static_cast<int>(AllocStage::NUM_STAGES);
+constexpr int MAX_THREADS = 256;
+
+const char* const STAGE_NAMES[NUM_STAGES] = {
+    "other", "capture", "ring", "sync", "convert", "encode", "log", "monitor"
+};
+
+// Written only by the owning thread, read by snapshot() from any thread
+struct StageCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+    std::atomic<uint64_t> bytes_allocated{0};
+    std::atomic<uint64_t> copies{0};
+    std::atomic<uint64_t> bytes_copied{0};
+};
+
+struct ThreadBlock {
+    char name[32];
+    StageCounters stages[NUM_STAGES];
+};
+
+// Blocks are never freed, so counts of exited threads stay readable. The
+// registry is a fixed array because it is filled from inside operator new.
+std::atomic<ThreadBlock*> g_blocks[MAX_THREADS];
+std::atomic<int> g_block_count{0};
+
+// Trivially initialized, so touching them from operator new can't recurse
+thread_local ThreadBlock* tls_block = nullptr;
+thread_local AllocStage tls_stage = AllocStage::OTHER;
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+ThreadBlock* thread_block() {
+    if (!tls_block) {
+        int index = g_block_count.fetch_add(1, std::memory_order_relaxed);
+        if (index >= MAX_THREADS) {
+            g_block_count.store(MAX_THREADS, std::memory_order_relaxed);
+            return nullptr;
+        }
+        void* memory = std::malloc(sizeof(ThreadBlock));
+        if (!memory) {
+            return nullptr;
+        }
+        ThreadBlock* block = new (memory) ThreadBlock();
+        std::snprintf(block->name, sizeof(block->name), "thread-%d", index);
+        g_blocks[index].store(block, std::memory_order_release);
+        tls_block = block;
+    }
+    return tls_block;
+}
+
+} // namespace
+
+namespace alloc_stats {
+
+bool enabled() {
+#ifdef ROBODAQ_ALLOC_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* stage_name(AllocStage stage) {
+    int index = static_cast<int>(stage);
+    return index >= 0 && index < NUM_STAGES ? STAGE_NAMES[index] : "?";
+}
+
+AllocStage set_stage(AllocStage stage) {
+    AllocStage previous = tls_stage;
+    tls_stage = stage;
+    return previous;
+}
+
+void count_copy(size_t bytes) {
+    if (ThreadBlock* block = thread_block()) {
+        StageCounters& counters = block->stages[static_cast<int>(tls_stage)];
+        bump(counters.copies, 1);
+        bump(counters.bytes_copied, bytes);
+    }
+}
+
+void name_thread(const char* name) {
+    if (ThreadBlock* block = thread_block()) {
+        std::strncpy(block->name, name, sizeof(block->name) - 1);
+        block->name[sizeof(block->name) - 1] = '\0';
+    }
+}
+
+std::vector<ThreadAllocStats> snapshot() {
+    std::vector<ThreadAllocStats> threads;
+    const int count = std::min(g_block_count.load(std::memory_order_acquire), MAX_THREADS);
+    for (int i = 0; i < count; i++) {
+        const ThreadBlock* block = g_blocks[i].load(std::memory_order_acquire);
+        if (!block) {
+            continue;  // still being registered
+        }
+        ThreadAllocStats stats;
+        stats.thread_name = block->name;
+        for (int s = 0; s < NUM_STAGES; s++) {
+            stats.stages[s].allocations = block->stages[s].allocations.load(std::memory_order_relaxed);
+            stats.stages[s].frees = block->stages[s].frees.load(std::memory_order_relaxed);
+            stats.stages[s].bytes_allocated = block->stages[s].bytes_allocated.load(std::memory_order_relaxed);
+            stats.stages[s].copies = block->stages[s].copies.load(std::memory_order_relaxed);
+            stats.stages[s].bytes_copied = block->stages[s].bytes_copied.load(std::memory_order_relaxed);
+        }
+        threads.push_back(std::move(stats));
+    }
+    return threads;
+}
+
+std::vector<AllocCounters> totals_by_stage(const std::vector<ThreadAllocStats>& threads) {
+    std::vector<AllocCounters> totals(NUM_STAGES);
+    for (const auto& thread : threads) {
+        for (int s = 0; s < NUM_STAGES; s++) {
+            totals[s].allocations += thread.stages[s].allocations;
+            totals[s].frees += thread.stages[s].frees;
+            totals[s].bytes_allocated += thread.stages[s].bytes_allocated;
+            totals[s].copies += thread.stages[s].copies;
+            totals[s].bytes_copied += thread.stages[s].bytes_copied;
+        }
+    }
+    return totals;
+}
+
+void print_report(std::ostream& out) {
+    if (!enabled()) {
+        return;
+    }
+    out << "\nAllocations by thread and stage:" << std::endl;
+    out << "  " << std::left << std::setw(20) << "thread" << std::setw(10) << "stage"
+        << std::right << std::setw(12) << "allocs" << std::setw(14) << "alloc MB"
+        << std::setw(12) << "copies" << std::setw(14) << "copied MB" << std::endl;
+    for (const auto& thread : snapshot()) {
+        for (int s = 0; s < NUM_STAGES; s++) {
+            const AllocCounters& c = thread.stages[s];
+            if (!c.allocations && !c.copies) {
+                continue;
+            }
+            out << "  " << std::left << std::setw(20) << thread.thread_name << std::setw(10) << STAGE_NAMES[s]
+                << std::right << std::setw(12) << c.allocations
+                << std::setw(14) << std::fixed << std::setprecision(2) << c.bytes_allocated / (1024.0 * 1024.0)
+                << std::setw(12) << c.copies
+                << std::setw(14) << c.bytes_copied / (1024.0 * 1024.0) << std::endl;
+        }
+    }
+}
+
+} // namespace alloc_stats
+
+#ifdef ROBODAQ_ALLOC_STATS
+
+namespace {
+
+void* counted_alloc(size_t size, size_t alignment) {
+    void* memory = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        memory = std::malloc(size ? size : 1);
+    } else if (posix_memalign(&memory, alignment, size ? size : 1) != 0) {
+        memory = nullptr;
+    }
+    if (memory) {
+        // thread_block() allocates with malloc, never operator new, so no recursion
+        if (ThreadBlock* block = thread_block()) {
+            StageCounters& counters = block->stages[static_cast<int>(tls_stage)];
+            bump(counters.allocations, 1);
+            bump(counters.bytes_allocated, size);
+        }
+    }
+    return memory;
+}
+
+void counted_free(void* memory) {
+    if (!memory) {
+        return;
+    }
+    if (ThreadBlock* block = thread_block()) {
+        bump(block->stages[static_cast<int>(tls_stage)].frees, 1);
+    }
+    std::free(memory);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    if (void* memory = counted_alloc(size, 0)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* memory = counted_alloc(size, static_cast<size_t>(alignment))) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* memory) noexcept { counted_free(memory); }
+void operator delete[](void* memory) noexcept { counted_free(memory); }
+void operator delete(void* memory, size_t) noexcept { counted_free(memory); }
+void operator delete[](void* memory, size_t) noexcept { counted_free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { counted_free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { counted_free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { counted_free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { counted_free(memory); }
+
+#endif
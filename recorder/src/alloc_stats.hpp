@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+    Allocation and copy accounting for the frame path, per thread and per stage.
+
+    Only an instrumentation build (-DRECORDER_ALLOC_STATS=ON, which defines
+    ROBODAQ_ALLOC_STATS) counts anything. There, alloc_stats.cpp replaces the
+    global operator new/delete, and every allocation is charged to the calling
+    thread's current stage. Code marks its stage with ROBODAQ_ALLOC_STAGE,
+    large copies with ROBODAQ_COUNT_COPY and names its thread with
+    ROBODAQ_ALLOC_THREAD_NAME; in normal builds all three are no-ops.
+
+    Only C++ allocations are seen: malloc/g_malloc from GStreamer, OpenCV's
+    fastMalloc and libc are not counted.
+
+    recorder_e2e_bench --alloc-check uses this to fail when steady-state
+    recording allocates per frame.
+*/
+
+enum class AllocStage : uint8_t {
+    OTHER = 0,
+    CAPTURE,    // appsink callback: building the CameraFrame
+    RING,       // pushing into the camera rings
+    SYNC,       // matching front/right frames
+    CONVERT,    // colour conversion before encoding
+    ENCODE,     // encoder / raw file write
+    LOG,        // sync.jsonl and events.jsonl lines
+    MONITOR,    // PerformanceMonitor bookkeeping
+    NUM_STAGES
+};
+
+struct AllocCounters {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t copies = 0;
+    uint64_t bytes_copied = 0;
+};
+
+struct ThreadAllocStats {
+    std::string thread_name;
+    AllocCounters stages[static_cast<int>(AllocStage::NUM_STAGES)];
+};
+
+namespace alloc_stats {
+
+// True in an instrumentation build
+bool enabled();
+
+const char* stage_name(AllocStage stage);
+
+// Sets the calling thread's stage; returns the previous one
+AllocStage set_stage(AllocStage stage);
+
+// Charges an explicit copy (memcpy, frame copy-assign) to the current stage
+void count_copy(size_t bytes);
+
+// Label for the calling thread in snapshots (truncated to 31 chars)
+void name_thread(const char* name);
+
+// Counters of every thread that has counted anything so far, including exited ones
+std::vector<ThreadAllocStats> snapshot();
+
+// Sum over threads, per stage
+std::vector<AllocCounters> totals_by_stage(const std::vector<ThreadAllocStats>& threads);
+
+// Per-thread, per-stage table of non-zero counters
+void print_report(std::ostream& out);
+
+} // namespace alloc_stats
+
+// Charges the calling thread's allocations to `stage` until the end of the scope
+class AllocStageScope {
+    public:
+        explicit AllocStageScope(AllocStage stage) : previous_(alloc_stats::set_stage(stage)) {}
+        ~AllocStageScope() { alloc_stats::set_stage(previous_); }
+
+        AllocStageScope(const AllocStageScope&) = delete;
+        AllocStageScope& operator=(const AllocStageScope&) = delete;
+
+    private:
+        AllocStage previous_;
+};
+
+#ifdef ROBODAQ_ALLOC_STATS
+#define ROBODAQ_ALLOC_CONCAT_(a, b) a##b
+#define ROBODAQ_ALLOC_SCOPE_NAME_(line) ROBODAQ_ALLOC_CONCAT_(alloc_stage_scope_, line)
+#define ROBODAQ_ALLOC_STAGE(stage) AllocStageScope ROBODAQ_ALLOC_SCOPE_NAME_(__LINE__)(stage)
+#define ROBODAQ_COUNT_COPY(bytes) alloc_stats::count_copy(bytes)
+#define ROBODAQ_ALLOC_THREAD_NAME(name) alloc_stats::name_thread(name)
+#else
+#define ROBODAQ_ALLOC_STAGE(stage) do {} while (0)
+#define ROBODAQ_COUNT_COPY(bytes) do {} while (0)
+#define ROBODAQ_ALLOC_THREAD_NAME(name) do {} while (0)
+#endif
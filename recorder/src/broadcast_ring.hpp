@@ -0,0 +1,270 @@
+/*
+Goal: One producer, many consumers, every consumer sees every frame, and each
+frame is written once into the ring and read in place by all of them.
+
+Disruptor-style: a fixed array of slots indexed by a monotonically increasing
+sequence. The producer publishes sequences; each consumer has its own cursor
+(next sequence to read). A slot is reused only once every consumer that
+matters has moved past it, so slot contents (e.g. a CameraFrame's pixel
+vector) are overwritten in place and never reallocated in steady state.
+
+Per-consumer policy:
+- BLOCKING: the producer never overtakes it. If the slowest blocking consumer
+  still holds the oldest slot, claim() fails and the producer drops the item,
+  same as SPSCRingBuffer::push returning false. Use for the writer/sync path.
+- LOSSY: the producer skips it forward instead of waiting, and a lossy
+  consumer that falls more than half a ring behind jumps to the newest item.
+  Use for preview and QC. While a lossy consumer holds the very slot the
+  producer needs, the producer waits for its release(), so lossy consumers
+  must keep peek()..release() short.
+
+Consumers must be added before the first publish. Each consumer is driven by
+exactly one thread, except that release_until() may come from any thread as
+long as calls for one consumer don't overlap.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+enum class ConsumerPolicy {
+    BLOCKING,
+    LOSSY
+};
+
+template<typename T>
+class BroadcastRing {
+    public:
+        explicit BroadcastRing(size_t capacity);
+
+        // Returns the consumer id used by peek/release
+        int add_consumer(ConsumerPolicy policy);
+
+        // Producer: slot for the next item, or nullptr if a blocking consumer
+        // hasn't released the oldest slot yet. Write the item, then publish().
+        T* claim();
+        void publish();
+
+        // Producer: claim + copy-assign + publish
+        bool push(const T& item);
+
+        // Consumer: next unread item in place, or nullptr if caught up.
+        // Valid until release(consumer).
+        const T* peek(int consumer);
+
+        // Consumer: newest published item, skipping anything older (lossy consumers only)
+        const T* peek_latest(int consumer);
+
+        // Consumer: the n-th item after the next unread one, or nullptr if not
+        // published yet (blocking consumers only; the producer can't overwrite
+        // anything a blocking consumer hasn't released). Doesn't move the cursor.
+        const T* peek_ahead(int consumer, size_t n) const;
+
+        void release(int consumer);
+
+        // Blocking consumers only: releases everything before `sequence`
+        // without peeking, for a consumer that only holds slots (e.g. until
+        // writers on other threads are done with them)
+        void release_until(int consumer, uint64_t sequence);
+
+        // Next sequence `consumer` will read; everything before it is released
+        uint64_t cursor(int consumer) const;
+
+        // Items skipped for a lossy consumer (overtaken or jumped ahead)
+        uint64_t dropped(int consumer) const;
+
+        // Items published but not yet consumed by the slowest blocking consumer
+        size_t size() const;
+        bool is_empty() const;
+        size_t capacity() const;
+
+    private:
+        static constexpr uint64_t BUSY = 1ull << 63;
+
+        struct Consumer {
+            ConsumerPolicy policy;
+            alignas(64) std::atomic<uint64_t> cursor{0};  // next sequence to read, BUSY while reading
+            std::atomic<uint64_t> dropped{0};
+            uint64_t peeked = 0;                          // consumer thread only
+        };
+
+        const T* acquire_(Consumer& consumer, bool latest);
+
+        std::unique_ptr<T[]> slots_;
+        const size_t capacity_;
+        std::vector<std::unique_ptr<Consumer>> consumers_;
+
+        alignas(64) std::atomic<uint64_t> published_{0};
+        uint64_t next_sequence_ = 0;                      // producer only
+};
+
+template<typename T>
+BroadcastRing<T>::BroadcastRing(size_t capacity)
+    : slots_(std::make_unique<T[]>(capacity)), capacity_(capacity) {
+    assert(capacity > 1);
+}
+
+template<typename T>
+int BroadcastRing<T>::add_consumer(ConsumerPolicy policy) {
+    auto consumer = std::make_unique<Consumer>();
+    consumer->policy = policy;
+    consumer->cursor.store(published_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    consumers_.push_back(std::move(consumer));
+    return static_cast<int>(consumers_.size() - 1);
+}
+
+template<typename T>
+T* BroadcastRing<T>::claim() {
+    const uint64_t sequence = next_sequence_;
+    if (sequence >= capacity_) {
+        // The slot we need last held this sequence
+        const uint64_t oldest = sequence - capacity_;
+        for (auto& consumer : consumers_) {
+            uint64_t cursor = consumer->cursor.load(std::memory_order_acquire);
+            if ((cursor & ~BUSY) > oldest) {
+                continue;
+            }
+            if (consumer->policy == ConsumerPolicy::BLOCKING) {
+                return nullptr;
+            }
+            // Lossy consumer still on the oldest slot: move it past, unless it's reading it
+            while ((cursor & ~BUSY) <= oldest) {
+                if (cursor & BUSY) {
+                    std::this_thread::yield();
+                    cursor = consumer->cursor.load(std::memory_order_acquire);
+                } else if (consumer->cursor.compare_exchange_weak(cursor, oldest + 1, std::memory_order_acq_rel)) {
+                    consumer->dropped.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+    }
+    return &slots_[sequence % capacity_];
+}
+
+template<typename T>
+void BroadcastRing<T>::publish() {
+    next_sequence_++;
+    // Release makes the slot contents visible before the new sequence
+    published_.store(next_sequence_, std::memory_order_release);
+}
+
+template<typename T>
+bool BroadcastRing<T>::push(const T& item) {
+    T* slot = claim();
+    if (!slot) {
+        return false;
+    }
+    *slot = item;
+    publish();
+    return true;
+}
+
+template<typename T>
+const T* BroadcastRing<T>::acquire_(Consumer& consumer, bool latest) {
+    const uint64_t published = published_.load(std::memory_order_acquire);
+    uint64_t cursor = consumer.cursor.load(std::memory_order_acquire);
+
+    if (consumer.policy == ConsumerPolicy::BLOCKING) {
+        // Nobody else moves a blocking cursor
+        if (cursor >= published) {
+            return nullptr;
+        }
+        consumer.peeked = cursor;
+        return &slots_[cursor % capacity_];
+    }
+
+    while (cursor < published) {
+        uint64_t target = cursor;
+        if (latest || published - cursor > capacity_ / 2) {
+            target = published - 1;
+        }
+        // Marks the slot busy so the producer won't overwrite it; fails if the producer just moved us
+        if (consumer.cursor.compare_exchange_weak(cursor, target | BUSY, std::memory_order_acq_rel)) {
+            if (target > cursor) {
+                consumer.dropped.fetch_add(target - cursor, std::memory_order_relaxed);
+            }
+            consumer.peeked = target;
+            return &slots_[target % capacity_];
+        }
+    }
+    return nullptr;
+}
+
+template<typename T>
+const T* BroadcastRing<T>::peek(int consumer) {
+    return acquire_(*consumers_[consumer], false);
+}
+
+template<typename T>
+const T* BroadcastRing<T>::peek_latest(int consumer) {
+    return acquire_(*consumers_[consumer], true);
+}
+
+template<typename T>
+const T* BroadcastRing<T>::peek_ahead(int consumer, size_t n) const {
+    const Consumer& c = *consumers_[consumer];
+    assert(c.policy == ConsumerPolicy::BLOCKING);
+    const uint64_t published = published_.load(std::memory_order_acquire);
+    const uint64_t sequence = c.cursor.load(std::memory_order_relaxed) + n;
+    if (sequence >= published) {
+        return nullptr;
+    }
+    return &slots_[sequence % capacity_];
+}
+
+template<typename T>
+void BroadcastRing<T>::release(int consumer) {
+    Consumer& c = *consumers_[consumer];
+    // Also clears BUSY for lossy consumers
+    c.cursor.store(c.peeked + 1, std::memory_order_release);
+}
+
+template<typename T>
+void BroadcastRing<T>::release_until(int consumer, uint64_t sequence) {
+    Consumer& c = *consumers_[consumer];
+    assert(c.policy == ConsumerPolicy::BLOCKING);
+    if (sequence > c.cursor.load(std::memory_order_relaxed)) {
+        c.cursor.store(sequence, std::memory_order_release);
+    }
+}
+
+template<typename T>
+uint64_t BroadcastRing<T>::cursor(int consumer) const {
+    return consumers_[consumer]->cursor.load(std::memory_order_acquire) & ~BUSY;
+}
+
+template<typename T>
+uint64_t BroadcastRing<T>::dropped(int consumer) const {
+    return consumers_[consumer]->dropped.load(std::memory_order_relaxed);
+}
+
+template<typename T>
+size_t BroadcastRing<T>::size() const {
+    const uint64_t published = published_.load(std::memory_order_acquire);
+    uint64_t slowest = published;
+    for (const auto& consumer : consumers_) {
+        if (consumer->policy == ConsumerPolicy::BLOCKING) {
+            uint64_t cursor = consumer->cursor.load(std::memory_order_acquire);
+            if (cursor < slowest) {
+                slowest = cursor;
+            }
+        }
+    }
+    return static_cast<size_t>(published - slowest);
+}
+
+template<typename T>
+bool BroadcastRing<T>::is_empty() const {
+    return size() == 0;
+}
+
+template<typename T>
+size_t BroadcastRing<T>::capacity() const {
+    return capacity_;
+}
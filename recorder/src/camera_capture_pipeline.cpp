@@ -1,11 +1,80 @@
 #include "camera_capture_pipeline.hpp"
 
+#include "alloc_stats.hpp"
+#include "trace_probes.hpp"
+
+#include <sstream>
+
+namespace {
+
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// GStreamer error/debug strings carry quotes, paths and newlines
+std::string json_escape(const char* text) {
+    std::string escaped;
+    if (!text) {
+        return escaped;
+    }
+    for (const char* c = text; *c; c++) {
+        switch (*c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    escaped += *c;
+                }
+        }
+    }
+    return escaped;
+}
+
+const char* gst_format_name(CameraFormat format) {
+    switch (format) {
+        case CameraFormat::YUYV: return "YUY2";  // GStreamer name for YUYV
+        case CameraFormat::RGB: return "RGB";
+        case CameraFormat::GRAY: return "GRAY8";
+    }
+    return "YUY2";
+}
+
+void replace_all(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+}  // namespace
+
+std::string expand_pipeline_template(
+    const std::string& pipeline_template,
+    const std::string& device,
+    int width,
+    int height,
+    int framerate,
+    CameraFormat format,
+    int queue_max_buffers
+) {
+    std::string description = pipeline_template;
+    replace_all(description, "{device}", device);
+    replace_all(description, "{width}", std::to_string(width));
+    replace_all(description, "{height}", std::to_string(height));
+    replace_all(description, "{framerate}", std::to_string(framerate));
+    replace_all(description, "{format}", gst_format_name(format));
+    replace_all(description, "{queue_max_buffers}", std::to_string(queue_max_buffers));
+    return description;
+}
+
 // CameraPipeline constructor
 CameraPipeline::CameraPipeline() 
     : pipeline_(nullptr), source_(nullptr), capsfilter_(nullptr), 
       queue_(nullptr), sink_(nullptr), gst_initialized_(false), 
       sink_mode_(SinkMode::DISPLAY), trigger_record_(false), sequence_counter_(0),
-      camera_format_(CAMERA_CAPTURE_FORMAT) {}
+      camera_format_(CAMERA_CAPTURE_FORMAT), expected_width_(0), expected_height_(0) {}
 
 // CameraPipeline destructor
 CameraPipeline::~CameraPipeline() {
@@ -18,6 +87,7 @@ CameraPipeline::~CameraPipeline() {
 // Static callback function for appsink
 GstFlowReturn CameraPipeline::on_new_sample_(GstAppSink* appsink, gpointer user_data) {
     CameraPipeline* pipeline = static_cast<CameraPipeline*>(user_data);
+    ROBODAQ_ALLOC_STAGE(AllocStage::CAPTURE);
     
     // Pull the sample
     GstSample* sample = gst_app_sink_pull_sample(appsink);
@@ -42,6 +112,18 @@ GstFlowReturn CameraPipeline::on_new_sample_(GstAppSink* appsink, gpointer user_
     
     // Get format information for debugging
     const gchar* format_str = gst_structure_get_string(structure, "format");
+
+    // A pipeline template can convert or scale; everything downstream assumes
+    // the configured format and size, so refuse the stream (an error on the bus)
+    if (pipeline->sequence_counter_ == 0 && (
+        !format_str || std::strcmp(format_str, gst_format_name(pipeline->camera_format_)) != 0 ||
+        width != pipeline->expected_width_ || height != pipeline->expected_height_)) {
+        g_printerr("%s delivers %s %dx%d, expected %s %dx%d\n", pipeline->device_name_.c_str(),
+                   format_str ? format_str : "?", width, height,
+                   gst_format_name(pipeline->camera_format_), pipeline->expected_width_, pipeline->expected_height_);
+        gst_sample_unref(sample);
+        return GST_FLOW_ERROR;
+    }
     
     // Map buffer to access data
     GstMapInfo map;
@@ -50,11 +132,11 @@ GstFlowReturn CameraPipeline::on_new_sample_(GstAppSink* appsink, gpointer user_
         return GST_FLOW_ERROR;
     }
     
-    // Create CameraFrame
-    CameraFrame frame;
+    // Fill the reused CameraFrame; device_name and image_data keep their capacity
+    CameraFrame& frame = pipeline->frame_;
     frame.sequence_number = ++pipeline->sequence_counter_;
-    frame.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
+    frame.timestamp_us = steady_now_us();
+    pipeline->last_frame_us_.store(frame.timestamp_us, std::memory_order_relaxed);
     frame.device_name = pipeline->device_name_;
     frame.width = width;
     frame.height = height;
@@ -71,6 +153,8 @@ GstFlowReturn CameraPipeline::on_new_sample_(GstAppSink* appsink, gpointer user_
     // Copy image data
     frame.image_data.resize(map.size);
     std::memcpy(frame.image_data.data(), map.data, map.size);
+    ROBODAQ_COUNT_COPY(map.size);
+    ROBODAQ_PROBE(frame_arrival, pipeline->device_name_.c_str(), frame.sequence_number, frame.timestamp_us, map.size);
     
     // Unmap buffer and clean up
     gst_buffer_unmap(buffer, &map);
@@ -84,6 +168,11 @@ GstFlowReturn CameraPipeline::on_new_sample_(GstAppSink* appsink, gpointer user_
     return GST_FLOW_OK;
 }
 
+void CameraPipeline::on_queue_overrun_(GstElement* /*queue*/, gpointer user_data) {
+    CameraPipeline* pipeline = static_cast<CameraPipeline*>(user_data);
+    pipeline->queue_overruns_.fetch_add(1, std::memory_order_relaxed);
+}
+
 bool CameraPipeline::initialize(
     const std::string& device, 
     int width, 
@@ -92,13 +181,16 @@ bool CameraPipeline::initialize(
     SinkMode mode,
     FrameCallback callback,
     bool trigger_record_flag,
-    bool enable_fps_debug
+    bool enable_fps_debug,
+    int queue_max_buffers
 ) {
     // Store configuration
     sink_mode_ = mode;
     frame_callback_ = callback;
     device_name_ = device;
     trigger_record_ = trigger_record_flag;
+    expected_width_ = width;
+    expected_height_ = height;
     
     // Initialize GStreamer
     if (!gst_initialized_) {
@@ -111,6 +203,15 @@ bool CameraPipeline::initialize(
         }
     }
     
+    if (!pipeline_template_.empty()) {
+        if (mode != SinkMode::APPSINK) {
+            std::cerr << "Ignoring the pipeline template for " << device << " in display mode" << std::endl;
+        } else {
+            return build_from_template_(expand_pipeline_template(
+                pipeline_template_, device, width, height, framerate, camera_format_, queue_max_buffers));
+        }
+    }
+
     pipeline_ = gst_pipeline_new("camera-pipeline");
     source_ = gst_element_factory_make("v4l2src", "camera-source");
     capsfilter_ = gst_element_factory_make("capsfilter", "caps-filter");
@@ -130,18 +231,7 @@ bool CameraPipeline::initialize(
     }
     
     // Create caps for video format based on configured format
-    const char* gst_format_string;
-    switch (camera_format_) {
-        case CameraFormat::YUYV:
-            gst_format_string = "YUY2";  // GStreamer name for YUYV
-            break;
-        case CameraFormat::RGB:
-            gst_format_string = "RGB";
-            break;
-        case CameraFormat::GRAY:
-            gst_format_string = "GRAY8";
-            break;
-    }
+    const char* gst_format_string = gst_format_name(camera_format_);
     
     GstCaps *caps = gst_caps_new_simple("video/x-raw",
         "format", G_TYPE_STRING, gst_format_string,
@@ -154,8 +244,12 @@ bool CameraPipeline::initialize(
     
     // Set properties
     g_object_set(source_, "device", device.c_str(), nullptr);
-    g_object_set(queue_, "max-size-buffers", 30, nullptr);
+    g_object_set(queue_, "max-size-buffers", queue_max_buffers, nullptr);
+    g_object_set(queue_, "max-size-bytes", 0, nullptr);  // bounded by buffers, budgeted by the caller
+    g_object_set(queue_, "max-size-time", static_cast<guint64>(0), nullptr);
     g_object_set(queue_, "leaky", 2, nullptr); // downstream
+    // Emitted each time the queue is full, just before it leaks the oldest buffer
+    g_signal_connect(queue_, "overrun", G_CALLBACK(on_queue_overrun_), this);
     
     // Configure sink based on mode
     if (mode == SinkMode::DISPLAY) {
@@ -185,6 +279,51 @@ bool CameraPipeline::initialize(
     return true;
 }
 
+bool CameraPipeline::build_from_template_(const std::string& description) {
+    GError* error = nullptr;
+    pipeline_ = gst_parse_launch(description.c_str(), &error);
+    if (error) {
+        // Non-fatal errors (e.g. an unknown property) still return a pipeline
+        std::cerr << "Pipeline template for " << device_name_ << ": " << error->message << std::endl;
+        g_error_free(error);
+        if (pipeline_) {
+            gst_object_unref(pipeline_);
+            pipeline_ = nullptr;
+        }
+        return false;
+    }
+    if (!pipeline_ || !GST_IS_BIN(pipeline_)) {
+        std::cerr << "Pipeline template for " << device_name_ << " is a single element, not a pipeline" << std::endl;
+        return false;
+    }
+    pipeline_description_ = description;
+
+    // Borrowed pointers like the built-in ones; the bin owns the elements
+    sink_ = gst_bin_get_by_name(GST_BIN(pipeline_), PIPELINE_APPSINK_NAME);
+    if (!sink_ || !GST_IS_APP_SINK(sink_)) {
+        std::cerr << "Pipeline template for " << device_name_ << " needs an appsink named "
+                  << PIPELINE_APPSINK_NAME << std::endl;
+        if (sink_) {
+            gst_object_unref(sink_);
+            sink_ = nullptr;
+        }
+        return false;
+    }
+    gst_object_unref(sink_);
+    GstAppSinkCallbacks callbacks = {0};
+    callbacks.new_sample = on_new_sample_;
+    gst_app_sink_set_callbacks(GST_APP_SINK(sink_), &callbacks, this, nullptr);
+
+    queue_ = gst_bin_get_by_name(GST_BIN(pipeline_), PIPELINE_QUEUE_NAME);
+    if (queue_) {
+        gst_object_unref(queue_);
+        g_signal_connect(queue_, "overrun", G_CALLBACK(on_queue_overrun_), this);
+    }
+
+    std::cout << "Camera pipeline " << device_name_ << " from template: " << description << std::endl;
+    return true;
+}
+
 bool CameraPipeline::start() {
     if (!pipeline_) {
         g_printerr("Pipeline not initialized\n");
@@ -196,6 +335,14 @@ bool CameraPipeline::start() {
         g_printerr("Failed to start pipeline\n");
         return false;
     }
+
+    if (!bus_thread_) {
+        last_frame_us_.store(steady_now_us());
+        bus_running_ = true;
+        bus_thread_ = std::make_unique<std::thread>(&CameraPipeline::bus_thread_func_, this);
+        emit_event_("pipeline_started", ",\"description\":\"" +
+            json_escape(pipeline_description_.empty() ? "built-in" : pipeline_description_.c_str()) + "\"");
+    }
     
     return true;
 }
@@ -204,4 +351,173 @@ void CameraPipeline::stop() {
     if (pipeline_) {
         gst_element_set_state(pipeline_, GST_STATE_NULL);
     }
+    if (bus_thread_) {
+        bus_running_ = false;
+        bus_thread_->join();
+        bus_thread_.reset();
+    }
+}
+
+PipelineHealth CameraPipeline::health() const {
+    PipelineHealth health;
+    health.errors = errors_.load();
+    health.warnings = warnings_.load();
+    health.eos = eos_.load();
+    health.qos_messages = qos_messages_.load();
+    health.qos_processed = qos_processed_.load();
+    health.qos_dropped = qos_dropped_.load();
+    health.queue_overruns = queue_overruns_.load();
+    health.live = live_.load();
+    health.latency_min_ns = latency_min_ns_.load();
+    health.latency_max_ns = latency_max_ns_.load();
+    health.stalls = stalls_.load();
+    return health;
+}
+
+void CameraPipeline::emit_event_(const std::string& event_type, const std::string& fields) {
+    if (!event_callback_) {
+        return;
+    }
+    std::ostringstream event;
+    event << "{\"timestamp_us\":" << steady_now_us()
+          << ",\"event_type\":\"" << event_type << "\""
+          << ",\"device_name\":\"" << json_escape(device_name_.c_str()) << "\""
+          << fields << "}";
+    event_callback_(event.str());
+}
+
+void CameraPipeline::query_latency_() {
+    GstQuery* query = gst_query_new_latency();
+    if (gst_element_query(pipeline_, query)) {
+        gboolean live = FALSE;
+        GstClockTime min_latency = 0;
+        GstClockTime max_latency = 0;
+        gst_query_parse_latency(query, &live, &min_latency, &max_latency);
+        live_ = live;
+        latency_min_ns_ = GST_CLOCK_TIME_IS_VALID(min_latency) ? min_latency : 0;
+        latency_max_ns_ = GST_CLOCK_TIME_IS_VALID(max_latency) ? max_latency : 0;
+    }
+    gst_query_unref(query);
+}
+
+void CameraPipeline::handle_bus_message_(GstMessage* message) {
+    const char* source = GST_OBJECT_NAME(GST_MESSAGE_SRC(message));
+    switch (GST_MESSAGE_TYPE(message)) {
+        case GST_MESSAGE_ERROR:
+        case GST_MESSAGE_WARNING: {
+            const bool is_error = GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR;
+            GError* error = nullptr;
+            gchar* debug = nullptr;
+            if (is_error) {
+                gst_message_parse_error(message, &error, &debug);
+                errors_++;
+                failed_ = true;
+            } else {
+                gst_message_parse_warning(message, &error, &debug);
+                warnings_++;
+            }
+            std::cerr << "GStreamer " << (is_error ? "error" : "warning") << " on " << device_name_
+                      << " from " << (source ? source : "?") << ": " << (error ? error->message : "?") << std::endl;
+            std::ostringstream fields;
+            fields << ",\"source\":\"" << json_escape(source) << "\""
+                   << ",\"message\":\"" << json_escape(error ? error->message : nullptr) << "\""
+                   << ",\"debug\":\"" << json_escape(debug) << "\"";
+            emit_event_(is_error ? "gst_error" : "gst_warning", fields.str());
+            if (error) {
+                g_error_free(error);
+            }
+            g_free(debug);
+            break;
+        }
+        case GST_MESSAGE_EOS:
+            eos_ = true;
+            failed_ = true;
+            std::cerr << "GStreamer end of stream on " << device_name_ << std::endl;
+            emit_event_("gst_eos", "");
+            break;
+        case GST_MESSAGE_QOS: {
+            GstFormat format = GST_FORMAT_UNDEFINED;
+            guint64 processed = 0;
+            guint64 dropped = 0;
+            gst_message_parse_qos_stats(message, &format, &processed, &dropped);
+            qos_messages_++;
+            // Running totals kept by the element that posted it
+            if (format == GST_FORMAT_BUFFERS) {
+                qos_processed_ = processed;
+                qos_dropped_ = dropped;
+            }
+            break;
+        }
+        case GST_MESSAGE_LATENCY:
+            // An element's latency changed: redistribute, then re-read it
+            gst_bin_recalculate_latency(GST_BIN(pipeline_));
+            query_latency_();
+            break;
+        default:
+            break;
+    }
+}
+
+void CameraPipeline::bus_thread_func_() {
+    GstBus* bus = gst_element_get_bus(pipeline_);
+    const GstMessageType types = static_cast<GstMessageType>(
+        GST_MESSAGE_ERROR | GST_MESSAGE_WARNING | GST_MESSAGE_EOS | GST_MESSAGE_QOS | GST_MESSAGE_LATENCY);
+    uint64_t last_health_us = steady_now_us();
+    uint64_t last_stats_us = last_health_us;
+    uint64_t reported_overruns = 0;
+    bool stalled = false;
+
+    while (bus_running_) {
+        GstMessage* message = gst_bus_timed_pop_filtered(bus, 100 * GST_MSECOND, types);
+        if (message) {
+            handle_bus_message_(message);
+            gst_message_unref(message);
+        }
+
+        const uint64_t now_us = steady_now_us();
+        if (now_us - last_health_us < PIPELINE_HEALTH_INTERVAL_US) {
+            continue;
+        }
+        last_health_us = now_us;
+        query_latency_();
+
+        const uint64_t overruns = queue_overruns_.load(std::memory_order_relaxed);
+        if (overruns > reported_overruns) {
+            std::ostringstream fields;
+            fields << ",\"new_overruns\":" << (overruns - reported_overruns)
+                   << ",\"total_overruns\":" << overruns;
+            emit_event_("gst_queue_overrun", fields.str());
+            reported_overruns = overruns;
+        }
+
+        const uint64_t last_frame_us = last_frame_us_.load(std::memory_order_relaxed);
+        const uint64_t since_frame_us = now_us > last_frame_us ? now_us - last_frame_us : 0;
+        // Only the appsink path sees frames; a display pipeline never updates last_frame_us_
+        if (!stalled && sink_mode_ == SinkMode::APPSINK && since_frame_us > CAMERA_STALL_US) {
+            stalled = true;
+            stalls_++;
+            std::cerr << "No frames from " << device_name_ << " for " << since_frame_us / 1000 << " ms" << std::endl;
+            emit_event_("camera_stall", ",\"since_last_frame_us\":" + std::to_string(since_frame_us));
+        } else if (stalled && since_frame_us <= CAMERA_STALL_US) {
+            stalled = false;
+            emit_event_("camera_resume", "");
+        }
+
+        if (now_us - last_stats_us >= PIPELINE_STATS_EVENT_INTERVAL_US) {
+            last_stats_us = now_us;
+            const PipelineHealth h = health();
+            std::ostringstream fields;
+            fields << ",\"errors\":" << h.errors
+                   << ",\"warnings\":" << h.warnings
+                   << ",\"qos_messages\":" << h.qos_messages
+                   << ",\"qos_processed\":" << h.qos_processed
+                   << ",\"qos_dropped\":" << h.qos_dropped
+                   << ",\"queue_overruns\":" << h.queue_overruns
+                   << ",\"live\":" << (h.live ? "true" : "false")
+                   << ",\"latency_min_ns\":" << h.latency_min_ns
+                   << ",\"latency_max_ns\":" << h.latency_max_ns;
+            emit_event_("gst_pipeline_stats", fields.str());
+        }
+    }
+    gst_object_unref(bus);
 }
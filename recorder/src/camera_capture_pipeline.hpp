@@ -2,14 +2,19 @@
 
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
+#include <atomic>
 #include <string>
 #include <functional>
 #include <iostream>
 #include <chrono>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <cstdint>
 #include <cstring>
 
+#include "pipeline_health.hpp"
+
 enum class SinkMode {
     DISPLAY,  // Use fpsdisplaysink for visual output
     APPSINK   // Use appsink for programmatic frame access
@@ -24,6 +29,52 @@ enum class CameraFormat {
 // Camera capture configuration
 constexpr CameraFormat CAMERA_CAPTURE_FORMAT = CameraFormat::YUYV;
 
+// Default depth of the GStreamer queue between v4l2src and the sink
+constexpr int DEFAULT_QUEUE_MAX_BUFFERS = 30;
+
+// No frame for this long while PLAYING is reported as a camera stall
+constexpr uint64_t CAMERA_STALL_US = 2'000'000;
+// How often the bus thread queries latency and reports overruns / stats
+constexpr uint64_t PIPELINE_HEALTH_INTERVAL_US = 1'000'000;
+constexpr uint64_t PIPELINE_STATS_EVENT_INTERVAL_US = 10'000'000;
+
+// Per-camera capture pipeline, in gst-launch syntax, replacing the built-in
+// v4l2src ! capsfilter ! queue ! appsink chain in APPSINK mode. It must end in
+// an appsink named "app-sink" delivering {format} at {width}x{height}; the
+// recorder installs its frame callback there. A queue named "ring-buffer", if
+// present, gets the overrun accounting. Placeholders:
+//   {device} {width} {height} {framerate} {format} {queue_max_buffers}
+// where {format} is the GStreamer name of CAMERA_CAPTURE_FORMAT (YUY2).
+// Appsink and queue properties are the template's to set; see
+// DEFAULT_PIPELINE_TEMPLATE for the equivalent of the built-in pipeline.
+constexpr const char* PIPELINE_APPSINK_NAME = "app-sink";
+constexpr const char* PIPELINE_QUEUE_NAME = "ring-buffer";
+constexpr const char* DEFAULT_PIPELINE_TEMPLATE =
+    "v4l2src device={device} name=camera-source"
+    " ! video/x-raw,format={format},width={width},height={height},framerate={framerate}/1"
+    " ! queue name=ring-buffer max-size-buffers={queue_max_buffers} max-size-bytes=0 max-size-time=0 leaky=downstream"
+    " ! appsink name=app-sink sync=false max-buffers=1 drop=true";
+
+// Substitutes the placeholders above. Other braces (e.g. caps lists) are left alone.
+std::string expand_pipeline_template(
+    const std::string& pipeline_template,
+    const std::string& device,
+    int width,
+    int height,
+    int framerate,
+    CameraFormat format,
+    int queue_max_buffers
+);
+
+inline size_t camera_format_bytes_per_pixel(CameraFormat format) {
+    switch (format) {
+        case CameraFormat::YUYV: return 2;
+        case CameraFormat::RGB: return 3;
+        case CameraFormat::GRAY: return 1;
+    }
+    return 3;
+}
+
 // Camera frame structure containing all frame data
 struct CameraFrame {
     uint64_t sequence_number;
@@ -42,6 +93,10 @@ struct CameraFrame {
 // Callback type for frame processing
 using FrameCallback = std::function<void(const CameraFrame& frame, bool trigger_record)>;
 
+// Receives one JSON object per pipeline event (error, warning, EOS, stall,
+// queue overruns, periodic stats), from the bus thread
+using PipelineEventCallback = std::function<void(const std::string& json_object)>;
+
 class CameraPipeline {
 private:
     GstElement *pipeline_, *source_, *capsfilter_, *queue_, *sink_;
@@ -51,10 +106,41 @@ private:
     std::string device_name_;
     bool trigger_record_;
     uint64_t sequence_counter_;
+    CameraFrame frame_;  // reused by on_new_sample_ so a steady stream doesn't allocate
     CameraFormat camera_format_;
+    int expected_width_;
+    int expected_height_;
+    std::string pipeline_template_;
+    std::string pipeline_description_;  // expanded template, empty for the built-in pipeline
+
+    // Bus watching: one thread per pipeline, started/stopped with it
+    PipelineEventCallback event_callback_;
+    std::unique_ptr<std::thread> bus_thread_;
+    std::atomic<bool> bus_running_{false};
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> last_frame_us_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> warnings_{0};
+    std::atomic<bool> eos_{false};
+    std::atomic<uint64_t> qos_messages_{0};
+    std::atomic<uint64_t> qos_processed_{0};
+    std::atomic<uint64_t> qos_dropped_{0};
+    std::atomic<uint64_t> queue_overruns_{0};
+    std::atomic<bool> live_{false};
+    std::atomic<uint64_t> latency_min_ns_{0};
+    std::atomic<uint64_t> latency_max_ns_{0};
+    std::atomic<uint64_t> stalls_{0};
     
     // Static callback function for appsink
     static GstFlowReturn on_new_sample_(GstAppSink* appsink, gpointer user_data);
+    // "overrun" signal of the leaky queue, from the streaming thread
+    static void on_queue_overrun_(GstElement* queue, gpointer user_data);
+
+    bool build_from_template_(const std::string& description);
+    void bus_thread_func_();
+    void handle_bus_message_(GstMessage* message);
+    void query_latency_();
+    void emit_event_(const std::string& event_type, const std::string& fields);
 
 public:
     CameraPipeline();
@@ -68,9 +154,20 @@ public:
         SinkMode mode = SinkMode::DISPLAY,
         FrameCallback callback = nullptr,
         bool trigger_record_flag = false,
-        bool enable_fps_debug = false
+        bool enable_fps_debug = false,
+        int queue_max_buffers = DEFAULT_QUEUE_MAX_BUFFERS
     );
     
+    // Set before initialize(); empty keeps the built-in pipeline
+    void set_pipeline_template(const std::string& pipeline_template) { pipeline_template_ = pipeline_template; }
+
+    // Set before start()
+    void set_event_callback(PipelineEventCallback callback) { event_callback_ = std::move(callback); }
+
     bool start();
     void stop();
+
+    PipelineHealth health() const;
+    // An error or EOS came over the bus: the camera is gone or the pipeline is dead
+    bool has_failed() const { return failed_.load(); }
 };
@@ -0,0 +1,317 @@
+#include "dataset_exporter.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include "joint_state.hpp"
+#include "jsonl_parse.hpp"
+
+namespace {
+
+const char* const EXPORT_CAMERAS[][2] = {
+    {"/dev/cam_front", "cam_front"},
+    {"/dev/cam_right", "cam_right"},
+};
+
+std::string chunk_name(const std::string& stem, uint64_t chunk_index) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "chunk_%05llu.rgb", static_cast<unsigned long long>(chunk_index));
+    return stem + "/" + name;
+}
+
+// Center crop to the output aspect ratio, then area-resize
+void crop_and_resize(const cv::Mat& rgb, cv::Mat& out, int width, int height, bool center_crop) {
+    cv::Mat roi = rgb;
+    if (center_crop) {
+        const double target_aspect = static_cast<double>(width) / height;
+        const double source_aspect = static_cast<double>(rgb.cols) / rgb.rows;
+        if (source_aspect > target_aspect) {
+            int crop_width = static_cast<int>(std::lround(rgb.rows * target_aspect));
+            roi = rgb(cv::Rect((rgb.cols - crop_width) / 2, 0, crop_width, rgb.rows));
+        } else if (source_aspect < target_aspect) {
+            int crop_height = static_cast<int>(std::lround(rgb.cols / target_aspect));
+            roi = rgb(cv::Rect(0, (rgb.rows - crop_height) / 2, rgb.cols, crop_height));
+        }
+    }
+    cv::resize(roi, out, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+}
+
+} // namespace
+
+DatasetExporter::DatasetExporter(const ExportOptions& options) : options_(options) {
+    if (options_.num_threads <= 0) {
+        options_.num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+bool DatasetExporter::prepare_episode_(
+    const std::string& session_dir, const std::string& output_dir, Episode& episode
+) {
+    episode.session_dir = session_dir;
+    episode.name = std::filesystem::path(session_dir).filename().string();
+    if (episode.name.empty()) {
+        episode.name = std::filesystem::path(session_dir).parent_path().filename().string();
+    }
+    episode.output_dir = output_dir + "/" + episode.name;
+
+    for (const auto& camera_entry : EXPORT_CAMERAS) {
+        auto camera = std::make_unique<ExportCamera>();
+        camera->stem = camera_entry[1];
+        if (!read_session_camera_config(session_dir, camera_entry[0], camera->config)) {
+            return false;
+        }
+        camera->video_path = find_session_video(session_dir, camera->stem, camera->is_raw);
+        if (camera->video_path.empty()) {
+            std::cerr << "No " << camera->stem << " video in " << session_dir << std::endl;
+            return false;
+        }
+        if (camera->is_raw) {
+            const uint64_t frame_bytes = static_cast<uint64_t>(camera->config.width) * camera->config.height * 2;
+            camera->raw_frame_count = std::filesystem::file_size(camera->video_path) / frame_bytes;
+        }
+        std::filesystem::create_directories(episode.output_dir + "/" + camera->stem);
+        episode.cameras.push_back(std::move(camera));
+    }
+    return true;
+}
+
+bool DatasetExporter::export_camera_(
+    Episode& episode, ExportCamera& camera, uint64_t first_frame, uint64_t end_frame
+) {
+    const int src_width = camera.config.width;
+    const int src_height = camera.config.height;
+    const size_t out_frame_bytes = static_cast<size_t>(options_.width) * options_.height * 3;
+
+    std::ifstream raw_file;
+    std::unique_ptr<cv::VideoCapture> capture;
+    std::vector<uint8_t> yuyv;
+    if (camera.is_raw) {
+        raw_file.open(camera.video_path, std::ios::in | std::ios::binary);
+        yuyv.resize(static_cast<size_t>(src_width) * src_height * 2);
+        raw_file.seekg(static_cast<std::streamoff>(first_frame * yuyv.size()));
+    } else {
+        capture = std::make_unique<cv::VideoCapture>(camera.video_path);
+    }
+    if ((camera.is_raw && !raw_file) || (!camera.is_raw && !capture->isOpened())) {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        std::cerr << "Failed to open " << camera.video_path << std::endl;
+        return false;
+    }
+
+    cv::Mat decoded, rgb, resized;
+    std::ofstream chunk_file;
+    uint64_t frame = first_frame;
+    while (end_frame == 0 || frame < end_frame) {
+        if (camera.is_raw) {
+            if (!raw_file.read(reinterpret_cast<char*>(yuyv.data()), yuyv.size())) {
+                break;
+            }
+            cv::Mat yuyv_image(src_height, src_width, CV_8UC2, yuyv.data());
+            cv::cvtColor(yuyv_image, rgb, cv::COLOR_YUV2RGB_YUY2);
+        } else {
+            if (!capture->read(decoded) || decoded.empty()) {
+                break;
+            }
+            cv::cvtColor(decoded, rgb, cv::COLOR_BGR2RGB);
+        }
+        crop_and_resize(rgb, resized, options_.width, options_.height, options_.center_crop);
+
+        // Chunks are frame-aligned, so a raw task never shares a chunk file with another
+        if (frame % options_.chunk_frames == 0 || !chunk_file.is_open()) {
+            chunk_file.close();
+            std::string path = episode.output_dir + "/" + chunk_name(camera.stem, frame / options_.chunk_frames);
+            chunk_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!chunk_file.is_open()) {
+                std::lock_guard<std::mutex> lock(log_mutex_);
+                std::cerr << "Failed to create " << path << std::endl;
+                return false;
+            }
+        }
+        chunk_file.write(reinterpret_cast<const char*>(resized.data), out_frame_bytes);
+        frame++;
+    }
+
+    camera.frames_written += frame - first_frame;
+    return chunk_file.good() || frame == first_frame;
+}
+
+bool DatasetExporter::export_sync_log_(Episode& episode) {
+    const std::string sync_log_path = session_output_file(episode.session_dir, "sync_log", "sync_log.jsonl");
+    std::ifstream sync_log(sync_log_path);
+    if (!sync_log.is_open()) {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        std::cerr << "Failed to open " << sync_log_path << std::endl;
+        return false;
+    }
+    std::ofstream timestamps(episode.output_dir + "/timestamps_us.u64", std::ios::binary | std::ios::trunc);
+    std::ofstream joint_pos(episode.output_dir + "/joint_pos.f32", std::ios::binary | std::ios::trunc);
+    std::ofstream joint_cmd(episode.output_dir + "/joint_cmd.f32", std::ios::binary | std::ios::trunc);
+
+    std::string line;
+    uint64_t rows = 0;
+    bool any_joint_state = false;
+    while (std::getline(sync_log, line)) {
+        uint64_t timestamp_us = 0;
+        if (sync_log_is_skipped_run(line) || !jsonl_get_uint(line, "timestamp", timestamp_us)) {
+            continue;
+        }
+        float pos[NUM_JOINTS], cmd[NUM_JOINTS];
+        bool has_joint = jsonl_get_float_array(line, "joint_pos", pos, NUM_JOINTS) == NUM_JOINTS &&
+                         jsonl_get_float_array(line, "joint_cmd", cmd, NUM_JOINTS) == NUM_JOINTS;
+        if (!has_joint) {
+            std::fill(pos, pos + NUM_JOINTS, NAN);
+            std::fill(cmd, cmd + NUM_JOINTS, NAN);
+        }
+        any_joint_state |= has_joint;
+        timestamps.write(reinterpret_cast<const char*>(&timestamp_us), sizeof(timestamp_us));
+        joint_pos.write(reinterpret_cast<const char*>(pos), sizeof(pos));
+        joint_cmd.write(reinterpret_cast<const char*>(cmd), sizeof(cmd));
+        rows++;
+    }
+    joint_pos.close();
+    joint_cmd.close();
+    if (!any_joint_state) {
+        std::filesystem::remove(episode.output_dir + "/joint_pos.f32");
+        std::filesystem::remove(episode.output_dir + "/joint_cmd.f32");
+    }
+    episode.num_bundles = rows;
+    episode.has_joint_state = any_joint_state;
+    return timestamps.good();
+}
+
+void DatasetExporter::worker_func_(MPMCRingBuffer<ExportTask>& tasks) {
+    // Parallelism comes from the pool; keep OpenCV from oversubscribing cores
+    cv::setNumThreads(1);
+    while (true) {
+        ExportTask task;
+        tasks.pop(task);
+        if (task.kind == TaskKind::STOP) {
+            return;
+        }
+        Episode& episode = *episodes_[task.episode];
+        bool ok = (task.kind == TaskKind::SYNC_LOG)
+            ? export_sync_log_(episode)
+            : export_camera_(episode, *episode.cameras[task.camera], task.first_frame, task.end_frame);
+        if (!ok) {
+            episode.failed.store(true);
+        }
+    }
+}
+
+bool DatasetExporter::write_episode_index_(const Episode& episode) const {
+    std::ofstream index(episode.output_dir + "/index.json");
+    if (!index.is_open()) {
+        std::cerr << "Failed to write " << episode.output_dir << "/index.json" << std::endl;
+        return false;
+    }
+    index << "{\n";
+    index << "  \"session\": \"" << episode.session_dir << "\",\n";
+    index << "  \"num_bundles\": " << episode.num_bundles << ",\n";
+    index << "  \"cameras\": {\n";
+    for (size_t c = 0; c < episode.cameras.size(); c++) {
+        const ExportCamera& camera = *episode.cameras[c];
+        const uint64_t frames = camera.frames_written.load();
+        index << "    \"" << camera.stem << "\": {\n";
+        index << "      \"frames\": " << frames << ",\n";
+        index << "      \"dtype\": \"uint8\",\n";
+        index << "      \"frame_shape\": [" << options_.height << ", " << options_.width << ", 3],\n";
+        index << "      \"source_size\": [" << camera.config.height << ", " << camera.config.width << "],\n";
+        index << "      \"chunk_frames\": " << options_.chunk_frames << ",\n";
+        index << "      \"chunks\": [";
+        const uint64_t num_chunks = (frames + options_.chunk_frames - 1) / options_.chunk_frames;
+        for (uint64_t k = 0; k < num_chunks; k++) {
+            index << (k ? ", " : "") << "\"" << chunk_name(camera.stem, k) << "\"";
+        }
+        index << "]\n";
+        index << "    }" << (c + 1 < episode.cameras.size() ? "," : "") << "\n";
+    }
+    index << "  },\n";
+    index << "  \"arrays\": {\n";
+    index << "    \"timestamps_us\": {\"file\": \"timestamps_us.u64\", \"dtype\": \"uint64\", \"shape\": [" 
+          << episode.num_bundles << "]}";
+    if (episode.has_joint_state) {
+        index << ",\n    \"joint_pos\": {\"file\": \"joint_pos.f32\", \"dtype\": \"float32\", \"shape\": [" 
+              << episode.num_bundles << ", " << NUM_JOINTS << "]}";
+        index << ",\n    \"joint_cmd\": {\"file\": \"joint_cmd.f32\", \"dtype\": \"float32\", \"shape\": [" 
+              << episode.num_bundles << ", " << NUM_JOINTS << "]}";
+    }
+    index << "\n  }\n";
+    index << "}\n";
+    return index.good();
+}
+
+bool DatasetExporter::export_sessions(const std::vector<std::string>& session_dirs, const std::string& output_dir) {
+    std::filesystem::create_directories(output_dir);
+
+    std::vector<ExportTask> task_list;
+    for (const std::string& session_dir : session_dirs) {
+        auto episode = std::make_unique<Episode>();
+        if (!prepare_episode_(session_dir, output_dir, *episode)) {
+            std::cerr << "Skipping " << session_dir << std::endl;
+            continue;
+        }
+        const size_t e = episodes_.size();
+        task_list.push_back({TaskKind::SYNC_LOG, e, 0, 0, 0});
+        for (size_t c = 0; c < episode->cameras.size(); c++) {
+            const ExportCamera& camera = *episode->cameras[c];
+            if (!camera.is_raw) {
+                task_list.push_back({TaskKind::CAMERA, e, c, 0, 0});
+                continue;
+            }
+            // Raw captures are seekable: one task per output chunk
+            for (uint64_t first = 0; first < camera.raw_frame_count; first += options_.chunk_frames) {
+                uint64_t end = std::min<uint64_t>(first + options_.chunk_frames, camera.raw_frame_count);
+                task_list.push_back({TaskKind::CAMERA, e, c, first, end});
+            }
+        }
+        episodes_.push_back(std::move(episode));
+    }
+    if (episodes_.empty()) {
+        std::cerr << "No sessions to export" << std::endl;
+        return false;
+    }
+
+    std::cout << "Exporting " << episodes_.size() << " session(s) as " << task_list.size() 
+              << " tasks on " << options_.num_threads << " threads" << std::endl;
+
+    // Sized so the producer never blocks: every task plus one STOP per worker
+    MPMCRingBuffer<ExportTask> tasks(static_cast<int>(task_list.size()) + options_.num_threads);
+    for (const ExportTask& task : task_list) {
+        tasks.push(task);
+    }
+    for (int i = 0; i < options_.num_threads; i++) {
+        tasks.push(ExportTask());
+    }
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options_.num_threads; i++) {
+        workers.emplace_back(&DatasetExporter::worker_func_, this, std::ref(tasks));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    bool all_ok = true;
+    std::ofstream index(output_dir + "/index.json");
+    index << "{\n  \"width\": " << options_.width << ",\n  \"height\": " << options_.height 
+          << ",\n  \"episodes\": [\n";
+    bool first = true;
+    for (const auto& episode : episodes_) {
+        if (episode->failed.load() || !write_episode_index_(*episode)) {
+            std::cerr << "Export failed: " << episode->session_dir << std::endl;
+            all_ok = false;
+            continue;
+        }
+        index << (first ? "" : ",\n") << "    {\"name\": \"" << episode->name 
+              << "\", \"num_bundles\": " << episode->num_bundles << "}";
+        first = false;
+        std::cout << "Exported " << episode->name << ": " << episode->num_bundles << " bundles" << std::endl;
+    }
+    index << "\n  ]\n}\n";
+    return all_ok;
+}
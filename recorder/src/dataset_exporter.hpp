@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "mpmc_ring_buffer.hpp"
+#include "session_metadata.hpp"
+
+/*
+    Converts recording directories (as written by Recorder::run) into the
+    chunked training format:
+
+      <output>/index.json                     episodes and their frame counts
+      <output>/<episode>/index.json           shapes, dtypes and chunk files
+      <output>/<episode>/cam_front/chunk_00000.rgb
+                                              uint8 [n, height, width, 3] RGB
+      <output>/<episode>/timestamps_us.u64    uint64 [N] front capture time per bundle
+      <output>/<episode>/joint_pos.f32        float32 [N, 6] (NaN where no sample)
+      <output>/<episode>/joint_cmd.f32        float32 [N, 6]
+
+    Every file is a bare little-endian array, so training code can np.memmap
+    it directly. Frame i of every camera belongs to sync_log row i.
+
+    Work is split into tasks (one per camera stream, or per chunk for raw
+    .yuyv captures, which can be seeked) and spread over a worker pool, so
+    several sessions are decoded concurrently and all cores stay busy.
+*/
+
+struct ExportOptions {
+    int width = 224;
+    int height = 224;
+    int chunk_frames = 256;
+    int num_threads = 0;        // 0 = hardware concurrency
+    bool center_crop = true;    // crop to the output aspect ratio before resizing
+};
+
+class DatasetExporter {
+private:
+    struct ExportCamera {
+        std::string stem;                  // cam_front / cam_right
+        SessionCameraConfig config;
+        std::string video_path;
+        bool is_raw = false;
+        uint64_t raw_frame_count = 0;
+        std::atomic<uint64_t> frames_written{0};
+    };
+
+    struct Episode {
+        std::string session_dir;
+        std::string name;
+        std::string output_dir;
+        std::vector<std::unique_ptr<ExportCamera>> cameras;
+        uint64_t num_bundles = 0;
+        bool has_joint_state = false;
+        std::atomic<bool> failed{false};
+    };
+
+    enum class TaskKind { CAMERA, SYNC_LOG, STOP };
+
+    struct ExportTask {
+        TaskKind kind = TaskKind::STOP;
+        size_t episode = 0;
+        size_t camera = 0;
+        uint64_t first_frame = 0;       // raw captures: chunk-aligned frame range
+        uint64_t end_frame = 0;         // 0 = whole stream (decoded video)
+    };
+
+    ExportOptions options_;
+    std::vector<std::unique_ptr<Episode>> episodes_;
+    std::mutex log_mutex_;
+
+    bool prepare_episode_(const std::string& session_dir, const std::string& output_dir, Episode& episode);
+    void worker_func_(MPMCRingBuffer<ExportTask>& tasks);
+    bool export_camera_(Episode& episode, ExportCamera& camera, uint64_t first_frame, uint64_t end_frame);
+    bool export_sync_log_(Episode& episode);
+    bool write_episode_index_(const Episode& episode) const;
+
+public:
+    explicit DatasetExporter(const ExportOptions& options);
+
+    // Exports every session; returns false if any of them failed.
+    bool export_sessions(const std::vector<std::string>& session_dirs, const std::string& output_dir);
+};
@@ -0,0 +1,154 @@
+#include "flight_recorder.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "joint_state.hpp"
+#include "trace_probes.hpp"
+
+FlightRecorder::FlightRecorder()
+    : fd_(-1), mapping_(nullptr), mapping_size_(0), header_(nullptr),
+      records_(nullptr), capacity_(0) {}
+
+FlightRecorder::~FlightRecorder() {
+    finalize();
+}
+
+bool FlightRecorder::initialize(const std::string& path, uint64_t capacity) {
+    path_ = path;
+    capacity_ = capacity;
+    mapping_size_ = FLIGHT_RECORDER_HEADER_SIZE + capacity * sizeof(FlightRecord);
+
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open flight recorder file " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    bool reuse = fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) == mapping_size_;
+    if (!reuse && ftruncate(fd_, 0) != 0) {
+        std::cerr << "Failed to reset flight recorder file " << path << std::endl;
+        finalize();
+        return false;
+    }
+    if (!reuse && ftruncate(fd_, mapping_size_) != 0) {
+        std::cerr << "Failed to size flight recorder file " << path << std::endl;
+        finalize();
+        return false;
+    }
+
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "Failed to map flight recorder file " << path << ": " << strerror(errno) << std::endl;
+        finalize();
+        return false;
+    }
+
+    header_ = static_cast<FlightRecorderHeader*>(mapping_);
+    if (reuse && (std::memcmp(header_->magic, FLIGHT_RECORDER_MAGIC, 4) != 0 ||
+                  header_->version != FLIGHT_RECORDER_VERSION ||
+                  header_->capacity != capacity)) {
+        reuse = false;
+        std::memset(mapping_, 0, mapping_size_);
+    }
+    if (!reuse) {
+        // Fresh file: ftruncate zero-filled it, so every commit stamp is 0
+        std::memcpy(header_->magic, FLIGHT_RECORDER_MAGIC, 4);
+        header_->version = FLIGHT_RECORDER_VERSION;
+        header_->record_size = sizeof(FlightRecord);
+        header_->capacity = capacity;
+        header_->cursor.store(0, std::memory_order_release);
+    }
+    records_ = reinterpret_cast<FlightRecord*>(static_cast<char*>(mapping_) + FLIGHT_RECORDER_HEADER_SIZE);
+
+    std::cout << "FlightRecorder initialized: " << path << " (" << capacity << " records, "
+              << (reuse ? "continuing" : "new") << ")" << std::endl;
+    return true;
+}
+
+void FlightRecorder::record(
+    FlightRecordType type, uint16_t source, uint64_t timestamp_us,
+    uint64_t sequence_number, const void* payload, uint32_t payload_size
+) {
+    if (!records_) {
+        return;
+    }
+    const uint64_t slot = header_->cursor.fetch_add(1, std::memory_order_relaxed);
+    FlightRecord& r = records_[slot % capacity_];
+
+    // Invalidate first so a reader (or a crash) never sees a half-written record
+    r.commit.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    r.timestamp_us = timestamp_us;
+    r.sequence_number = sequence_number;
+    r.type = static_cast<uint16_t>(type);
+    r.source = source;
+    r.payload_size = payload_size < sizeof(r.payload) ? payload_size : sizeof(r.payload);
+    std::memcpy(r.payload, payload, r.payload_size);
+
+    r.commit.store(slot + 1, std::memory_order_release);
+}
+
+void FlightRecorder::record_event(FlightEventCode code, uint64_t timestamp_us, uint64_t arg, const char* text) {
+    FlightEventPayload event{};
+    event.code = static_cast<uint32_t>(code);
+    event.arg = arg;
+    if (text) {
+        std::strncpy(event.text, text, sizeof(event.text));
+    }
+    record(FlightRecordType::RECORDER_EVENT, 0, timestamp_us, 0, &event, sizeof(event));
+}
+
+void FlightRecorder::record_process_start() {
+    if (!header_) {
+        return;
+    }
+    timespec monotonic, realtime;
+    clock_gettime(CLOCK_MONOTONIC, &monotonic);
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    const uint64_t monotonic_us = static_cast<uint64_t>(monotonic.tv_sec) * 1'000'000 + monotonic.tv_nsec / 1000;
+    const uint64_t realtime_us = static_cast<uint64_t>(realtime.tv_sec) * 1'000'000 + realtime.tv_nsec / 1000;
+    header_->realtime_anchor_us = realtime_us;
+    header_->monotonic_anchor_us = monotonic_us;
+    record_event(FlightEventCode::PROCESS_START, monotonic_us, realtime_us);
+}
+
+void FlightRecorder::record_joint_state(
+    uint64_t timestamp_us, uint64_t sequence_number, const float* position, const float* command
+) {
+    record(FlightRecordType::ROBOT_STATE, 0, timestamp_us, sequence_number, position, NUM_JOINTS * sizeof(float));
+    record(FlightRecordType::TELEOP_COMMAND, 0, timestamp_us, sequence_number, command, NUM_JOINTS * sizeof(float));
+}
+
+void FlightRecorder::record_metrics(uint64_t timestamp_us, const FlightMetricsPayload& metrics) {
+    record(FlightRecordType::METRICS_ROLLUP, 0, timestamp_us, 0, &metrics, sizeof(metrics));
+}
+
+void FlightRecorder::flush() {
+    if (mapping_) {
+        msync(mapping_, mapping_size_, MS_ASYNC);
+        ROBODAQ_PROBE(log_flush, "flight", mapping_size_);
+    }
+}
+
+void FlightRecorder::finalize() {
+    if (mapping_) {
+        msync(mapping_, mapping_size_, MS_SYNC);
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    header_ = nullptr;
+    records_ = nullptr;
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
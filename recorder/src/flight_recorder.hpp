@@ -0,0 +1,132 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Always-on flight recorder: a fixed-size, memory-mapped circular file of
+    64-byte binary records holding the last N minutes of robot state, teleop
+    commands, recorder events and metrics rollups.
+
+    Writers claim a slot with a single fetch_add on the shared cursor and
+    publish it by storing the slot's commit stamp last, so any number of
+    threads (or processes mapping the same file) can log without locks.
+    Because the file is MAP_SHARED, the records survive a crash of the
+    writing process and can be decoded afterwards with
+    tools/flight_recorder_dump.py.
+
+    Record timestamps are steady_clock, which restarts at boot. Every
+    PROCESS_START event carries the wall clock (CLOCK_REALTIME) read
+    together with its timestamp, and the header keeps the latest pair, so
+    records from before a reboot can still be placed in wall time.
+*/
+
+constexpr char FLIGHT_RECORDER_MAGIC[4] = {'R', 'D', 'F', 'R'};
+constexpr uint32_t FLIGHT_RECORDER_VERSION = 1;
+constexpr size_t FLIGHT_RECORDER_HEADER_SIZE = 4096;
+
+// Sizing estimate for --flight-recorder-minutes: robot state + command at
+// 500 Hz plus events and rollups.
+constexpr uint64_t FLIGHT_RECORDER_RECORDS_PER_SEC = 1200;
+constexpr int FLIGHT_RECORDER_DEFAULT_MINUTES = 10;
+
+enum class FlightRecordType : uint16_t {
+    ROBOT_STATE = 1,     // payload: float position[6]
+    TELEOP_COMMAND = 2,  // payload: float command[6]
+    RECORDER_EVENT = 3,  // payload: FlightEventPayload
+    METRICS_ROLLUP = 4,  // payload: FlightMetricsPayload
+};
+
+enum class FlightEventCode : uint32_t {
+    PROCESS_START = 1,   // arg: CLOCK_REALTIME in us at timestamp_us
+    SESSION_START = 2,
+    SESSION_STOP = 3,
+    FRAME_DROP = 4,      // arg: camera sequence number
+    SYNC_MISS = 5,       // arg: front sequence number
+};
+
+struct FlightEventPayload {
+    uint32_t code;
+    uint32_t reserved;
+    uint64_t arg;
+    char text[16];       // short free-form tag, NUL-padded
+};
+
+struct FlightMetricsPayload {
+    uint32_t total_frames;
+    uint32_t seq_gaps[2];         // front, right
+    float mean_latency_us[2];     // front, right
+    uint32_t ring_drops;
+    uint32_t reserved[2];
+};
+
+struct FlightRecord {
+    std::atomic<uint64_t> commit;  // slot index + 1 once fully written, 0 while writing
+    uint64_t timestamp_us;         // steady_clock, same clock as CameraFrame
+    uint64_t sequence_number;
+    uint16_t type;                 // FlightRecordType
+    uint16_t source;               // camera / joint stream index
+    uint32_t payload_size;
+    uint8_t payload[32];
+};
+
+static_assert(sizeof(FlightRecord) == 64, "FlightRecord is one cache line on disk");
+static_assert(sizeof(FlightEventPayload) <= 32, "event payload too large");
+static_assert(sizeof(FlightMetricsPayload) <= 32, "metrics payload too large");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "commit stamps must be lock-free to live in shared memory");
+
+struct FlightRecorderHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t capacity;                           // number of record slots
+    // CLOCK_REALTIME and CLOCK_MONOTONIC (steady_clock) in us, read together
+    // at the last process start; 0 in files from before they were recorded
+    uint64_t realtime_anchor_us;
+    uint64_t monotonic_anchor_us;
+    alignas(64) std::atomic<uint64_t> cursor;    // next slot to claim (monotonic)
+};
+
+class FlightRecorder {
+private:
+    int fd_;
+    void* mapping_;
+    size_t mapping_size_;
+    FlightRecorderHeader* header_;
+    FlightRecord* records_;
+    uint64_t capacity_;
+    std::string path_;
+
+public:
+    FlightRecorder();
+    ~FlightRecorder();
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    // Maps `path`, creating or resizing it to hold `capacity` records. An
+    // existing file with the same geometry is reused and keeps its history.
+    bool initialize(const std::string& path, uint64_t capacity);
+
+    // Lock-free; safe to call from any thread. No-op if not initialized.
+    void record(
+        FlightRecordType type, uint16_t source, uint64_t timestamp_us,
+        uint64_t sequence_number, const void* payload, uint32_t payload_size
+    );
+
+    void record_event(FlightEventCode code, uint64_t timestamp_us, uint64_t arg = 0, const char* text = nullptr);
+    // Stores a wall clock / steady clock pair in the header and logs it as PROCESS_START
+    void record_process_start();
+    void record_joint_state(uint64_t timestamp_us, uint64_t sequence_number, const float* position, const float* command);
+    void record_metrics(uint64_t timestamp_us, const FlightMetricsPayload& metrics);
+
+    // Schedules write-back of dirty pages; cheap, call from a slow loop.
+    void flush();
+    void finalize();
+
+    bool is_initialized() const { return records_ != nullptr; }
+};
@@ -0,0 +1,180 @@
+#include "frame_qc.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+struct QcAccumulator {
+    uint64_t luma_sum = 0;
+    uint64_t clipped_low = 0;
+    uint64_t clipped_high = 0;
+    int64_t lap_sum = 0;
+    uint64_t lap_sq_sum = 0;
+    uint64_t lap_count = 0;
+    uint64_t block_sums[QC_BLOCK_GRID * QC_BLOCK_GRID] = {};
+};
+
+inline int y_at(const uint8_t* row, int x) {
+    return row[2 * x];
+}
+
+// Luma sum and clip counts for pixels [x0, x1) of one row
+void scalar_luma_span(const uint8_t* row, int x0, int x1, uint64_t& sum, QcAccumulator& acc) {
+    for (int x = x0; x < x1; x++) {
+        int y = y_at(row, x);
+        sum += y;
+        acc.clipped_low += (y <= QC_CLIP_LOW);
+        acc.clipped_high += (y >= QC_CLIP_HIGH);
+    }
+}
+
+// Laplacian for pixels [x0, x1) of row r (needs r-1 and r+1)
+void scalar_laplacian_span(const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                           int x0, int x1, QcAccumulator& acc) {
+    for (int x = x0; x < x1; x++) {
+        int l = 4 * y_at(row, x) - y_at(row, x - 1) - y_at(row, x + 1) - y_at(up, x) - y_at(down, x);
+        acc.lap_sum += l;
+        acc.lap_sq_sum += static_cast<uint64_t>(l * l);
+        acc.lap_count++;
+    }
+}
+
+#if defined(__SSE2__)
+
+// 8 pixels per step: luma sum via SAD on the masked Y bytes, clip counts via
+// compares. A span is at most one row, so the epi16 counters can't overflow.
+void sse2_luma_span(const uint8_t* row, int x0, int x1, uint64_t& sum, QcAccumulator& acc) {
+    const __m128i y_mask = _mm_set1_epi16(0x00ff);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i low = _mm_set1_epi16(QC_CLIP_LOW + 1);
+    const __m128i high = _mm_set1_epi16(QC_CLIP_HIGH - 1);
+    __m128i sad = zero;
+    __m128i low_count = zero;
+    __m128i high_count = zero;
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 2 * x));
+        __m128i y = _mm_and_si128(px, y_mask);
+        sad = _mm_add_epi64(sad, _mm_sad_epu8(y, zero));
+        // Compare masks are -1 per hit; subtracting counts up
+        low_count = _mm_sub_epi16(low_count, _mm_cmplt_epi16(y, low));
+        high_count = _mm_sub_epi16(high_count, _mm_cmpgt_epi16(y, high));
+    }
+    alignas(16) uint64_t s[2];
+    alignas(16) int32_t l[4], h[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(s), sad);
+    _mm_store_si128(reinterpret_cast<__m128i*>(l), _mm_madd_epi16(low_count, ones));
+    _mm_store_si128(reinterpret_cast<__m128i*>(h), _mm_madd_epi16(high_count, ones));
+    sum += s[0] + s[1];
+    acc.clipped_low += l[0] + l[1] + l[2] + l[3];
+    acc.clipped_high += h[0] + h[1] + h[2] + h[3];
+    scalar_luma_span(row, x, x1, sum, acc);
+}
+
+void sse2_laplacian_span(const uint8_t* up, const uint8_t* row, const uint8_t* down,
+                         int x0, int x1, QcAccumulator& acc) {
+    const __m128i y_mask = _mm_set1_epi16(0x00ff);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();      // epi32; |L| <= 1020 so a row can't overflow
+    __m128i sq_sum = _mm_setzero_si128();   // epi32; flushed every 256 iterations
+    int x = x0;
+    int iterations = 0;
+    auto flush_sq = [&]() {
+        alignas(16) uint32_t q[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(q), sq_sum);
+        acc.lap_sq_sum += static_cast<uint64_t>(q[0]) + q[1] + q[2] + q[3];
+        sq_sum = _mm_setzero_si128();
+    };
+    // The right-neighbour load reads through pixel x+8, which must stay inside the row
+    for (; x + 8 <= x1; x += 8) {
+        __m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 2 * x)), y_mask);
+        __m128i l = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 2 * x - 2)), y_mask);
+        __m128i r = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 2 * x + 2)), y_mask);
+        __m128i u = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(up + 2 * x)), y_mask);
+        __m128i d = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(down + 2 * x)), y_mask);
+        __m128i lap = _mm_sub_epi16(_mm_slli_epi16(c, 2), _mm_add_epi16(_mm_add_epi16(l, r), _mm_add_epi16(u, d)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(lap, ones));
+        sq_sum = _mm_add_epi32(sq_sum, _mm_madd_epi16(lap, lap));
+        acc.lap_count += 8;
+        if (++iterations == 256) {
+            flush_sq();
+            iterations = 0;
+        }
+    }
+    flush_sq();
+    alignas(16) int32_t s[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(s), sum);
+    acc.lap_sum += static_cast<int64_t>(s[0]) + s[1] + s[2] + s[3];
+    scalar_laplacian_span(up, row, down, x, x1, acc);
+}
+
+#endif
+
+FrameQcStats finish(const QcAccumulator& acc, int width, int height) {
+    FrameQcStats stats;
+    const double pixels = static_cast<double>(width) * height;
+    stats.mean_luma = acc.luma_sum / pixels;
+    stats.clipped_low_fraction = acc.clipped_low / pixels;
+    stats.clipped_high_fraction = acc.clipped_high / pixels;
+    if (acc.lap_count > 0) {
+        const double mean = static_cast<double>(acc.lap_sum) / acc.lap_count;
+        stats.laplacian_variance = static_cast<double>(acc.lap_sq_sum) / acc.lap_count - mean * mean;
+    } else {
+        stats.laplacian_variance = 0.0;
+    }
+    // FNV-1a over the block sums
+    uint64_t hash = 1469598103934665603ull;
+    for (uint64_t block_sum : acc.block_sums) {
+        hash = (hash ^ block_sum) * 1099511628211ull;
+    }
+    stats.block_hash = hash;
+    return stats;
+}
+
+template<typename LumaSpan, typename LaplacianSpan>
+FrameQcStats compute(const uint8_t* yuyv, int width, int height, LumaSpan luma_span, LaplacianSpan laplacian_span) {
+    QcAccumulator acc;
+    const int row_bytes = width * 2;
+    const int block_width = width / QC_BLOCK_GRID;
+    const int block_height = height / QC_BLOCK_GRID;
+
+    for (int r = 0; r < height; r++) {
+        const uint8_t* row = yuyv + static_cast<size_t>(r) * row_bytes;
+
+        // Luma per block column so the same pass feeds the frozen-frame hash
+        const int block_row = block_height > 0 ? r / block_height : 0;
+        for (int bc = 0; bc < QC_BLOCK_GRID; bc++) {
+            uint64_t segment_sum = 0;
+            luma_span(row, bc * block_width, (bc + 1) * block_width, segment_sum, acc);
+            acc.luma_sum += segment_sum;
+            if (block_row < QC_BLOCK_GRID) {
+                acc.block_sums[block_row * QC_BLOCK_GRID + bc] += segment_sum;
+            }
+        }
+        uint64_t tail_sum = 0;
+        scalar_luma_span(row, QC_BLOCK_GRID * block_width, width, tail_sum, acc);
+        acc.luma_sum += tail_sum;
+
+        if (r > 0 && r < height - 1) {
+            laplacian_span(row - row_bytes, row, row + row_bytes, 1, width - 1, acc);
+        }
+    }
+    return finish(acc, width, height);
+}
+
+} // namespace
+
+FrameQcStats compute_frame_qc_scalar(const uint8_t* yuyv, int width, int height) {
+    return compute(yuyv, width, height, scalar_luma_span, scalar_laplacian_span);
+}
+
+FrameQcStats compute_frame_qc(const uint8_t* yuyv, int width, int height) {
+#if defined(__SSE2__)
+    return compute(yuyv, width, height, sse2_luma_span, sse2_laplacian_span);
+#else
+    return compute_frame_qc_scalar(yuyv, width, height);
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// Blocks per side for the frozen-frame hash
+constexpr int QC_BLOCK_GRID = 8;
+
+// Y values at or past these count as clipped
+constexpr uint8_t QC_CLIP_LOW = 5;
+constexpr uint8_t QC_CLIP_HIGH = 250;
+
+struct FrameQcStats {
+    double mean_luma;               // 0-255
+    double clipped_low_fraction;    // Y <= QC_CLIP_LOW
+    double clipped_high_fraction;   // Y >= QC_CLIP_HIGH
+    double laplacian_variance;      // sharpness proxy; drops when out of focus or covered
+    uint64_t block_hash;            // hash of per-block Y sums; repeats only if the sensor output is identical
+};
+
+/*
+    Per-frame image statistics straight from the Y samples of a YUYV frame,
+    one pass over the image (SSE2 when available, scalar otherwise).
+    `width` must be even and `height` at least 3.
+*/
+FrameQcStats compute_frame_qc(const uint8_t* yuyv, int width, int height);
+
+// Scalar reference, also used for the tails the vector path doesn't cover.
+FrameQcStats compute_frame_qc_scalar(const uint8_t* yuyv, int width, int height);
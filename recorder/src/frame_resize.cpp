@@ -0,0 +1,269 @@
+#include "frame_resize.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// BT.601 limited range, 20-bit fixed point (OpenCV's ITUR_BT_601_* constants)
+constexpr int YUV_SHIFT = 20;
+constexpr int YUV_CY = 1220542;
+constexpr int YUV_CUB = 2116026;
+constexpr int YUV_CUG = -409993;
+constexpr int YUV_CVG = -852492;
+constexpr int YUV_CVR = 1673527;
+
+// Source samples per output beyond which bilinear skips samples; box filter instead
+constexpr double BILINEAR_MAX_RATIO = 2.0;
+
+inline uint8_t clamp_u8(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+// Limited-range luma and centred chroma -> one BGR pixel
+inline void store_bgr(uint8_t* out, int luma, int u, int v) {
+    constexpr int round = 1 << (YUV_SHIFT - 1);
+    const int scaled_y = std::max(0, luma - 16) * YUV_CY + round;
+    out[0] = clamp_u8((scaled_y + YUV_CUB * u) >> YUV_SHIFT);
+    out[1] = clamp_u8((scaled_y + YUV_CVG * v + YUV_CUG * u) >> YUV_SHIFT);
+    out[2] = clamp_u8((scaled_y + YUV_CVR * v) >> YUV_SHIFT);
+}
+
+// Source coordinate of output sample i, in source samples from `begin`,
+// for `count` source samples mapped onto `outputs` outputs (pixel centres aligned)
+inline double source_position(int i, int count, int outputs) {
+    return (i + 0.5) * count / outputs - 0.5;
+}
+
+// Bilinear tap between samples [lo, hi], as stride-scaled offsets
+void make_tap(double position, int lo, int hi, int stride, int offset, int& index0, int& index1, int& weight) {
+    position = std::min(std::max(position, static_cast<double>(lo)), static_cast<double>(hi));
+    int i0 = static_cast<int>(std::floor(position));
+    int i1 = std::min(i0 + 1, hi);
+    weight = static_cast<int>(std::lround((position - i0) * 256));
+    if (weight == 256) {
+        i0 = i1;
+        weight = 0;
+    }
+    index0 = i0 * stride + offset;
+    index1 = i1 * stride + offset;
+}
+
+// out[i] = a[i] * (256 - w) + b[i] * w for bytes [begin, end)
+void blend_rows(const uint8_t* a, const uint8_t* b, int w, int begin, int end, uint16_t* out) {
+    int i = begin;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(static_cast<int16_t>(256 - w));
+    const __m128i wb = _mm_set1_epi16(static_cast<int16_t>(w));
+    for (; i + 16 <= end; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), hi);
+    }
+#endif
+    for (; i < end; i++) {
+        out[i] = static_cast<uint16_t>(a[i] * (256 - w) + b[i] * w);
+    }
+}
+
+// out[i] = row[i] * w for the first row of a box, out[i] += row[i] * w after
+void accumulate_row(const uint8_t* row, int w, bool first, int begin, int end, uint16_t* out) {
+    int i = begin;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vw = _mm_set1_epi16(static_cast<int16_t>(w));
+    for (; i + 16 <= end; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), vw);
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), vw);
+        if (!first) {
+            lo = _mm_add_epi16(lo, _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i)));
+            hi = _mm_add_epi16(hi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(out + i + 8)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), hi);
+    }
+#endif
+    for (; i < end; i++) {
+        out[i] = static_cast<uint16_t>((first ? 0 : out[i]) + row[i] * w);
+    }
+}
+
+}  // namespace
+
+// Samples overlapping [begin, end), weighted by overlap. Weights are taken
+// as differences of the rounded running total so they sum to exactly 256.
+YuyvResizer::Box YuyvResizer::make_box_(double begin, double end, int lo, int hi, int stride, int offset) {
+    Box box{static_cast<int>(box_indices_.size()), 0};
+    const double width = end - begin;
+    long covered = 0;
+    for (int i = static_cast<int>(std::floor(begin)); i < end; i++) {
+        const double covered_end = (std::min(end, i + 1.0) - begin) / width;
+        const long total = std::lround(covered_end * 256);
+        if (total == covered) {
+            continue;
+        }
+        box_indices_.push_back(std::min(std::max(i, lo), hi) * stride + offset);
+        box_weights_.push_back(static_cast<int>(total - covered));
+        covered = total;
+        box.count++;
+    }
+    return box;
+}
+
+bool YuyvResizer::configure(int source_width, int source_height, int output_width, int output_height, ResizeMode mode) {
+    if (source_width <= 0 || source_height <= 0 || output_width <= 0 || output_height <= 0 || source_width % 2 != 0) {
+        return false;
+    }
+    source_width_ = source_width;
+    source_height_ = source_height;
+    output_width_ = output_width;
+    output_height_ = output_height;
+
+    // Source region [x0, x0 + w) x [y0, y0 + h)
+    int region_x = 0;
+    int region_y = 0;
+    int region_w = source_width;
+    int region_h = source_height;
+    if (mode == ResizeMode::CENTER_CROP) {
+        if (static_cast<int64_t>(source_width) * output_height > static_cast<int64_t>(source_height) * output_width) {
+            region_w = static_cast<int>(static_cast<int64_t>(source_height) * output_width / output_height);
+            region_x = (source_width - region_w) / 2;
+        } else {
+            region_h = static_cast<int>(static_cast<int64_t>(source_width) * output_height / output_width);
+            region_y = (source_height - region_h) / 2;
+        }
+    }
+
+    box_indices_.clear();
+    box_weights_.clear();
+    box_rows_ = region_h > BILINEAR_MAX_RATIO * output_height;
+    box_cols_ = region_w > BILINEAR_MAX_RATIO * output_width;
+
+    rows_.resize(output_height);
+    row_boxes_.resize(box_rows_ ? output_height : 0);
+    for (int y = 0; y < output_height; y++) {
+        Tap& tap = rows_[y];
+        make_tap(region_y + source_position(y, region_h, output_height),
+                 region_y, region_y + region_h - 1, 1, 0, tap.index0, tap.index1, tap.weight);
+        if (box_rows_) {
+            row_boxes_[y] = make_box_(region_y + static_cast<double>(y) * region_h / output_height,
+                                      region_y + static_cast<double>(y + 1) * region_h / output_height,
+                                      region_y, region_y + region_h - 1, 1, 0);
+        }
+    }
+
+    // Y of pixel x is byte 2x; U of pixel pair k is byte 4k + 1, V is 4k + 3.
+    // Chroma sample k sits between pixels 2k and 2k + 1.
+    const int pair_lo = region_x / 2;
+    const int pair_hi = (region_x + region_w - 1) / 2;
+    luma_cols_.resize(output_width);
+    chroma_cols_.resize(output_width);
+    luma_boxes_.resize(box_cols_ ? output_width : 0);
+    chroma_boxes_.resize(box_cols_ ? output_width : 0);
+    for (int x = 0; x < output_width; x++) {
+        const double position = region_x + source_position(x, region_w, output_width);
+        Tap& luma = luma_cols_[x];
+        make_tap(position, region_x, region_x + region_w - 1, 2, 0, luma.index0, luma.index1, luma.weight);
+        Tap& chroma = chroma_cols_[x];
+        make_tap((position - 0.5) / 2, pair_lo, pair_hi, 4, 1, chroma.index0, chroma.index1, chroma.weight);
+        if (box_cols_) {
+            // Chroma sample k covers pixels 2k and 2k + 1
+            const double begin = region_x + static_cast<double>(x) * region_w / output_width;
+            const double end = region_x + static_cast<double>(x + 1) * region_w / output_width;
+            luma_boxes_[x] = make_box_(begin, end, region_x, region_x + region_w - 1, 2, 0);
+            chroma_boxes_[x] = make_box_(begin / 2, end / 2, pair_lo, pair_hi, 4, 1);
+        }
+    }
+    span_begin_ = pair_lo * 4;
+    span_end_ = (pair_hi + 1) * 4;
+    blended_.assign(static_cast<size_t>(source_width) * 2, 0);
+    return true;
+}
+
+void YuyvResizer::resize_to_bgr(const uint8_t* yuyv, uint8_t* bgr) {
+    const size_t stride = static_cast<size_t>(source_width_) * 2;
+    const uint16_t* blended = blended_.data();
+    const Tap* luma_cols = luma_cols_.data();
+    const Tap* chroma_cols = chroma_cols_.data();
+    const int* box_indices = box_indices_.data();
+    const int* box_weights = box_weights_.data();
+    const int output_width = output_width_;
+    for (int y = 0; y < output_height_; y++) {
+        if (box_rows_) {
+            const Box box = row_boxes_[y];
+            for (int k = 0; k < box.count; k++) {
+                accumulate_row(yuyv + box_indices[box.begin + k] * stride, box_weights[box.begin + k], k == 0,
+                               span_begin_, span_end_, blended_.data());
+            }
+        } else {
+            const Tap row = rows_[y];
+            blend_rows(yuyv + row.index0 * stride, yuyv + row.index1 * stride, row.weight, span_begin_, span_end_, blended_.data());
+        }
+
+        uint8_t* out = bgr + static_cast<size_t>(y) * output_width * 3;
+        if (box_cols_) {
+            for (int x = 0; x < output_width; x++) {
+                const Box l = luma_boxes_[x];
+                const Box c = chroma_boxes_[x];
+                int luma = 32768, u = 32768, v = 32768;
+                for (int k = l.begin; k < l.begin + l.count; k++) {
+                    luma += blended[box_indices[k]] * box_weights[k];
+                }
+                for (int k = c.begin; k < c.begin + c.count; k++) {
+                    u += blended[box_indices[k]] * box_weights[k];
+                    v += blended[box_indices[k] + 2] * box_weights[k];
+                }
+                store_bgr(out + 3 * x, luma >> 16, (u >> 16) - 128, (v >> 16) - 128);
+            }
+            continue;
+        }
+        for (int x = 0; x < output_width; x++) {
+            // Copies: stores through `out` may alias anything as far as the compiler knows
+            const Tap l = luma_cols[x];
+            const Tap c = chroma_cols[x];
+            // 8.8 from the vertical blend times 8-bit horizontal weight: 16 fractional bits
+            const int luma = (blended[l.index0] * (256 - l.weight) + blended[l.index1] * l.weight + 32768) >> 16;
+            const int u = ((blended[c.index0] * (256 - c.weight) + blended[c.index1] * c.weight + 32768) >> 16) - 128;
+            const int v = ((blended[c.index0 + 2] * (256 - c.weight) + blended[c.index1 + 2] * c.weight + 32768) >> 16) - 128;
+            store_bgr(out + 3 * x, luma, u, v);
+        }
+    }
+}
+
+bool parse_resize_spec(const std::string& spec, int& width, int& height, ResizeMode& mode) {
+    std::string size = spec;
+    mode = ResizeMode::STRETCH;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+        const std::string mode_name = spec.substr(colon + 1);
+        if (mode_name == resize_mode_name(ResizeMode::CENTER_CROP)) {
+            mode = ResizeMode::CENTER_CROP;
+        } else if (mode_name != resize_mode_name(ResizeMode::STRETCH)) {
+            return false;
+        }
+        size = spec.substr(0, colon);
+    }
+    size_t x = size.find('x');
+    if (x == std::string::npos) {
+        return false;
+    }
+    try {
+        width = std::stoi(size.substr(0, x));
+        height = std::stoi(size.substr(x + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return width > 0 && height > 0;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class ResizeMode {
+    STRETCH,        // whole frame scaled to the output size
+    CENTER_CROP     // largest centred region with the output's aspect ratio, then scaled
+};
+
+inline const char* resize_mode_name(ResizeMode mode) {
+    return mode == ResizeMode::CENTER_CROP ? "crop" : "stretch";
+}
+
+/*
+    YUYV -> BGR at a different size, fused: every output row is built from a
+    vertical blend of source rows (SSE2 when available) followed by the
+    horizontal sample and colour conversion, so no full-resolution BGR frame
+    is ever produced. BT.601 limited range, same coefficients as
+    cv::COLOR_YUV2BGR_YUY2. Along an axis shrunk by up to 2x, luma and chroma
+    are bilinear (two taps); beyond 2x, where bilinear would skip source
+    samples and alias, each output averages the whole source area it covers
+    (box filter, like cv::INTER_AREA).
+
+    Tables are built once in configure(); resize_to_bgr() doesn't allocate.
+    One resizer per thread (it keeps a row of scratch).
+*/
+class YuyvResizer {
+    public:
+        // `source_width` must be even. Returns false for sizes it can't do.
+        bool configure(int source_width, int source_height, int output_width, int output_height, ResizeMode mode);
+
+        // `bgr` holds output_width * output_height * 3 bytes
+        void resize_to_bgr(const uint8_t* yuyv, uint8_t* bgr);
+
+        int output_width() const { return output_width_; }
+        int output_height() const { return output_height_; }
+        int source_width() const { return source_width_; }
+        int source_height() const { return source_height_; }
+
+    private:
+        struct Tap {
+            int index0;     // source sample
+            int index1;     // next sample, clamped to the region
+            int weight;     // of index1, 0-256
+        };
+
+        // Box filter footprint: box_indices_/box_weights_[begin, begin + count),
+        // weights summing to 256
+        struct Box {
+            int begin;
+            int count;
+        };
+
+        Box make_box_(double begin, double end, int lo, int hi, int stride, int offset);
+
+        int source_width_ = 0;
+        int source_height_ = 0;
+        int output_width_ = 0;
+        int output_height_ = 0;
+        std::vector<Tap> rows_;         // per output row: source rows
+        std::vector<Tap> luma_cols_;    // per output column: byte offsets of Y
+        std::vector<Tap> chroma_cols_;  // per output column: byte offsets of U (V is +2)
+        // Used instead of the taps above on an axis shrunk by more than 2x
+        bool box_rows_ = false;
+        bool box_cols_ = false;
+        std::vector<Box> row_boxes_;
+        std::vector<Box> luma_boxes_;
+        std::vector<Box> chroma_boxes_;
+        std::vector<int> box_indices_;
+        std::vector<int> box_weights_;
+        int span_begin_ = 0;            // bytes of each source row the columns touch
+        int span_end_ = 0;
+        std::vector<uint16_t> blended_; // one vertically blended source row, 8.8 fixed point
+};
+
+// "224x224", "224x224:crop" -> sizes and mode. False if malformed.
+bool parse_resize_spec(const std::string& spec, int& width, int& height, ResizeMode& mode);
@@ -0,0 +1,117 @@
+#include "frame_shm_tap.hpp"
+
+#include "alloc_stats.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+uint32_t camera_format_fourcc(CameraFormat format) {
+    switch (format) {
+        case CameraFormat::YUYV: return FRAME_FOURCC_YUYV;
+        case CameraFormat::RGB: return FRAME_FOURCC_RGB;
+        case CameraFormat::GRAY: return FRAME_FOURCC_GRAY;
+    }
+    return 0;
+}
+
+} // namespace
+
+FrameShmTap::FrameShmTap() {}
+
+FrameShmTap::~FrameShmTap() {
+    stop();
+}
+
+bool FrameShmTap::initialize(
+    const std::vector<std::string>& device_names,
+    const std::vector<BroadcastRing<CameraFrame>*>& rings,
+    const std::vector<uint64_t>& frame_bytes,
+    const std::string& shm_prefix,
+    int slots
+) {
+    if (device_names.size() != rings.size() || device_names.size() != frame_bytes.size()) {
+        std::cerr << "FrameShmTap: need one ring and frame size per device" << std::endl;
+        return false;
+    }
+    if (shm_prefix.empty() || shm_prefix[0] != '/') {
+        std::cerr << "FrameShmTap: shm prefix must start with '/'" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < device_names.size(); i++) {
+        auto camera = std::make_unique<CameraTap>();
+        camera->device_name = device_names[i];
+        camera->shm_name = shm_prefix + "_" + device_names[i].substr(device_names[i].find_last_of('/') + 1);
+        if (!camera->writer.create(camera->shm_name, slots, frame_bytes[i])) {
+            return false;
+        }
+        camera->ring = rings[i];
+        camera->consumer = rings[i]->add_consumer(ConsumerPolicy::LOSSY);
+        std::cout << "FrameShmTap: " << camera->device_name << " -> " << camera->shm_name
+                  << " (" << slots << " slots, " << camera->writer.mapped_bytes() / (1024.0 * 1024.0)
+                  << " MB)" << std::endl;
+        cameras_.push_back(std::move(camera));
+    }
+    return true;
+}
+
+bool FrameShmTap::start() {
+    running_.store(true);
+    tap_thread_ = std::make_unique<std::thread>(&FrameShmTap::tap_thread_func_, this);
+    return true;
+}
+
+void FrameShmTap::stop() {
+    running_.store(false);
+    if (tap_thread_ && tap_thread_->joinable()) {
+        tap_thread_->join();
+    }
+    tap_thread_.reset();
+    // Tells readers to let go; a restarted recorder creates fresh objects
+    for (auto& camera : cameras_) {
+        camera->writer.close();
+    }
+}
+
+void FrameShmTap::tap_thread_func_() {
+    ROBODAQ_ALLOC_THREAD_NAME("frame_shm_tap");
+    while (running_.load()) {
+        bool did_work = false;
+        for (auto& camera : cameras_) {
+            while (const CameraFrame* frame = camera->ring->peek(camera->consumer)) {
+                did_work = true;
+                SharedFrameInfo info;
+                info.frame_sequence = frame->sequence_number;
+                info.timestamp_us = frame->timestamp_us;
+                info.width = frame->width;
+                info.height = frame->height;
+                info.fourcc = camera_format_fourcc(frame->format);
+                info.size_bytes = static_cast<uint32_t>(frame->image_data.size());
+                if (camera->writer.publish(info, frame->image_data.data())) {
+                    camera->frames_published++;
+                    ROBODAQ_COUNT_COPY(info.size_bytes);
+                } else {
+                    camera->frames_oversized++;
+                }
+                camera->ring->release(camera->consumer);
+            }
+        }
+        if (!did_work) {
+            // Frames arrive every ~33 ms; this bounds the added latency
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void FrameShmTap::report() const {
+    std::cout << "\nShared-memory frames:" << std::endl;
+    for (const auto& camera : cameras_) {
+        std::cout << "  " << camera->shm_name << ": " << camera->frames_published << " published, "
+                  << camera->ring->dropped(camera->consumer) << " skipped";
+        if (camera->frames_oversized) {
+            std::cout << ", " << camera->frames_oversized << " larger than a slot";
+        }
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "broadcast_ring.hpp"
+#include "camera_capture_pipeline.hpp"
+#include "shared_frame_ring.hpp"
+
+/*
+    Publishes every camera frame into a SharedFrameRing so other local
+    processes can read live frames zero-copy (see shared_frame_ring.hpp for
+    the protocol and the reader class).
+
+    The tap thread is a lossy consumer of each camera's BroadcastRing and does
+    the one copy into shared memory, so capture never pays for it. Neither a
+    slow tap nor a slow external reader can stall capture or the writers.
+
+    One shm object per camera: <prefix>_<device basename>, e.g.
+    /robodaq_frames_cam_front.
+*/
+class FrameShmTap {
+private:
+    struct CameraTap {
+        std::string device_name;
+        std::string shm_name;
+        BroadcastRing<CameraFrame>* ring = nullptr;
+        int consumer = -1;
+        SharedFrameWriter writer;
+        uint64_t frames_published = 0;
+        uint64_t frames_oversized = 0;
+    };
+
+    std::vector<std::unique_ptr<CameraTap>> cameras_;
+    std::unique_ptr<std::thread> tap_thread_;
+    std::atomic<bool> running_{false};
+
+    void tap_thread_func_();
+
+public:
+    FrameShmTap();
+    ~FrameShmTap();
+
+    // rings[i] carries device_names[i] with frames of at most frame_bytes[i];
+    // must be called before frames are published
+    bool initialize(
+        const std::vector<std::string>& device_names,
+        const std::vector<BroadcastRing<CameraFrame>*>& rings,
+        const std::vector<uint64_t>& frame_bytes,
+        const std::string& shm_prefix = FRAME_SHM_DEFAULT_PREFIX,
+        int slots = FRAME_SHM_DEFAULT_SLOTS
+    );
+
+    bool start();
+    void stop();
+    void report() const;
+};
@@ -0,0 +1,73 @@
+#include "joint_state.hpp"
+
+#include <algorithm>
+
+void JointStateAligner::add(const JointState& sample) {
+    // Samples arrive in order from a single reader; drop anything that doesn't.
+    if (!history_.empty() && sample.timestamp_us < history_.back().timestamp_us) {
+        return;
+    }
+    history_.push_back(sample);
+
+    while (!history_.empty() && 
+           sample.timestamp_us - history_.front().timestamp_us > history_us_) {
+        history_.pop_front();
+    }
+}
+
+bool JointStateAligner::sample_at(uint64_t timestamp_us, JointState& out) const {
+    if (history_.empty()) {
+        return false;
+    }
+
+    // First sample at or after the requested time
+    auto after = std::lower_bound(
+        history_.begin(), history_.end(), timestamp_us,
+        [](const JointState& s, uint64_t t) { return s.timestamp_us < t; }
+    );
+
+    // Requested time is newer than anything we have: hold the latest sample
+    if (after == history_.end()) {
+        const JointState& newest = history_.back();
+        if (timestamp_us - newest.timestamp_us > max_gap_us_) {
+            return false;
+        }
+        out = newest;
+        return true;
+    }
+
+    // Requested time is older than the window (or an exact hit)
+    if (after == history_.begin() || after->timestamp_us == timestamp_us) {
+        if (after->timestamp_us - timestamp_us > max_gap_us_) {
+            return false;
+        }
+        out = *after;
+        return true;
+    }
+
+    const JointState& a = *(after - 1);
+    const JointState& b = *after;
+
+    // Gap in the stream around this frame: fall back to the nearest side
+    if (b.timestamp_us - a.timestamp_us > 2 * max_gap_us_) {
+        const JointState& nearest = 
+            (timestamp_us - a.timestamp_us <= b.timestamp_us - timestamp_us) ? a : b;
+        uint64_t gap = (&nearest == &a) ? timestamp_us - a.timestamp_us : b.timestamp_us - timestamp_us;
+        if (gap > max_gap_us_) {
+            return false;
+        }
+        out = nearest;
+        return true;
+    }
+
+    const float alpha = static_cast<float>(timestamp_us - a.timestamp_us) / 
+                        static_cast<float>(b.timestamp_us - a.timestamp_us);
+    out.timestamp_us = timestamp_us;
+    out.sequence_number = (alpha < 0.5f) ? a.sequence_number : b.sequence_number;
+    for (int j = 0; j < NUM_JOINTS; j++) {
+        out.position[j] = a.position[j] + alpha * (b.position[j] - a.position[j]);
+        // Commands are step-wise: use whatever was last sent
+        out.command[j] = a.command[j];
+    }
+    return true;
+}
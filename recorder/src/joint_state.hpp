@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+
+// SO-101 has 5 arm joints + gripper.
+constexpr int NUM_JOINTS = 6;
+
+// Samples further than this from a frame timestamp are not attached to it
+// (in microseconds). Covers a 100 Hz stream with one dropped sample.
+constexpr uint64_t JOINT_STATE_MAX_GAP_US = 20'000;
+
+// How much joint history the aligner keeps around for interpolation.
+constexpr uint64_t JOINT_STATE_HISTORY_US = 1'000'000;
+
+// One joint-state sample. Fixed-size POD so it can go through the
+// SPSC ring and be written to disk as-is (64 bytes per record).
+struct JointState {
+    uint64_t timestamp_us;      // host steady_clock time at receipt, same clock as CameraFrame
+    uint64_t sequence_number;
+    float position[NUM_JOINTS];
+    float command[NUM_JOINTS];
+
+    JointState() : timestamp_us(0), sequence_number(0), position{}, command{} {}
+};
+
+static_assert(sizeof(JointState) == 64, "JointState is written to disk as a fixed 64-byte record");
+
+/*
+    Keeps a short window of joint samples and answers "what was the arm doing
+    at time t" for a synced frame bundle. Linear interpolation between the two
+    samples bracketing t, nearest sample when t is outside the window.
+    Not thread-safe: owned by the sync thread.
+*/
+class JointStateAligner {
+private:
+    std::deque<JointState> history_;
+    uint64_t max_gap_us_;
+    uint64_t history_us_;
+
+public:
+    JointStateAligner(
+        uint64_t max_gap_us = JOINT_STATE_MAX_GAP_US,
+        uint64_t history_us = JOINT_STATE_HISTORY_US
+    ) : max_gap_us_(max_gap_us), history_us_(history_us) {}
+
+    void add(const JointState& sample);
+
+    // Fills `out` with the joint state at `timestamp_us`.
+    // Returns false if there is no sample within max_gap_us of it.
+    bool sample_at(uint64_t timestamp_us, JointState& out) const;
+
+    size_t size() const { return history_.size(); }
+};
@@ -0,0 +1,175 @@
+#include "joint_state_reader.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+speed_t baud_to_speed(int baud_rate) {
+    switch (baud_rate) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 500000: return B500000;
+        case 921600: return B921600;
+        case 1000000: return B1000000;
+        default: return B0;
+    }
+}
+
+} // namespace
+
+JointStateReader::JointStateReader()
+    : fd_(-1), buffer_(nullptr), sequence_counter_(0),
+      parse_error_count_(0), drop_count_(0) {}
+
+JointStateReader::~JointStateReader() {
+    stop();
+}
+
+bool JointStateReader::initialize(const std::string& device, int baud_rate, SPSCRingBuffer<JointState>* buffer) {
+    device_name_ = device;
+    buffer_ = buffer;
+
+    speed_t speed = baud_to_speed(baud_rate);
+    if (speed == B0) {
+        std::cerr << "Unsupported baud rate for " << device << ": " << baud_rate << std::endl;
+        return false;
+    }
+
+    fd_ = open(device.c_str(), O_RDONLY | O_NOCTTY);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open joint state device " << device << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Raw mode, and a 100ms read timeout so the reader thread can notice stop()
+    termios tio;
+    if (tcgetattr(fd_, &tio) != 0) {
+        std::cerr << "Failed to get serial attributes for " << device << std::endl;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, speed);
+    cfsetospeed(&tio, speed);
+    tio.c_cflag |= (CLOCAL | CREAD);
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 1;
+    if (tcsetattr(fd_, TCSANOW, &tio) != 0) {
+        std::cerr << "Failed to set serial attributes for " << device << std::endl;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    tcflush(fd_, TCIFLUSH);
+
+    std::cout << "JointStateReader initialized: " << device << " @ " << baud_rate << " baud" << std::endl;
+    return true;
+}
+
+bool JointStateReader::start() {
+    if (fd_ < 0 || !buffer_) {
+        std::cerr << "JointStateReader not initialized" << std::endl;
+        return false;
+    }
+    running_.store(true);
+    read_thread_ = std::make_unique<std::thread>(&JointStateReader::read_thread_func_, this);
+    return true;
+}
+
+void JointStateReader::stop() {
+    running_.store(false);
+    if (read_thread_ && read_thread_->joinable()) {
+        read_thread_->join();
+    }
+    read_thread_.reset();
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool JointStateReader::parse_line_(const char* line, JointState& sample) const {
+    if (line[0] != 'J' || line[1] != ' ') {
+        return false;
+    }
+    const char* p = line + 2;
+    char* end = nullptr;
+    for (int i = 0; i < 2 * NUM_JOINTS; i++) {
+        float value = std::strtof(p, &end);
+        if (end == p) {
+            return false;
+        }
+        if (i < NUM_JOINTS) {
+            sample.position[i] = value;
+        } else {
+            sample.command[i - NUM_JOINTS] = value;
+        }
+        p = end;
+    }
+    return true;
+}
+
+void JointStateReader::read_thread_func_() {
+    char read_buf[512];
+    char line[256];
+    size_t line_len = 0;
+
+    while (running_.load()) {
+        ssize_t n = read(fd_, read_buf, sizeof(read_buf));
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            std::cerr << "[" << device_name_ << "] Joint state read failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        // Timestamp on receipt; all samples in this read share it within a few us
+        uint64_t timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        for (ssize_t i = 0; i < n; i++) {
+            char c = read_buf[i];
+            if (c != '\n') {
+                // Overlong lines are garbage; drop them whole
+                if (line_len < sizeof(line) - 1) {
+                    line[line_len++] = c;
+                } else {
+                    line_len = sizeof(line);
+                }
+                continue;
+            }
+            if (line_len >= sizeof(line)) {
+                parse_error_count_++;
+                line_len = 0;
+                continue;
+            }
+            line[line_len] = '\0';
+            line_len = 0;
+
+            JointState sample;
+            if (!parse_line_(line, sample)) {
+                parse_error_count_++;
+                continue;
+            }
+            sample.timestamp_us = timestamp_us;
+            sample.sequence_number = ++sequence_counter_;
+
+            if (!buffer_->push(sample)) {
+                drop_count_++;
+                std::cerr << "[" << device_name_ << "] Joint state ring buffer full, dropping sample" << std::endl;
+            }
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <memory>
+#include <iostream>
+#include <cstdint>
+
+#include "joint_state.hpp"
+#include "spsc_ring_buffer.hpp"
+
+/*
+    Reads joint state from the arm controller over a serial port (or a pty
+    for the fake arm in tools/fake_arm.py) and pushes timestamped samples
+    into an SPSC ring. The reader thread is the only producer.
+
+    Line protocol, one sample per line at 100-500 Hz:
+        J <pos0> ... <pos5> <cmd0> ... <cmd5>\n
+    Positions/commands are joint angles in degrees (gripper in percent).
+*/
+class JointStateReader {
+private:
+    int fd_;
+    std::string device_name_;
+    SPSCRingBuffer<JointState>* buffer_;
+    std::unique_ptr<std::thread> read_thread_;
+    std::atomic<bool> running_{false};
+    uint64_t sequence_counter_;
+    uint64_t parse_error_count_;
+    uint64_t drop_count_;
+
+    void read_thread_func_();
+    bool parse_line_(const char* line, JointState& sample) const;
+
+public:
+    JointStateReader();
+    ~JointStateReader();
+
+    bool initialize(const std::string& device, int baud_rate, SPSCRingBuffer<JointState>* buffer);
+    bool start();
+    void stop();
+
+    uint64_t samples_read() const { return sequence_counter_; }
+    uint64_t parse_errors() const { return parse_error_count_; }
+    uint64_t drops() const { return drop_count_; }
+};
@@ -0,0 +1,48 @@
+#include "joint_state_writer.hpp"
+
+#include <cstring>
+
+JointStateWriter::JointStateWriter() : records_written_(0) {}
+
+bool JointStateWriter::initialize(const std::string& path) {
+    output_path_ = path;
+    file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open joint state file: " << path << std::endl;
+        return false;
+    }
+
+    JointStateFileHeader header;
+    std::memcpy(header.magic, JOINT_STATE_FILE_MAGIC, sizeof(header.magic));
+    header.version = JOINT_STATE_FILE_VERSION;
+    header.num_joints = NUM_JOINTS;
+    header.record_size = sizeof(JointState);
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::cout << "JointStateWriter initialized: " << path << std::endl;
+    return true;
+}
+
+bool JointStateWriter::write(const JointState& sample) {
+    if (!file_.is_open()) {
+        std::cerr << "JointStateWriter not initialized" << std::endl;
+        return false;
+    }
+    // Buffered by ofstream; flushed on finalize
+    file_.write(reinterpret_cast<const char*>(&sample), sizeof(sample));
+    records_written_++;
+    return file_.good();
+}
+
+void JointStateWriter::finalize() {
+    if (file_.is_open()) {
+        file_.close();
+        std::cout << "JointStateWriter finalized: " << output_path_ 
+                  << " (" << records_written_ << " samples)" << std::endl;
+    }
+}
+
+JointStateWriter::~JointStateWriter() {
+    finalize();
+}
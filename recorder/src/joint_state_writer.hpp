@@ -0,0 +1,38 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+#include "joint_state.hpp"
+
+// joint_state.bin layout: JointStateFileHeader followed by back-to-back
+// JointState records (little-endian, 64 bytes each).
+constexpr char JOINT_STATE_FILE_MAGIC[4] = {'R', 'D', 'J', 'S'};
+constexpr uint32_t JOINT_STATE_FILE_VERSION = 1;
+
+struct JointStateFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t num_joints;
+    uint32_t record_size;
+};
+
+class JointStateWriter {
+private:
+    std::ofstream file_;
+    std::string output_path_;
+    uint64_t records_written_;
+
+public:
+    JointStateWriter();
+
+    bool initialize(const std::string& path);
+    bool write(const JointState& sample);
+    void finalize();
+
+    uint64_t records_written() const { return records_written_; }
+
+    ~JointStateWriter();
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+/*
+    Minimal field lookup for the flat JSON lines the recorder writes
+    (sync_log.jsonl, events.jsonl). Not a JSON parser: it finds the first
+    "key": at any depth and reads the scalar after it, which is enough for
+    our own single-level records and avoids a dependency.
+*/
+
+inline const char* jsonl_find_value(const std::string& line, const char* key) {
+    std::string pattern = std::string("\"") + key + "\"";
+    size_t pos = line.find(pattern);
+    if (pos == std::string::npos) {
+        return nullptr;
+    }
+    pos += pattern.size();
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == ':')) {
+        pos++;
+    }
+    return pos < line.size() ? line.c_str() + pos : nullptr;
+}
+
+inline bool jsonl_get_uint(const std::string& line, const char* key, uint64_t& out) {
+    const char* value = jsonl_find_value(line, key);
+    if (!value) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (end == value) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+inline bool jsonl_get_int(const std::string& line, const char* key, int64_t& out) {
+    const char* value = jsonl_find_value(line, key);
+    if (!value) {
+        return false;
+    }
+    char* end = nullptr;
+    long long parsed = std::strtoll(value, &end, 10);
+    if (end == value) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+inline bool jsonl_get_double(const std::string& line, const char* key, double& out) {
+    const char* value = jsonl_find_value(line, key);
+    if (!value) {
+        return false;
+    }
+    char* end = nullptr;
+    double parsed = std::strtod(value, &end);
+    if (end == value) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+inline bool jsonl_get_string(const std::string& line, const char* key, std::string& out) {
+    const char* value = jsonl_find_value(line, key);
+    if (!value || *value != '"') {
+        return false;
+    }
+    const char* end = std::strchr(value + 1, '"');
+    if (!end) {
+        return false;
+    }
+    out.assign(value + 1, end);
+    return true;
+}
+
+// sync_log.jsonl has two kinds of rows: one per written bundle, keyed by
+// "timestamp" and in step with the video frames, and, with the motion gate,
+// "type":"skipped_run" rows summing up bundles that were not written.
+// Anything mapping rows to video frames must skip the latter.
+constexpr const char* SYNC_LOG_SKIPPED_RUN_TYPE = "skipped_run";
+
+inline bool sync_log_is_skipped_run(const std::string& line) {
+    std::string type;
+    return jsonl_get_string(line, "type", type) && type == SYNC_LOG_SKIPPED_RUN_TYPE;
+}
+
+// Reads up to `max_count` numbers from a "key":[a,b,...] array.
+// Returns the number of values read (0 if the key is missing).
+inline int jsonl_get_float_array(const std::string& line, const char* key, float* out, int max_count) {
+    const char* value = jsonl_find_value(line, key);
+    if (!value || *value != '[') {
+        return 0;
+    }
+    const char* p = value + 1;
+    int count = 0;
+    while (count < max_count && *p && *p != ']') {
+        char* end = nullptr;
+        float parsed = std::strtof(p, &end);
+        if (end == p) {
+            break;
+        }
+        out[count++] = parsed;
+        p = end;
+        while (*p == ',' || *p == ' ') {
+            p++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,238 @@
+/*
+Goal: Hand the newest value of something (a pose, a teleop command, recorder
+status) from one writer to any number of readers, where only the latest value
+matters and a queue would just add blocking and stale data.
+
+Seqlock over a fixed-size, trivially copyable T:
+- Writer: wait-free. Bumps the sequence to odd, stores the payload, bumps it to even.
+- Readers: never block the writer. try_read() is a single wait-free attempt
+  that fails if it raced a write; read() retries until it gets a consistent copy.
+- The payload is stored as relaxed 64-bit atomics, so a torn read is detected
+  by the sequence check rather than being a data race.
+
+Storage is either private to the process or a named POSIX shared memory
+object (create_shared / open_shared), so a teleop loop in another process
+can read what the recorder publishes and vice versa.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t MAILBOX_MAGIC = 0x424D4452;  // "RDMB"
+constexpr uint32_t MAILBOX_VERSION = 1;
+
+template<typename T>
+class LatestValueMailbox {
+    static_assert(std::is_trivially_copyable<T>::value, "Mailbox values are copied byte-wise");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory mailbox needs lock-free 64-bit atomics");
+
+    public:
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        // Private, in-process storage
+        LatestValueMailbox();
+        ~LatestValueMailbox();
+
+        LatestValueMailbox(const LatestValueMailbox&) = delete;
+        LatestValueMailbox& operator=(const LatestValueMailbox&) = delete;
+
+        // Writer side: creates (or takes over) the named shm object, e.g. "/robodaq_status".
+        // The object is unlinked when this mailbox is destroyed.
+        bool create_shared(const std::string& name);
+
+        // Reader side: maps an existing shm object read-only. Fails if the
+        // writer hasn't created it yet or it holds a different type.
+        bool open_shared(const std::string& name);
+
+        // Single writer only
+        void publish(const T& value);
+
+        // One attempt; false if nothing was published yet or a write was in progress
+        bool try_read(T& value) const;
+
+        // Retries until a consistent copy is read; false only if nothing was published yet.
+        // Spins if the writer died mid-publish; use try_read where that matters.
+        bool read(T& value) const;
+
+        // Number of publishes so far; cheap way for a reader to see if anything changed
+        uint64_t version() const;
+
+    private:
+        struct Storage {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t value_size;
+            uint32_t reserved;
+            alignas(64) std::atomic<uint64_t> sequence;
+            alignas(64) std::atomic<uint64_t> words[WORDS];
+        };
+
+        void release_();
+
+        std::unique_ptr<Storage> local_storage_;
+        Storage* storage_;
+        std::string shm_name_;
+        bool owns_shm_;
+};
+
+template<typename T>
+LatestValueMailbox<T>::LatestValueMailbox()
+    : local_storage_(std::make_unique<Storage>()), storage_(local_storage_.get()), owns_shm_(false) {
+    storage_->magic = MAILBOX_MAGIC;
+    storage_->version = MAILBOX_VERSION;
+    storage_->value_size = sizeof(T);
+    storage_->reserved = 0;
+    storage_->sequence.store(0, std::memory_order_relaxed);
+    for (auto& word : storage_->words) {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+LatestValueMailbox<T>::~LatestValueMailbox() {
+    release_();
+}
+
+template<typename T>
+void LatestValueMailbox<T>::release_() {
+    if (storage_ && storage_ != local_storage_.get()) {
+        munmap(storage_, sizeof(Storage));
+        if (owns_shm_) {
+            shm_unlink(shm_name_.c_str());
+        }
+    }
+    storage_ = local_storage_.get();
+    owns_shm_ = false;
+}
+
+template<typename T>
+bool LatestValueMailbox<T>::create_shared(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Mailbox: cannot create shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, sizeof(Storage)) != 0) {
+        std::cerr << "Mailbox: cannot size shm " << name << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, sizeof(Storage), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Mailbox: cannot map shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    release_();
+    storage_ = static_cast<Storage*>(mapping);
+    shm_name_ = name;
+    owns_shm_ = true;
+
+    // Readers validate magic, so clear it while the header is rewritten
+    storage_->magic = 0;
+    storage_->version = MAILBOX_VERSION;
+    storage_->value_size = sizeof(T);
+    storage_->reserved = 0;
+    storage_->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    storage_->magic = MAILBOX_MAGIC;
+    return true;
+}
+
+template<typename T>
+bool LatestValueMailbox<T>::open_shared(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Mailbox: cannot open shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Storage)) {
+        std::cerr << "Mailbox: shm " << name << " is too small for this value type" << std::endl;
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, sizeof(Storage), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Mailbox: cannot map shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    Storage* shared = static_cast<Storage*>(mapping);
+    if (shared->magic != MAILBOX_MAGIC || shared->version != MAILBOX_VERSION || shared->value_size != sizeof(T)) {
+        std::cerr << "Mailbox: shm " << name << " has a different layout (value size "
+                  << shared->value_size << ", expected " << sizeof(T) << ")" << std::endl;
+        munmap(mapping, sizeof(Storage));
+        return false;
+    }
+
+    release_();
+    storage_ = shared;
+    shm_name_ = name;
+    return true;
+}
+
+template<typename T>
+void LatestValueMailbox<T>::publish(const T& value) {
+    uint64_t words[WORDS] = {};
+    std::memcpy(words, &value, sizeof(T));
+
+    const uint64_t sequence = storage_->sequence.load(std::memory_order_relaxed);
+    storage_->sequence.store(sequence + 1, std::memory_order_relaxed);
+    // Odd sequence must be visible before any payload word changes
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < WORDS; i++) {
+        storage_->words[i].store(words[i], std::memory_order_relaxed);
+    }
+    storage_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+template<typename T>
+bool LatestValueMailbox<T>::try_read(T& value) const {
+    const uint64_t before = storage_->sequence.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1)) {
+        return false;
+    }
+
+    uint64_t words[WORDS];
+    for (size_t i = 0; i < WORDS; i++) {
+        words[i] = storage_->words[i].load(std::memory_order_relaxed);
+    }
+    // Payload loads must complete before the sequence is re-checked
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (storage_->sequence.load(std::memory_order_relaxed) != before) {
+        return false;
+    }
+
+    std::memcpy(&value, words, sizeof(T));
+    return true;
+}
+
+template<typename T>
+bool LatestValueMailbox<T>::read(T& value) const {
+    while (!try_read(value)) {
+        if (storage_->sequence.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T>
+uint64_t LatestValueMailbox<T>::version() const {
+    return storage_->sequence.load(std::memory_order_acquire) / 2;
+}
@@ -0,0 +1,163 @@
+#include "live_qc.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char* const CONDITION_NAMES[] = {"covered", "overexposed", "blurry", "frozen"};
+
+// Same clock as CameraFrame::timestamp_us
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+LiveQc::LiveQc() : every_n_(QC_DEFAULT_EVERY_N), monitor_(nullptr) {}
+
+LiveQc::~LiveQc() {
+    stop();
+}
+
+bool LiveQc::initialize(
+    const std::vector<std::string>& device_names,
+    const std::vector<BroadcastRing<CameraFrame>*>& rings,
+    int every_n, PerformanceMonitor* monitor,
+    const QcThresholds& thresholds
+) {
+    if (every_n <= 0) {
+        std::cerr << "LiveQc: every_n must be positive" << std::endl;
+        return false;
+    }
+    if (device_names.size() != rings.size()) {
+        std::cerr << "LiveQc: need one ring per device" << std::endl;
+        return false;
+    }
+    every_n_ = every_n;
+    monitor_ = monitor;
+    thresholds_ = thresholds;
+    for (size_t i = 0; i < device_names.size(); i++) {
+        auto camera = std::make_unique<CameraQcState>();
+        camera->device_name = device_names[i];
+        camera->ring = rings[i];
+        camera->consumer = rings[i]->add_consumer(ConsumerPolicy::LOSSY);
+        cameras_.push_back(std::move(camera));
+    }
+    std::cout << "LiveQc initialized: every " << every_n_ << " frames on " << cameras_.size() << " cameras" << std::endl;
+    return true;
+}
+
+bool LiveQc::start() {
+    running_.store(true);
+    qc_thread_ = std::make_unique<std::thread>(&LiveQc::qc_thread_func_, this);
+    return true;
+}
+
+void LiveQc::stop() {
+    running_.store(false);
+    if (qc_thread_ && qc_thread_->joinable()) {
+        qc_thread_->join();
+    }
+    qc_thread_.reset();
+}
+
+void LiveQc::qc_thread_func_() {
+    while (running_.load()) {
+        bool did_work = false;
+        for (auto& camera : cameras_) {
+            // Frames not due for QC cost a peek and a release
+            while (const CameraFrame* frame = camera->ring->peek(camera->consumer)) {
+                did_work = true;
+                if (frame->sequence_number % every_n_ == 0 && frame->format == CameraFormat::YUYV) {
+                    check_frame_(*camera, *frame);
+                }
+                camera->ring->release(camera->consumer);
+            }
+        }
+        if (!did_work) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+}
+
+void LiveQc::check_frame_(CameraQcState& camera, const CameraFrame& frame) {
+    if (frame.image_data.size() < static_cast<size_t>(frame.width) * frame.height * 2 || frame.height < 3) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    FrameQcStats stats = compute_frame_qc(frame.image_data.data(), frame.width, frame.height);
+    camera.total_compute_us += std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - start).count();
+    camera.frames_checked++;
+    camera.last_stats = stats;
+
+    if (stats.block_hash == camera.last_hash) {
+        camera.hash_repeats++;
+    } else {
+        camera.hash_repeats = 0;
+        camera.last_hash = stats.block_hash;
+    }
+
+    update_condition_(camera, COVERED, stats.mean_luma < thresholds_.min_mean_luma, frame);
+    update_condition_(camera, OVEREXPOSED, stats.clipped_high_fraction > thresholds_.max_clipped_high_fraction, frame);
+    update_condition_(camera, BLURRY, stats.laplacian_variance < thresholds_.min_laplacian_variance, frame);
+    update_condition_(camera, FROZEN, camera.hash_repeats + 1 >= thresholds_.frozen_repeats, frame);
+}
+
+void LiveQc::update_condition_(CameraQcState& camera, Condition condition, bool active, const CameraFrame& frame) {
+    // Only transitions are logged, so a covered lens is one alert, not one per frame
+    if (camera.active[condition] == active) {
+        return;
+    }
+    camera.active[condition] = active;
+
+    const FrameQcStats& stats = camera.last_stats;
+    std::ostringstream json_line;
+    json_line << "{"
+              << "\"timestamp_us\":" << frame.timestamp_us << ","
+              << "\"event_type\":\"" << (active ? "qc_alert" : "qc_recovered") << "\","
+              << "\"device_name\":\"" << camera.device_name << "\","
+              << "\"sequence_number\":" << frame.sequence_number << ","
+              << "\"condition\":\"" << CONDITION_NAMES[condition] << "\","
+              << "\"mean_luma\":" << stats.mean_luma << ","
+              << "\"clipped_low_fraction\":" << stats.clipped_low_fraction << ","
+              << "\"clipped_high_fraction\":" << stats.clipped_high_fraction << ","
+              << "\"laplacian_variance\":" << stats.laplacian_variance
+              << "}";
+    if (monitor_) {
+        monitor_->log_event(json_line.str());
+    }
+    if (active) {
+        std::cout << "QC ALERT: " << camera.device_name << " " << CONDITION_NAMES[condition] 
+                  << " (seq=" << frame.sequence_number << ")" << std::endl;
+    }
+}
+
+void LiveQc::report() const {
+    std::cout << "\nLive QC:" << std::endl;
+    const uint64_t report_timestamp_us = steady_now_us();
+    for (const auto& camera : cameras_) {
+        double mean_us = camera->frames_checked ? camera->total_compute_us / camera->frames_checked : 0.0;
+        std::cout << "  " << camera->device_name << ": " << camera->frames_checked << " frames checked, "
+                  << camera->ring->dropped(camera->consumer) << " skipped, " << std::fixed << std::setprecision(1) 
+                  << mean_us << " us/frame" << std::endl;
+
+        if (monitor_) {
+            std::ostringstream json_line;
+            json_line << "{"
+                      << "\"timestamp_us\":" << report_timestamp_us << ","
+                      << "\"event_type\":\"qc_summary\","
+                      << "\"device_name\":\"" << camera->device_name << "\","
+                      << "\"frames_checked\":" << camera->frames_checked << ","
+                      << "\"frames_skipped\":" << camera->ring->dropped(camera->consumer) << ","
+                      << "\"mean_compute_us\":" << mean_us
+                      << "}";
+            monitor_->log_event(json_line.str());
+        }
+    }
+}
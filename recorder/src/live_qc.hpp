@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "camera_capture_pipeline.hpp"
+#include "frame_qc.hpp"
+#include "performance_monitor.hpp"
+#include "broadcast_ring.hpp"
+
+// Check every Nth frame per camera (0 disables live QC).
+constexpr int QC_DEFAULT_EVERY_N = 15;
+
+struct QcThresholds {
+    double min_mean_luma = 25.0;            // below: lens covered / lights off
+    double max_clipped_high_fraction = 0.2; // above: over-exposed
+    double min_laplacian_variance = 15.0;   // below: out of focus / smeared
+    int frozen_repeats = 3;                 // identical block hashes in a row: frozen sensor
+};
+
+/*
+    Image QC off the sync path. The QC thread is a lossy consumer of each
+    camera's BroadcastRing: it reads every Nth frame in place and, if it falls
+    behind, frames are skipped, never the capture. It computes FrameQcStats and
+    writes qc_alert / qc_recovered events to events.jsonl when a condition changes.
+*/
+class LiveQc {
+private:
+    enum Condition { COVERED = 0, OVEREXPOSED, BLURRY, FROZEN, NUM_CONDITIONS };
+
+    struct CameraQcState {
+        std::string device_name;
+        BroadcastRing<CameraFrame>* ring = nullptr;
+        int consumer = -1;
+        uint64_t last_hash = 0;
+        int hash_repeats = 0;
+        bool active[NUM_CONDITIONS] = {};
+        uint64_t frames_checked = 0;
+        double total_compute_us = 0.0;
+        FrameQcStats last_stats = {};
+    };
+
+    std::vector<std::unique_ptr<CameraQcState>> cameras_;
+    int every_n_;
+    QcThresholds thresholds_;
+    PerformanceMonitor* monitor_;
+    std::unique_ptr<std::thread> qc_thread_;
+    std::atomic<bool> running_{false};
+
+    void qc_thread_func_();
+    void check_frame_(CameraQcState& camera, const CameraFrame& frame);
+    void update_condition_(CameraQcState& camera, Condition condition, bool active, const CameraFrame& frame);
+
+public:
+    LiveQc();
+    ~LiveQc();
+
+    // rings[i] carries device_names[i]; must be called before frames are published
+    bool initialize(
+        const std::vector<std::string>& device_names,
+        const std::vector<BroadcastRing<CameraFrame>*>& rings,
+        int every_n, PerformanceMonitor* monitor,
+        const QcThresholds& thresholds = QcThresholds()
+    );
+
+    bool start();
+    void stop();
+    void report() const;
+};
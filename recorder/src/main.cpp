@@ -3,7 +3,9 @@
 #include <chrono>
 #include <thread>
 #include <algorithm>
+#include <cctype>
 #include <csignal>
+#include <fstream>
 #include <unordered_map>
 
 #include "camera_capture_pipeline.hpp"
@@ -120,6 +122,41 @@
 //     return 0;
 // }
 
+// "cam_front=..." or "/dev/cam_front=..." -> device, value. False for an unknown camera.
+bool parse_camera_assignment(const std::string& arg, std::string& device, std::string& value) {
+    size_t equals = arg.find('=');
+    if (equals == std::string::npos || equals == 0) {
+        return false;
+    }
+    device = arg.substr(0, equals);
+    if (device[0] != '/') {
+        device = "/dev/" + device;
+    }
+    value = arg.substr(equals + 1);
+    return CAM_CONFIG.count(device) > 0;
+}
+
+// Pipeline template file: gst-launch text over any number of lines, '#' comment lines skipped
+bool read_pipeline_template_file(const std::string& path, std::string& pipeline_template) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    pipeline_template.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        if (!pipeline_template.empty()) {
+            pipeline_template += ' ';
+        }
+        pipeline_template += line.substr(start);
+    }
+    return !pipeline_template.empty();
+}
+
 void print_usage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [OPTIONS]\n"
               << "\nOptions:\n"
@@ -127,11 +164,51 @@ void print_usage(const char* program_name) {
               << "  --duration <seconds>   Recording duration in seconds (default: unlimited)\n"
               << "  --display              Enable display mode (default: headless)\n"
               << "  --live-metrics         Show live metrics every 2 seconds during recording\n"
+              << "  --joint-device <path>  Record arm joint state from this serial/pty device\n"
+              << "  --joint-baud <rate>    Joint state serial baud rate (default: 1000000)\n"
+              << "  --flight-recorder <path>       Flight recorder file (default: <output-dir>/flight_recorder.bin)\n"
+              << "  --flight-recorder-minutes <n>  Minutes of history the flight recorder keeps (default: 10)\n"
+              << "  --no-flight-recorder           Disable the flight recorder\n"
+              << "  --raw-video            Write lossless cam_*.yuyv instead of cam_*.mp4\n"
+              << "  --replay <session>     Replay a recorded session directory instead of the cameras\n"
+              << "  --replay-speed <x>     Replay speed: 1 = real time (default), N = N times faster, max = no pacing\n"
+              << "  --qc-every <n>         Live image QC on every Nth frame per camera (default: 15, 0 = off)\n"
+              << "  --preview-port <port>  Serve a 320x240 @ 10 fps MJPEG preview on this port (default: off)\n"
+              << "  --preview-bind <addr>  Preview listen address (default: 127.0.0.1, 0.0.0.0 for a headset)\n"
+              << "  --status-shm <name>    Publish live status to this shm object (default: /robodaq_recorder_status)\n"
+              << "  --no-status-shm        Don't publish status to shared memory\n"
+              << "  --frame-shm <prefix>   Publish live frames to shm rings <prefix>_cam_front, ... (default: off)\n"
+              << "  --frame-shm-slots <n>  Frames kept in each shm ring (default: 8)\n"
+              << "  --buffer-seconds <s>   Seconds of video buffered per camera ring (default: 3)\n"
+              << "  --gst-queue-seconds <s> Seconds of video in each GStreamer capture queue (default: 1)\n"
+              << "  --memory-budget-mb <mb> Cap on all buffered frames (default: 25% of RAM)\n"
+              << "  --sync-policy <p>      Front/right matching: first-within (default), keep-newer, nearest\n"
+              << "  --sync-tolerance-us <us> Max front/right capture time difference (default: 33333)\n"
+              << "  --pipeline <cam>=<template>    Capture pipeline for one camera, gst-launch syntax ending in\n"
+              << "                                 'appsink name=app-sink'; {device} {width} {height} {framerate}\n"
+              << "                                 {format} {queue_max_buffers} are filled in (repeatable)\n"
+              << "  --pipeline-file <cam>=<path>   Same, template read from a file ('#' lines are comments)\n"
+              << "  --output <name>=<WxH>[:crop][,codec]  Also write cam_*_<name> scaled (or centre-cropped)\n"
+              << "                                 from the same frames, e.g. train=224x224:crop,x264 (repeatable)\n"
+              << "  --storage <part>=<dir> Put one part of the session on another disk: cam_front, cam_right,\n"
+              << "                                 logs or an --output name (repeatable); metadata.json in\n"
+              << "                                 --output-dir lists where every file went\n"
+              << "  --compact-logs         Also write session_columns.bin (typed log columns for analytics,\n"
+              << "                                 see tools/session_compact) when the session ends\n"
+              << "  --motion-gate          Write only 1 in --idle-keep-every bundles while nothing moves\n"
+              << "  --motion-threshold <t> Mean luma change (0-255) on a coarse grid that counts as motion (default: 4)\n"
+              << "  --motion-hold-ms <ms>  Keep every bundle this long after the last motion (default: 1000)\n"
+              << "  --idle-keep-every <n>  Bundles kept while idle: 1 in n (default: 10)\n"
               << "  --help                 Show this help message\n"
               << "\nExamples:\n"
               << "  " << program_name << " --output-dir /path/to/recordings\n"
               << "  " << program_name << " --output-dir ./recordings --display --duration 60\n"
               << "  " << program_name << " --output-dir ./recordings --live-metrics --duration 120\n"
+              << "  " << program_name << " --output-dir ./recordings --joint-device /dev/ttyACM0\n"
+              << "  " << program_name << " --output-dir ./recordings --pipeline \"cam_front=v4l2src device={device} io-mode=dmabuf"
+              << " ! video/x-raw,format={format},width={width},height={height},framerate={framerate}/1"
+              << " ! queue name=ring-buffer max-size-buffers=10 leaky=downstream ! appsink name=app-sink sync=false max-buffers=1 drop=true\"\n"
+              << "  " << program_name << " --output-dir ./replays --replay ./recordings/recording_20250101_120000 --replay-speed max\n"
               << std::endl;
 }
 
@@ -141,6 +218,7 @@ int main(int argc, char** argv) {
     std::string output_dir = "";
     int duration_seconds = 0; // 0 means unlimited
     bool live_metrics = false;
+    RecorderOptions options;
     
     // Parse command-line arguments
     for (int i = 1; i < argc; i++) {
@@ -162,6 +240,342 @@ int main(int argc, char** argv) {
                 print_usage(argv[0]);
                 return 1;
             }
+        } else if (arg == "--joint-device") {
+            if (i + 1 < argc) {
+                options.joint_device = std::string(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: --joint-device requires a device path\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--joint-baud") {
+            if (i + 1 < argc) {
+                try {
+                    options.joint_baud_rate = std::stoi(argv[i + 1]);
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid baud rate '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --joint-baud requires a baud rate\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--flight-recorder") {
+            if (i + 1 < argc) {
+                options.flight_recorder_path = std::string(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: --flight-recorder requires a file path\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--flight-recorder-minutes") {
+            if (i + 1 < argc) {
+                try {
+                    options.flight_recorder_minutes = std::stoi(argv[i + 1]);
+                    if (options.flight_recorder_minutes <= 0) {
+                        std::cerr << "Error: --flight-recorder-minutes must be a positive integer\n" << std::endl;
+                        return 1;
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid minutes value '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --flight-recorder-minutes requires a number of minutes\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--no-flight-recorder") {
+            options.flight_recorder_enabled = false;
+        } else if (arg == "--raw-video") {
+            options.raw_video = true;
+        } else if (arg == "--replay") {
+            if (i + 1 < argc) {
+                options.replay_session_dir = std::string(argv[i + 1]);
+                i++;
+            } else {
+                std::cerr << "Error: --replay requires a session directory\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--replay-speed") {
+            if (i + 1 < argc) {
+                std::string speed = argv[i + 1];
+                i++;
+                if (speed == "max") {
+                    options.replay_mode = ReplayMode::AS_FAST_AS_POSSIBLE;
+                    continue;
+                }
+                try {
+                    options.replay_speed = std::stod(speed);
+                } catch (const std::exception& e) {
+                    options.replay_speed = 0.0;
+                }
+                if (options.replay_speed <= 0.0) {
+                    std::cerr << "Error: --replay-speed must be a positive number or 'max'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                options.replay_mode = (options.replay_speed == 1.0) ? ReplayMode::REALTIME : ReplayMode::SCALED;
+            } else {
+                std::cerr << "Error: --replay-speed requires a speed factor or 'max'\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--qc-every") {
+            if (i + 1 < argc) {
+                try {
+                    options.qc_every_n = std::stoi(argv[i + 1]);
+                    if (options.qc_every_n < 0) {
+                        std::cerr << "Error: --qc-every must be 0 or a positive integer\n" << std::endl;
+                        return 1;
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid QC interval '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --qc-every requires a frame count\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--preview-port") {
+            if (i + 1 < argc) {
+                try {
+                    options.preview_port = std::stoi(argv[i + 1]);
+                    if (options.preview_port <= 0 || options.preview_port > 65535) {
+                        std::cerr << "Error: --preview-port must be between 1 and 65535\n" << std::endl;
+                        return 1;
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid preview port '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --preview-port requires a port number\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--preview-bind") {
+            if (i + 1 < argc) {
+                options.preview_bind_address = argv[i + 1];
+                i++;
+            } else {
+                std::cerr << "Error: --preview-bind requires an address\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--status-shm") {
+            if (i + 1 < argc) {
+                options.status_shm_name = argv[i + 1];
+                if (options.status_shm_name.empty() || options.status_shm_name[0] != '/') {
+                    std::cerr << "Error: --status-shm name must start with '/'\n" << std::endl;
+                    return 1;
+                }
+                i++;
+            } else {
+                std::cerr << "Error: --status-shm requires a name\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--no-status-shm") {
+            options.status_shm_name.clear();
+        } else if (arg == "--frame-shm") {
+            if (i + 1 < argc) {
+                options.frame_shm_prefix = argv[i + 1];
+                if (options.frame_shm_prefix.empty() || options.frame_shm_prefix[0] != '/') {
+                    std::cerr << "Error: --frame-shm prefix must start with '/'\n" << std::endl;
+                    return 1;
+                }
+                i++;
+            } else {
+                std::cerr << "Error: --frame-shm requires a name prefix (e.g. " << FRAME_SHM_DEFAULT_PREFIX << ")\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--frame-shm-slots") {
+            if (i + 1 < argc) {
+                try {
+                    options.frame_shm_slots = std::stoi(argv[i + 1]);
+                    if (options.frame_shm_slots < 2) {
+                        std::cerr << "Error: --frame-shm-slots must be at least 2\n" << std::endl;
+                        return 1;
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid slot count '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --frame-shm-slots requires a slot count\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--buffer-seconds" || arg == "--gst-queue-seconds" || arg == "--memory-budget-mb") {
+            if (i + 1 < argc) {
+                try {
+                    double value = std::stod(argv[i + 1]);
+                    if (value <= 0) {
+                        std::cerr << "Error: " << arg << " must be positive\n" << std::endl;
+                        return 1;
+                    }
+                    if (arg == "--buffer-seconds") {
+                        options.ring_buffer_seconds = value;
+                    } else if (arg == "--gst-queue-seconds") {
+                        options.gst_queue_seconds = value;
+                    } else {
+                        options.memory_budget_bytes = static_cast<uint64_t>(value * 1024 * 1024);
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid value for " << arg << ": '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: " << arg << " requires a value\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--sync-policy") {
+            if (i + 1 < argc) {
+                if (!parse_sync_policy(argv[i + 1], options.sync_policy)) {
+                    std::cerr << "Error: Unknown sync policy '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                i++;
+            } else {
+                std::cerr << "Error: --sync-policy requires a policy name\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--sync-tolerance-us") {
+            if (i + 1 < argc) {
+                try {
+                    options.sync_tolerance_us = std::stoi(argv[i + 1]);
+                    if (options.sync_tolerance_us <= 0) {
+                        std::cerr << "Error: --sync-tolerance-us must be a positive integer\n" << std::endl;
+                        return 1;
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid sync tolerance '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --sync-tolerance-us requires a number of microseconds\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--pipeline" || arg == "--pipeline-file") {
+            if (i + 1 < argc) {
+                std::string device;
+                std::string value;
+                if (!parse_camera_assignment(argv[i + 1], device, value) || value.empty()) {
+                    std::cerr << "Error: " << arg << " takes <camera>=<" << (arg == "--pipeline" ? "template" : "path")
+                              << "> for cam_front or cam_right, got '" << argv[i + 1] << "'\n" << std::endl;
+                    return 1;
+                }
+                std::string pipeline_template = value;
+                if (arg == "--pipeline-file" && !read_pipeline_template_file(value, pipeline_template)) {
+                    std::cerr << "Error: Can't read a pipeline template from '" << value << "'\n" << std::endl;
+                    return 1;
+                }
+                options.pipeline_templates[device] = pipeline_template;
+                i++;
+            } else {
+                std::cerr << "Error: " << arg << " requires <camera>=<value>\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--output") {
+            if (i + 1 < argc) {
+                std::string spec = argv[i + 1];
+                VideoOutputSpec output;
+                size_t equals = spec.find('=');
+                size_t comma = spec.find(',', equals == std::string::npos ? 0 : equals);
+                bool valid = equals != std::string::npos && equals > 0;
+                if (valid) {
+                    output.name = spec.substr(0, equals);
+                    valid = std::all_of(output.name.begin(), output.name.end(), [](char c) {
+                        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+                    });
+                }
+                if (valid) {
+                    std::string size = spec.substr(equals + 1, comma == std::string::npos ? std::string::npos : comma - equals - 1);
+                    valid = parse_resize_spec(size, output.width, output.height, output.mode);
+                }
+                if (comma != std::string::npos) {
+                    output.codec = spec.substr(comma + 1);
+                    valid = valid && (output.codec.size() == 4 || output.codec == RAW_VIDEO_CODEC ||
+                                      output.codec == GST_X264_VIDEO_CODEC);
+                }
+                if (!valid) {
+                    std::cerr << "Error: --output takes <name>=<WxH>[:crop][,codec], got '" << spec << "'\n" << std::endl;
+                    return 1;
+                }
+                options.video_outputs.push_back(output);
+                i++;
+            } else {
+                std::cerr << "Error: --output requires <name>=<WxH>[:crop][,codec]\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--storage") {
+            std::string spec = i + 1 < argc ? argv[i + 1] : "";
+            size_t equals = spec.find('=');
+            if (equals == std::string::npos || equals == 0 || equals + 1 == spec.size()) {
+                std::cerr << "Error: --storage requires <part>=<dir>\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+            options.storage_dirs[spec.substr(0, equals)] = spec.substr(equals + 1);
+            i++;
+        } else if (arg == "--compact-logs") {
+            options.compact_logs = true;
+        } else if (arg == "--motion-gate") {
+            options.motion_gate = true;
+        } else if (arg == "--motion-threshold" || arg == "--motion-hold-ms" || arg == "--idle-keep-every") {
+            if (i + 1 < argc) {
+                try {
+                    double value = std::stod(argv[i + 1]);
+                    if (value <= 0 || (arg == "--idle-keep-every" && value != static_cast<int>(value))) {
+                        std::cerr << "Error: " << arg << " must be a positive "
+                                  << (arg == "--idle-keep-every" ? "integer" : "number") << "\n" << std::endl;
+                        return 1;
+                    }
+                    if (arg == "--motion-threshold") {
+                        options.motion_gate_config.threshold = value;
+                    } else if (arg == "--motion-hold-ms") {
+                        options.motion_gate_config.hold_us = static_cast<uint64_t>(value * 1000);
+                    } else {
+                        options.motion_gate_config.idle_keep_every = static_cast<int>(value);
+                    }
+                    i++;
+                } catch (const std::exception& e) {
+                    std::cerr << "Error: Invalid value for " << arg << ": '" << argv[i + 1] << "'\n" << std::endl;
+                    print_usage(argv[0]);
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: " << arg << " requires a value\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
         } else if (arg == "--duration") {
             if (i + 1 < argc) {
                 try {
@@ -195,6 +609,16 @@ int main(int argc, char** argv) {
         return 1;
     }
     
+    for (const auto& [part, dir] : options.storage_dirs) {
+        const bool known = part == "cam_front" || part == "cam_right" || part == "logs" ||
+            std::any_of(options.video_outputs.begin(), options.video_outputs.end(),
+                        [&part](const VideoOutputSpec& output) { return output.name == part; });
+        if (!known) {
+            std::cerr << "Error: --storage part '" << part << "' is not cam_front, cam_right, logs or an --output name\n" << std::endl;
+            return 1;
+        }
+    }
+
     std::cout << "Starting recorder with output directory: " << output_dir << std::endl;
     std::cout << "Mode: " << (mode == SinkMode::DISPLAY ? "DISPLAY" : "HEADLESS") << std::endl;
     if (duration_seconds > 0) {
@@ -203,8 +627,12 @@ int main(int argc, char** argv) {
         std::cout << "Recording duration: unlimited (press Ctrl+C to stop)" << std::endl;
     }
     std::cout << "Live metrics: " << (live_metrics ? "enabled" : "disabled") << std::endl;
+    std::cout << "Joint state: " << (options.joint_device.empty() ? "disabled" : options.joint_device) << std::endl;
+    if (!options.replay_session_dir.empty()) {
+        std::cout << "Replaying: " << options.replay_session_dir << std::endl;
+    }
     
-    Recorder recorder(output_dir);
+    Recorder recorder(output_dir, options);
     
     if (!recorder.run(mode, duration_seconds, live_metrics)) {
         return 1;
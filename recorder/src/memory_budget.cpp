@@ -0,0 +1,109 @@
+#include "memory_budget.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+
+double to_mb(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+MemoryBudget::MemoryBudget(uint64_t limit_bytes)
+    : limit_bytes_(limit_bytes), reserved_bytes_(0), in_use_bytes_(0), peak_in_use_bytes_(0) {}
+
+uint64_t MemoryBudget::default_limit_bytes() {
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    if (pages <= 0 || page_size <= 0) {
+        return 1024ull * 1024 * 1024;  // 1 GB if the kernel won't say
+    }
+    return static_cast<uint64_t>(static_cast<double>(pages) * page_size * MEMORY_BUDGET_DEFAULT_RAM_FRACTION);
+}
+
+bool MemoryBudget::try_reserve(const std::string& name, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (reserved_bytes_ + bytes > limit_bytes_) {
+        std::cerr << "Memory budget: cannot reserve " << std::fixed << std::setprecision(1) << to_mb(bytes)
+                  << " MB for " << name << " (" << to_mb(limit_bytes_ - reserved_bytes_) << " of "
+                  << to_mb(limit_bytes_) << " MB left)" << std::endl;
+        return false;
+    }
+    reserved_bytes_ += bytes;
+    reservations_.push_back({name, bytes});
+    return true;
+}
+
+void MemoryBudget::release(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = reservations_.begin(); it != reservations_.end(); ++it) {
+        if (it->name == name) {
+            reserved_bytes_ -= it->bytes;
+            reservations_.erase(it);
+            return;
+        }
+    }
+}
+
+void MemoryBudget::update_in_use(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    in_use_bytes_ = bytes;
+    if (bytes > peak_in_use_bytes_) {
+        peak_in_use_bytes_ = bytes;
+    }
+}
+
+uint64_t MemoryBudget::limit_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limit_bytes_;
+}
+
+uint64_t MemoryBudget::reserved_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reserved_bytes_;
+}
+
+uint64_t MemoryBudget::available_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limit_bytes_ - reserved_bytes_;
+}
+
+uint64_t MemoryBudget::in_use_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return in_use_bytes_;
+}
+
+uint64_t MemoryBudget::peak_in_use_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return peak_in_use_bytes_;
+}
+
+std::string MemoryBudget::to_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream json;
+    json << "{\"limit_bytes\":" << limit_bytes_
+         << ",\"reserved_bytes\":" << reserved_bytes_
+         << ",\"peak_in_use_bytes\":" << peak_in_use_bytes_
+         << ",\"reservations\":{";
+    for (size_t i = 0; i < reservations_.size(); i++) {
+        json << (i ? "," : "") << "\"" << reservations_[i].name << "\":" << reservations_[i].bytes;
+    }
+    json << "}}";
+    return json.str();
+}
+
+void MemoryBudget::report() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "\nMemory Budget:" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  Reserved: " << to_mb(reserved_bytes_) << " / " << to_mb(limit_bytes_) << " MB ("
+              << (limit_bytes_ ? 100.0 * reserved_bytes_ / limit_bytes_ : 0.0) << "%)" << std::endl;
+    std::cout << "  Peak buffered: " << to_mb(peak_in_use_bytes_) << " MB" << std::endl;
+    for (const auto& reservation : reservations_) {
+        std::cout << "    " << reservation.name << ": " << to_mb(reservation.bytes) << " MB" << std::endl;
+    }
+}
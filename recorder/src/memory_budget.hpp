@@ -0,0 +1,51 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Default budget when none is configured: this fraction of physical RAM
+constexpr double MEMORY_BUDGET_DEFAULT_RAM_FRACTION = 0.25;
+
+/*
+    Process-wide byte budget for buffered frames (camera rings, GStreamer
+    queues, QC/preview copies). Every consumer reserves its worst case up
+    front; a reservation that doesn't fit is refused, so adding cameras or
+    raising resolution fails at startup instead of pushing the box into swap.
+*/
+class MemoryBudget {
+private:
+    struct Reservation {
+        std::string name;
+        uint64_t bytes;
+    };
+
+    mutable std::mutex mutex_;
+    uint64_t limit_bytes_;
+    uint64_t reserved_bytes_;
+    uint64_t in_use_bytes_;
+    uint64_t peak_in_use_bytes_;
+    std::vector<Reservation> reservations_;
+
+public:
+    explicit MemoryBudget(uint64_t limit_bytes = default_limit_bytes());
+
+    // All-or-nothing: false (and nothing reserved) if it would exceed the limit
+    bool try_reserve(const std::string& name, uint64_t bytes);
+    void release(const std::string& name);
+
+    // Sampled usage of what has been reserved (e.g. frames sitting in rings)
+    void update_in_use(uint64_t bytes);
+
+    uint64_t limit_bytes() const;
+    uint64_t reserved_bytes() const;
+    uint64_t available_bytes() const;
+    uint64_t in_use_bytes() const;
+    uint64_t peak_in_use_bytes() const;
+
+    std::string to_json() const;
+    void report() const;
+
+    static uint64_t default_limit_bytes();
+};
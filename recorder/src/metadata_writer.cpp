@@ -6,7 +6,10 @@ bool MetadataWriter::write_metadata(
     int sync_tolerance_us,
     const std::string& front_video_path,
     const std::string& right_video_path,
-    const std::string& sync_log_path
+    const std::string& sync_log_path,
+    const std::string& joint_state_path,
+    const std::vector<std::pair<std::string, std::string>>& extra_output_files,
+    const std::string& storage_json
 ) {
     std::ofstream metadata_file(path);
     if (!metadata_file.is_open()) {
@@ -53,8 +56,19 @@ bool MetadataWriter::write_metadata(
     metadata_file << "  \"output_files\": {\n";
     metadata_file << "    \"front_camera_video\": \"" << front_video_path << "\",\n";
     metadata_file << "    \"right_camera_video\": \"" << right_video_path << "\",\n";
-    metadata_file << "    \"sync_log\": \"" << sync_log_path << "\"\n";
-    metadata_file << "  }\n";
+    metadata_file << "    \"sync_log\": \"" << sync_log_path << "\"";
+    if (!joint_state_path.empty()) {
+        metadata_file << ",\n    \"joint_state\": \"" << joint_state_path << "\"";
+    }
+    for (const auto& [key, file_path] : extra_output_files) {
+        metadata_file << ",\n    \"" << key << "\": \"" << file_path << "\"";
+    }
+    metadata_file << "\n";
+    metadata_file << "  }";
+    if (!storage_json.empty()) {
+        metadata_file << ",\n  \"storage\": " << storage_json;
+    }
+    metadata_file << "\n";
     metadata_file << "}\n";
     
     metadata_file.close();
@@ -6,6 +6,8 @@
 #include <iomanip>
 #include <chrono>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 class MetadataWriter {
 public:
@@ -15,7 +17,12 @@ public:
         int sync_tolerance_us,
         const std::string& front_video_path,
         const std::string& right_video_path,
-        const std::string& sync_log_path
+        const std::string& sync_log_path,
+        const std::string& joint_state_path = "",
+        // More parts of the session as (key, path), added to "output_files"
+        const std::vector<std::pair<std::string, std::string>>& extra_output_files = {},
+        // JSON object describing where the parts live (OutputStriper devices); empty to omit
+        const std::string& storage_json = ""
     );
 };
 
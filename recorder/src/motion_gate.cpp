@@ -0,0 +1,89 @@
+#include "motion_gate.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+double MotionGate::score_(const CameraFrame& frame, CameraGrid& grid) {
+    const size_t bytes_per_pixel = camera_format_bytes_per_pixel(frame.format);
+    if (frame.width != grid.width || frame.height != grid.height || grid.offsets.empty()) {
+        // First frame or a new size: no reference, so it counts as motion
+        grid.width = frame.width;
+        grid.height = frame.height;
+        grid.offsets.clear();
+        for (int gy = 0; gy < MOTION_GRID_H; gy++) {
+            const size_t y = (2 * gy + 1) * static_cast<size_t>(frame.height) / (2 * MOTION_GRID_H);
+            for (int gx = 0; gx < MOTION_GRID_W; gx++) {
+                const size_t x = (2 * gx + 1) * static_cast<size_t>(frame.width) / (2 * MOTION_GRID_W);
+                // First byte of the pixel: Y for YUYV and GRAY, R for RGB (close enough for a motion score)
+                grid.offsets.push_back((y * frame.width + x) * bytes_per_pixel);
+            }
+        }
+        grid.reference.clear();
+        grid.current.assign(grid.offsets.size(), 0);
+    }
+    const size_t size = frame.image_data.size();
+    const uint8_t* data = frame.image_data.data();
+    for (size_t i = 0; i < grid.offsets.size(); i++) {
+        grid.current[i] = grid.offsets[i] < size ? data[grid.offsets[i]] : 0;
+    }
+    if (grid.reference.empty()) {
+        return 255.0;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < grid.current.size(); i++) {
+        sum += std::abs(static_cast<int>(grid.current[i]) - static_cast<int>(grid.reference[i]));
+    }
+    return static_cast<double>(sum) / grid.current.size();
+}
+
+MotionDecision MotionGate::update(const CameraFrame& front, const CameraFrame& right) {
+    MotionDecision decision;
+    decision.score = std::max(score_(front, grids_[0]), score_(right, grids_[1]));
+
+    const uint64_t now_us = front.timestamp_us;
+    const double needed = active_ ? config_.threshold / 2 : config_.threshold;
+    const bool was_active = active_;
+    if (decision.score >= needed) {
+        active_ = true;
+        active_until_us_ = now_us + config_.hold_us;
+    } else if (active_ && now_us >= active_until_us_) {
+        active_ = false;
+        idle_count_ = 0;
+    }
+    decision.active = active_;
+    decision.state_changed = active_ != was_active;
+
+    // Idle: keep the first bundle, then one in idle_keep_every
+    decision.keep = active_ || config_.idle_keep_every <= 1 ||
+        idle_count_++ % static_cast<uint64_t>(config_.idle_keep_every) == 0;
+
+    if (!decision.keep) {
+        if (run_.count == 0) {
+            run_.first_timestamp_us = front.timestamp_us;
+            run_.first_seq = front.sequence_number;
+        }
+        run_.count++;
+        run_.last_timestamp_us = front.timestamp_us;
+        run_.last_seq = front.sequence_number;
+        skipped_++;
+        return decision;
+    }
+
+    grids_[0].reference = grids_[0].current;
+    grids_[1].reference = grids_[1].current;
+    if (run_.count > 0) {
+        decision.ended_run = run_;
+        run_ = SkippedRun();
+    }
+    kept_++;
+    return decision;
+}
+
+bool MotionGate::finish(SkippedRun& run) {
+    if (run_.count == 0) {
+        return false;
+    }
+    run = run_;
+    run_ = SkippedRun();
+    return true;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "camera_capture_pipeline.hpp"
+
+// Luma samples per camera the gate compares (a GRID_W x GRID_H grid)
+constexpr int MOTION_GRID_W = 32;
+constexpr int MOTION_GRID_H = 24;
+
+struct MotionGateConfig {
+    // Mean absolute luma difference (0-255) over the grid that counts as
+    // motion. Staying active only needs half of it (hysteresis), so noise
+    // around the threshold doesn't flap the gate.
+    double threshold = 4.0;
+    // Stay active this long after the last motion
+    uint64_t hold_us = 1'000'000;
+    // While idle, keep one bundle in this many (minimum keep rate); 1 keeps all
+    int idle_keep_every = 10;
+};
+
+// A run of consecutive bundles the gate dropped, by front frame
+struct SkippedRun {
+    uint64_t count = 0;
+    uint64_t first_timestamp_us = 0;
+    uint64_t last_timestamp_us = 0;
+    uint64_t first_seq = 0;
+    uint64_t last_seq = 0;
+};
+
+struct MotionDecision {
+    bool keep = true;
+    bool active = true;
+    bool state_changed = false;   // active/idle flipped on this bundle
+    double score = 0;             // max over the cameras
+    SkippedRun ended_run;         // count > 0 if this kept bundle ends a skipped run
+};
+
+/*
+    Decides, per synced bundle, whether it's worth encoding. Each camera's Y
+    plane is sampled on a coarse grid and compared with the grid of the last
+    kept bundle, so slow drift still adds up while frames are being skipped.
+    Idle bundles are thinned to 1 in idle_keep_every; any motion on any
+    camera brings back every bundle for at least hold_us.
+
+    Sync thread only.
+*/
+class MotionGate {
+    public:
+        explicit MotionGate(const MotionGateConfig& config) : config_(config) {}
+
+        MotionDecision update(const CameraFrame& front, const CameraFrame& right);
+
+        // Skipped run still open at the end of the session, if any
+        bool finish(SkippedRun& run);
+
+        uint64_t kept() const { return kept_; }
+        uint64_t skipped() const { return skipped_; }
+        const MotionGateConfig& config() const { return config_; }
+
+    private:
+        struct CameraGrid {
+            std::vector<uint8_t> reference;   // grid of the last kept frame
+            std::vector<uint8_t> current;
+            std::vector<size_t> offsets;      // byte offset of each sample
+            int width = 0;
+            int height = 0;
+        };
+
+        // Mean absolute difference against the reference; samples into grid.current
+        static double score_(const CameraFrame& frame, CameraGrid& grid);
+
+        MotionGateConfig config_;
+        CameraGrid grids_[2];
+        bool active_ = true;
+        uint64_t active_until_us_ = 0;
+        uint64_t idle_count_ = 0;
+        uint64_t kept_ = 0;
+        uint64_t skipped_ = 0;
+        SkippedRun run_;
+};
@@ -0,0 +1,232 @@
+#include "output_striper.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "alloc_stats.hpp"
+#include "trace_probes.hpp"
+
+OutputStriper::Device* OutputStriper::device_for_(const std::string& path) {
+    const std::string directory = std::filesystem::path(path).parent_path().string();
+    struct stat info;
+    if (stat(directory.empty() ? "." : directory.c_str(), &info) != 0) {
+        std::cerr << "OutputStriper: can't stat " << directory << std::endl;
+        return nullptr;
+    }
+    for (auto& device : devices_) {
+        if (device->id == info.st_dev) {
+            return device.get();
+        }
+    }
+    devices_.push_back(std::make_unique<Device>());
+    Device* device = devices_.back().get();
+    device->id = info.st_dev;
+    device->label = directory;
+    return device;
+}
+
+bool OutputStriper::add_writer(VideoWriter* writer, const std::string& path, int camera, bool primary) {
+    Device* device = device_for_(path);
+    if (!device) {
+        return false;
+    }
+    device->writers.push_back({writer, camera, primary});
+    device->files.push_back(path);
+    return true;
+}
+
+bool OutputStriper::track_file(const std::string& path) {
+    Device* device = device_for_(path);
+    if (!device) {
+        return false;
+    }
+    device->files.push_back(path);
+    return true;
+}
+
+void OutputStriper::hold_rings(BroadcastRing<CameraFrame>* front_ring, int front_sync_consumer,
+                               BroadcastRing<CameraFrame>* right_ring, int right_sync_consumer) {
+    BroadcastRing<CameraFrame>* rings[2] = {front_ring, right_ring};
+    const int sync_consumers[2] = {front_sync_consumer, right_sync_consumer};
+    for (int i = 0; i < 2; i++) {
+        held_[i].ring = rings[i];
+        held_[i].sync_consumer = sync_consumers[i];
+        held_[i].hold_consumer = rings[i]->add_consumer(ConsumerPolicy::BLOCKING);
+    }
+}
+
+void OutputStriper::start() {
+    size_t devices_with_writers = 0;
+    for (const auto& device : devices_) {
+        devices_with_writers += !device->writers.empty();
+    }
+    threaded_ = devices_with_writers > 1;
+    if (!threaded_) {
+        return;
+    }
+    queue_.assign(OUTPUT_QUEUE_BUNDLES, Bundle{});
+    submitted_ = 0;
+    released_ = 0;
+    stopping_ = false;
+    for (auto& device : devices_) {
+        if (!device->writers.empty()) {
+            device->completed = 0;
+            device->thread = std::thread(&OutputStriper::device_thread_func_, this, std::ref(*device));
+        }
+    }
+    std::cout << "OutputStriper: " << devices_with_writers << " output devices, one I/O thread and a "
+              << OUTPUT_QUEUE_BUNDLES << "-bundle queue each" << std::endl;
+}
+
+void OutputStriper::stop() {
+    if (!threaded_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& device : devices_) {
+        if (device->thread.joinable()) {
+            device->thread.join();
+        }
+    }
+    threaded_ = false;
+    // Every bundle is written; let go of what was retired after the last one
+    retire();
+}
+
+void OutputStriper::write_device_(Device& device, const CameraFrame* const frames[2]) {
+    for (WriterEntry& entry : device.writers) {
+        const CameraFrame& frame = *frames[entry.camera];
+        int latency_us = 0;
+        entry.writer->write_frame(frame, latency_us);
+        if (entry.primary) {
+            latency_us_[entry.camera].store(latency_us, std::memory_order_relaxed);
+            ROBODAQ_PROBE(frame_written, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+        }
+    }
+}
+
+void OutputStriper::device_thread_func_(Device& device) {
+    ROBODAQ_ALLOC_THREAD_NAME("io");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this, &device]() { return stopping_ || device.completed < submitted_; });
+        if (device.completed == submitted_) {
+            return;  // stopping, nothing queued
+        }
+        // Not overwritten until every device, this one included, is past it
+        const Bundle& bundle = queue_[device.completed % queue_.size()];
+        lock.unlock();
+        write_device_(device, bundle.frames);
+        lock.lock();
+        device.completed++;
+        release_written_();
+    }
+}
+
+void OutputStriper::release_written_() {
+    uint64_t written = submitted_;
+    for (const auto& device : devices_) {
+        if (!device->writers.empty()) {
+            written = std::min(written, device->completed);
+        }
+    }
+    if (written == released_) {
+        return;
+    }
+    for (; released_ < written; released_++) {
+        release_rings_(queue_[released_ % queue_.size()].release_until);
+    }
+    space_cv_.notify_all();
+}
+
+void OutputStriper::release_rings_(const uint64_t release_until[2]) {
+    for (int i = 0; i < 2; i++) {
+        if (held_[i].ring && release_until[i] > 0) {
+            held_[i].ring->release_until(held_[i].hold_consumer, release_until[i]);
+        }
+    }
+}
+
+void OutputStriper::write_bundle(
+    const CameraFrame& front, const CameraFrame& right, int& front_latency_us, int& right_latency_us
+) {
+    if (!threaded_) {
+        const CameraFrame* const frames[2] = {&front, &right};
+        for (auto& device : devices_) {
+            write_device_(*device, frames);
+        }
+    } else {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // The slowest device is a full queue behind
+        space_cv_.wait(lock, [this]() { return submitted_ - released_ < queue_.size(); });
+        queue_[submitted_ % queue_.size()] = Bundle{{&front, &right}, {0, 0}};
+        submitted_++;
+        work_cv_.notify_all();
+        if (!held_[0].ring) {
+            // Nothing keeps the frames once the caller releases them
+            space_cv_.wait(lock, [this]() { return released_ == submitted_; });
+        }
+    }
+    front_latency_us = latency_us_[0].load(std::memory_order_relaxed);
+    right_latency_us = latency_us_[1].load(std::memory_order_relaxed);
+}
+
+void OutputStriper::retire() {
+    if (!held_[0].ring) {
+        return;
+    }
+    const uint64_t cursors[2] = {
+        held_[0].ring->cursor(held_[0].sync_consumer), held_[1].ring->cursor(held_[1].sync_consumer)
+    };
+    if (!threaded_) {
+        release_rings_(cursors);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (released_ == submitted_) {
+        release_rings_(cursors);
+    } else {
+        // Released along with the newest queued bundle
+        Bundle& newest = queue_[(submitted_ - 1) % queue_.size()];
+        newest.release_until[0] = cursors[0];
+        newest.release_until[1] = cursors[1];
+    }
+}
+
+std::vector<StorageDeviceStats> OutputStriper::stats() const {
+    std::vector<StorageDeviceStats> stats;
+    for (const auto& device : devices_) {
+        StorageDeviceStats entry{device->label, static_cast<uint64_t>(device->id), 0, device->files.size()};
+        for (const std::string& file : device->files) {
+            std::error_code error;
+            const uint64_t size = std::filesystem::file_size(file, error);
+            entry.bytes += error ? 0 : size;
+        }
+        stats.push_back(entry);
+    }
+    return stats;
+}
+
+std::string OutputStriper::to_json() const {
+    const std::vector<StorageDeviceStats> device_stats = stats();
+    std::ostringstream json;
+    json << "{";
+    for (size_t i = 0; i < devices_.size(); i++) {
+        json << (i ? ", " : "") << "\"" << devices_[i]->label << "\": {"
+             << "\"device_id\": " << device_stats[i].device_id
+             << ", \"bytes\": " << device_stats[i].bytes
+             << ", \"files\": [";
+        for (size_t f = 0; f < devices_[i]->files.size(); f++) {
+            json << (f ? ", " : "") << "\"" << devices_[i]->files[f] << "\"";
+        }
+        json << "]}";
+    }
+    json << "}";
+    return json.str();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+#include "broadcast_ring.hpp"
+#include "video_writer.hpp"
+
+struct StorageDeviceStats {
+    std::string label;      // directory of the first file placed on the device
+    uint64_t device_id;     // st_dev
+    uint64_t bytes;         // current size of every file on it
+    size_t files;
+};
+
+// Bundles a device may be behind the sync thread before write_bundle() waits for it
+constexpr size_t OUTPUT_QUEUE_BUNDLES = 8;
+
+/*
+    Spreads the session's video writers over the storage devices their files
+    live on (grouped by st_dev), with one I/O thread per device. Each device
+    has its own bounded queue of bundles (up to OUTPUT_QUEUE_BUNDLES behind
+    the sync thread) and drains it at its own pace, so a slow disk delays
+    only its own files. Only once it is a full queue behind does
+    write_bundle() wait for it. With a single device everything is
+    written on the caller's thread as before.
+
+    Queued frames are read in place from the camera rings. hold_rings()
+    adds a blocking consumer to each ring that keeps those slots from being
+    overwritten. It releases a bundle's slots, and the frames the sync
+    thread dropped before it, when the last device has written the bundle.
+    Without held rings, write_bundle() waits for every device (lockstep).
+
+    Log files written elsewhere can be tracked so they show up in the
+    per-device byte counts.
+*/
+class OutputStriper {
+    public:
+        OutputStriper() = default;
+        ~OutputStriper() { stop(); }
+
+        OutputStriper(const OutputStriper&) = delete;
+        OutputStriper& operator=(const OutputStriper&) = delete;
+
+        // `writer` writes `path` and is fed camera `camera` (0 = front, 1 = right).
+        // The latency of `primary` writers is what write_bundle() reports.
+        bool add_writer(VideoWriter* writer, const std::string& path, int camera, bool primary);
+        bool track_file(const std::string& path);
+
+        // Keeps the slots of queued frames; call before anything is published
+        // to the rings. `*_sync_consumer` is the consumer the frames are
+        // read with (see retire()).
+        void hold_rings(BroadcastRing<CameraFrame>* front_ring, int front_sync_consumer,
+                        BroadcastRing<CameraFrame>* right_ring, int right_sync_consumer);
+
+        // Threads only when the writers span more than one device. stop()
+        // writes whatever is still queued first.
+        void start();
+        void stop();
+
+        // Queues both frames on every device (see above). The latencies are
+        // those of the primary writers' most recently written frames.
+        void write_bundle(const CameraFrame& front, const CameraFrame& right, int& front_latency_us, int& right_latency_us);
+
+        // Call after the sync consumers released frames: everything they
+        // released is let go once the bundles queued so far are written
+        void retire();
+
+        std::vector<StorageDeviceStats> stats() const;
+        // {"<label>": {"device_id": .., "bytes": .., "files": [..]}, ...}
+        std::string to_json() const;
+        size_t num_devices() const { return devices_.size(); }
+
+    private:
+        struct WriterEntry {
+            VideoWriter* writer;
+            int camera;
+            bool primary;
+        };
+
+        struct Device {
+            dev_t id = 0;
+            std::string label;
+            std::vector<WriterEntry> writers;
+            std::vector<std::string> files;
+
+            std::thread thread;
+            uint64_t completed = 0;     // bundles written; guarded by mutex_
+        };
+
+        struct Bundle {
+            const CameraFrame* frames[2];
+            uint64_t release_until[2];  // ring sequences to release once written, 0 = none
+        };
+
+        struct HeldRing {
+            BroadcastRing<CameraFrame>* ring = nullptr;
+            int sync_consumer = -1;
+            int hold_consumer = -1;
+        };
+
+        Device* device_for_(const std::string& path);
+        void write_device_(Device& device, const CameraFrame* const frames[2]);
+        void device_thread_func_(Device& device);
+        // With mutex_ held: releases the slots of bundles every device has written
+        void release_written_();
+        void release_rings_(const uint64_t release_until[2]);
+
+        std::vector<std::unique_ptr<Device>> devices_;
+        HeldRing held_[2];
+        std::atomic<int> latency_us_[2] = {{0}, {0}};
+        bool threaded_ = false;
+
+        // Bundle queue shared by the device threads; bundle n is queue_[n % size]
+        std::mutex mutex_;
+        std::condition_variable work_cv_;   // device threads: new bundle or stopping
+        std::condition_variable space_cv_;  // write_bundle(): a bundle was released
+        std::vector<Bundle> queue_;
+        uint64_t submitted_ = 0;
+        uint64_t released_ = 0;
+        bool stopping_ = false;
+};
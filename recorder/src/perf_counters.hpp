@@ -0,0 +1,255 @@
+/*
+Goal: let the benches explain their numbers. Ops/sec alone can't tell false
+sharing from cache misses or branch mispredicts; hardware counters around the
+measured region can.
+
+Thin perf_event_open wrapper, one counter per event:
+    cycles, instructions, L1D read misses, LLC misses, branch misses,
+    context switches
+Counting is per thread: each measured thread creates a ThreadScope, which
+opens counters on that thread only and, when it goes out of scope, disables
+them, reads them and adds them to the PerfCounters totals. That happens
+before the thread can be joined, so once the region's threads are joined the
+totals are final, with nothing to wait for and no counts from the joining
+thread.
+
+Hardware events count user space only (exclude_kernel), which works at
+perf_event_paranoid <= 2. Context switches happen in the kernel, so that
+software event counts kernel mode; where that isn't permitted it just reads
+as unavailable. Values are scaled for multiplexing.
+
+Each event falls back on its own: in a VM or a locked-down container some or
+all of them fail to open, and those read as unavailable (null in JSON)
+instead of failing the bench.
+
+Usage:
+    PerfCounters counters;
+    counters.open();          // false if nothing is countable; see error()
+    counters.reset();
+    std::thread worker([&]() {
+        PerfCounters::ThreadScope scope(counters);
+        ... work ...
+    });
+    worker.join();
+    json << counters.json_fields(ops);   // ,"cycles_per_op":..., ...
+*/
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum class PerfEvent {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    CONTEXT_SWITCHES,
+    NUM_EVENTS
+};
+
+constexpr int NUM_PERF_EVENTS = static_cast<int>(PerfEvent::NUM_EVENTS);
+
+struct PerfReading {
+    bool available[NUM_PERF_EVENTS] = {};
+    double values[NUM_PERF_EVENTS] = {};
+
+    bool has(PerfEvent event) const { return available[static_cast<int>(event)]; }
+    double get(PerfEvent event) const { return values[static_cast<int>(event)]; }
+};
+
+class PerfCounters {
+    public:
+        // Counts the thread it is created on until it is destroyed, then
+        // adds the counts to the totals. Thread-safe across threads.
+        class ThreadScope {
+            public:
+                explicit ThreadScope(PerfCounters& counters);
+                ~ThreadScope();
+
+                ThreadScope(const ThreadScope&) = delete;
+                ThreadScope& operator=(const ThreadScope&) = delete;
+
+            private:
+                PerfCounters& counters_;
+                int fds_[NUM_PERF_EVENTS];
+        };
+
+        PerfCounters() = default;
+
+        // Checks which events can be opened on this machine. Returns false if none.
+        bool open();
+        bool available() const;
+        // Why the first unavailable event failed, e.g. "perf_event_open: Permission denied"
+        const std::string& error() const { return error_; }
+
+        // Zeroes the totals before a region
+        void reset();
+
+        // Sum over the ThreadScopes since reset()
+        PerfReading read() const;
+
+        // JSON fields (each preceded by a comma) with per-op values, null where unavailable:
+        // cycles_per_op, instructions_per_op, ipc, l1d_misses_per_op,
+        // llc_misses_per_op, branch_misses_per_op, context_switches
+        std::string json_fields(uint64_t ops) const;
+
+    private:
+        static int open_event(PerfEvent event);
+
+        bool openable_[NUM_PERF_EVENTS] = {};
+        std::string error_;
+        mutable std::mutex mutex_;
+        PerfReading totals_;
+};
+
+inline int PerfCounters::open_event(PerfEvent event) {
+    struct EventSpec {
+        uint32_t type;
+        uint64_t config;
+    };
+    static const EventSpec specs[NUM_PERF_EVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+    const EventSpec& spec = specs[static_cast<int>(event)];
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = 1;
+    // A context switch is counted in kernel mode; excluding it reads 0
+    attr.exclude_kernel = spec.type == PERF_TYPE_SOFTWARE ? 0 : 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // The calling thread only, on any CPU
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+inline bool PerfCounters::open() {
+    error_.clear();
+    for (int i = 0; i < NUM_PERF_EVENTS; i++) {
+        const int fd = open_event(static_cast<PerfEvent>(i));
+        openable_[i] = fd >= 0;
+        if (fd >= 0) {
+            ::close(fd);
+        } else if (error_.empty()) {
+            error_ = std::string("perf_event_open: ") + std::strerror(errno);
+        }
+    }
+    return available();
+}
+
+inline bool PerfCounters::available() const {
+    for (bool openable : openable_) {
+        if (openable) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void PerfCounters::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    totals_ = PerfReading();
+}
+
+inline PerfReading PerfCounters::read() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totals_;
+}
+
+inline PerfCounters::ThreadScope::ThreadScope(PerfCounters& counters) : counters_(counters) {
+    for (int i = 0; i < NUM_PERF_EVENTS; i++) {
+        fds_[i] = counters_.openable_[i] ? open_event(static_cast<PerfEvent>(i)) : -1;
+    }
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+inline PerfCounters::ThreadScope::~ThreadScope() {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    PerfReading reading;
+    for (int i = 0; i < NUM_PERF_EVENTS; i++) {
+        uint64_t data[3];  // value, time enabled, time running
+        if (fds_[i] < 0 || ::read(fds_[i], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        if (data[2] == 0) {
+            // Never scheduled onto the PMU (too many events for the counters)
+            continue;
+        }
+        reading.available[i] = true;
+        reading.values[i] = data[2] < data[1]
+            ? static_cast<double>(data[0]) * data[1] / data[2]
+            : static_cast<double>(data[0]);
+    }
+    for (int& fd : fds_) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    std::lock_guard<std::mutex> lock(counters_.mutex_);
+    for (int i = 0; i < NUM_PERF_EVENTS; i++) {
+        if (reading.available[i]) {
+            counters_.totals_.available[i] = true;
+            counters_.totals_.values[i] += reading.values[i];
+        }
+    }
+}
+
+inline std::string PerfCounters::json_fields(uint64_t ops) const {
+    const PerfReading reading = read();
+    std::ostringstream json;
+    auto per_op = [&](const char* name, PerfEvent event) {
+        json << ",\"" << name << "\":";
+        if (reading.has(event) && ops > 0) {
+            json << reading.get(event) / ops;
+        } else {
+            json << "null";
+        }
+    };
+    per_op("cycles_per_op", PerfEvent::CYCLES);
+    per_op("instructions_per_op", PerfEvent::INSTRUCTIONS);
+    json << ",\"ipc\":";
+    if (reading.has(PerfEvent::CYCLES) && reading.has(PerfEvent::INSTRUCTIONS) && reading.get(PerfEvent::CYCLES) > 0) {
+        json << reading.get(PerfEvent::INSTRUCTIONS) / reading.get(PerfEvent::CYCLES);
+    } else {
+        json << "null";
+    }
+    per_op("l1d_misses_per_op", PerfEvent::L1D_MISSES);
+    per_op("llc_misses_per_op", PerfEvent::LLC_MISSES);
+    per_op("branch_misses_per_op", PerfEvent::BRANCH_MISSES);
+    json << ",\"context_switches\":";
+    if (reading.has(PerfEvent::CONTEXT_SWITCHES)) {
+        json << static_cast<uint64_t>(reading.get(PerfEvent::CONTEXT_SWITCHES));
+    } else {
+        json << "null";
+    }
+    return json.str();
+}
@@ -1,5 +1,8 @@
 #include "performance_monitor.hpp"
 
+#include "alloc_stats.hpp"
+#include "trace_probes.hpp"
+
 bool PerformanceMonitor::initialize(const std::string& output_dir) {
     output_dir_ = output_dir;
     events_output_path_ = output_dir + "/events.jsonl";
@@ -14,31 +17,59 @@ bool PerformanceMonitor::initialize(const std::string& output_dir) {
     return true;
 }
 
-void PerformanceMonitor::tick(
-    const std::unordered_map<std::string, FrameData>& frame_data_by_device
-) {
+void PerformanceMonitor::tick(std::initializer_list<DeviceFrameData> frames) {
+    ROBODAQ_ALLOC_STAGE(AllocStage::MONITOR);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
     num_frames_++;
     
-    for (const auto& pair : frame_data_by_device) {
-        const std::string& device_name = pair.first;
-        const FrameData& frame_data = pair.second;
+    for (const DeviceFrameData& frame : frames) {
+        const std::string& device_name = *frame.device_name;
+        const FrameData& frame_data = frame.frame_data;
 
         // Update rolling average latency
         update_latency_average_(device_name, frame_data.latency_us);
-        
-        // Check gap in sequence number
-        if (last_seq_num_by_device_.find(device_name) != last_seq_num_by_device_.end()) {
-            uint64_t last_seq_num = last_seq_num_by_device_[device_name];
-            uint64_t gap = frame_data.sequence_number - last_seq_num;
-            if (gap > 1) {
-                log_sequence_gap_event_(device_name, frame_data, gap - 1);
-                seq_gap_count_by_device_[device_name]++;
-            }
+        check_sequence_(device_name, frame_data);
+    }
+}
+
+void PerformanceMonitor::tick_skipped(std::initializer_list<DeviceFrameData> frames) {
+    ROBODAQ_ALLOC_STAGE(AllocStage::MONITOR);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    num_skipped_++;
+    for (const DeviceFrameData& frame : frames) {
+        check_sequence_(*frame.device_name, frame.frame_data);
+    }
+}
+
+void PerformanceMonitor::tick_unmatched(const DeviceFrameData& frame, const char* event_type) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        check_sequence_(*frame.device_name, frame.frame_data);
+    }
+    std::ostringstream json_line;
+    json_line << "{"
+              << "\"timestamp_us\":" << frame.frame_data.timestamp_us << ","
+              << "\"event_type\":\"" << event_type << "\","
+              << "\"device_name\":\"" << *frame.device_name << "\","
+              << "\"sequence_number\":" << frame.frame_data.sequence_number
+              << "}";
+    log_event(json_line.str());
+}
+
+void PerformanceMonitor::check_sequence_(const std::string& device_name, const FrameData& frame_data) {
+    // Check gap in sequence number
+    if (last_seq_num_by_device_.find(device_name) != last_seq_num_by_device_.end()) {
+        uint64_t last_seq_num = last_seq_num_by_device_[device_name];
+        uint64_t gap = frame_data.sequence_number - last_seq_num;
+        if (gap > 1) {
+            log_sequence_gap_event_(device_name, frame_data, gap - 1);
+            seq_gap_count_by_device_[device_name]++;
+            missing_frames_by_device_[device_name] += gap - 1;
         }
-        
-        // Update last sequence number
-        last_seq_num_by_device_[device_name] = frame_data.sequence_number;
     }
+    
+    // Update last sequence number
+    last_seq_num_by_device_[device_name] = frame_data.sequence_number;
 }
 
 void PerformanceMonitor::log_sequence_gap_event_(
@@ -46,11 +77,6 @@ void PerformanceMonitor::log_sequence_gap_event_(
     const FrameData& frame_data,
     uint64_t gap
 ) {
-    if (!events_file_.is_open()) {
-        std::cerr << "PerformanceMonitor events file not initialized" << std::endl;
-        return;
-    }
-    
     // Create JSON line
     std::ostringstream json_line;
     json_line << "{"
@@ -59,15 +85,26 @@ void PerformanceMonitor::log_sequence_gap_event_(
               << "\"device_name\":\"" << device_name << "\","
               << "\"sequence_number\":" << frame_data.sequence_number << ","
               << "\"gap_size\":" << gap
-              << "}" << std::endl;
+              << "}";
     
-    events_file_ << json_line.str();
-    events_file_.flush();  // Ensure data is written immediately
+    log_event(json_line.str());
 
     std::cout << "SEQ GAP: " << device_name << " ts=" << frame_data.timestamp_us << " seq=" << frame_data.sequence_number 
               << " gap=" << gap << std::endl;
 }
 
+void PerformanceMonitor::log_event(const std::string& json_object) {
+    ROBODAQ_ALLOC_STAGE(AllocStage::LOG);
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    if (!events_file_.is_open()) {
+        std::cerr << "PerformanceMonitor events file not initialized" << std::endl;
+        return;
+    }
+    events_file_ << json_object << "\n";
+    events_file_.flush();  // Ensure data is written immediately
+    ROBODAQ_PROBE(log_flush, "events", json_object.size() + 1);
+}
+
 void PerformanceMonitor::update_latency_average_(const std::string& device_name, int latency_us) {
     if (mean_latency_by_device_.find(device_name) == mean_latency_by_device_.end()) {
         // First sample for this device
@@ -82,8 +119,12 @@ void PerformanceMonitor::update_latency_average_(const std::string& device_name,
 }
 
 void PerformanceMonitor::report() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
     std::cout << "\n=== Performance Report ===" << std::endl;
     std::cout << "Total frames processed: " << num_frames_ << std::endl;
+    if (num_skipped_ > 0) {
+        std::cout << "Idle bundles skipped by the motion gate: " << num_skipped_ << std::endl;
+    }
     
     // Print mean latency by device
     std::cout << "\nMean Latency by Device:" << std::endl;
@@ -96,7 +137,30 @@ void PerformanceMonitor::report() {
     // Print sequence gaps by device
     std::cout << "\nSequence Gaps by Device:" << std::endl;
     for (const auto& pair : seq_gap_count_by_device_) {
-        std::cout << "  " << pair.first << ": " << pair.second << " gaps" << std::endl;
+        std::cout << "  " << pair.first << ": " << pair.second << " gaps, "
+                  << missing_frames_by_device_[pair.first] << " frames missing" << std::endl;
+    }
+    
+    if (!pipeline_health_by_device_.empty()) {
+        std::cout << "\nPipeline Health by Device:" << std::endl;
+        for (const auto& pair : pipeline_health_by_device_) {
+            const PipelineHealth& h = pair.second;
+            std::cout << "  " << pair.first << ": " << h.errors << " errors, " << h.warnings << " warnings, "
+                      << h.queue_overruns << " queue overruns, " << h.qos_dropped << " QoS drops, "
+                      << h.stalls << " stalls, latency " << h.latency_min_ns / 1000 << " us"
+                      << (h.eos ? ", EOS" : "") << std::endl;
+        }
+    }
+    
+    if (!storage_by_device_.empty()) {
+        std::cout << "\nOutput Storage by Device:" << std::endl;
+        for (const auto& pair : storage_by_device_) {
+            const StorageRate& s = pair.second;
+            const double seconds = (s.timestamp_us - s.first_timestamp_us) / 1e6;
+            std::cout << "  " << pair.first << ": " << std::fixed << std::setprecision(1) << s.bytes / 1e6 << " MB, "
+                      << (seconds > 0 ? s.bytes / 1e6 / seconds : 0.0) << " MB/s mean, "
+                      << s.peak_mb_per_s << " MB/s peak" << std::endl;
+        }
     }
     
     // Write metrics to JSON file
@@ -105,6 +169,7 @@ void PerformanceMonitor::report() {
     if (metrics_file.is_open()) {
         metrics_file << "{" << std::endl;
         metrics_file << "  \"total_frames\": " << num_frames_ << "," << std::endl;
+        metrics_file << "  \"skipped_bundles\": " << num_skipped_ << "," << std::endl;
         metrics_file << "  \"mean_latency_by_device\": {" << std::endl;
         
         bool first_latency = true;
@@ -124,6 +189,51 @@ void PerformanceMonitor::report() {
             metrics_file << "    \"" << pair.first << "\": " << pair.second;
             first_gap = false;
         }
+        metrics_file << std::endl << "  }," << std::endl;
+
+        metrics_file << "  \"missing_frames_by_device\": {" << std::endl;
+        bool first_missing = true;
+        for (const auto& pair : missing_frames_by_device_) {
+            if (!first_missing) metrics_file << "," << std::endl;
+            metrics_file << "    \"" << pair.first << "\": " << pair.second;
+            first_missing = false;
+        }
+        metrics_file << std::endl << "  }," << std::endl;
+
+        metrics_file << "  \"pipeline_health_by_device\": {" << std::endl;
+        bool first_health = true;
+        for (const auto& pair : pipeline_health_by_device_) {
+            const PipelineHealth& h = pair.second;
+            if (!first_health) metrics_file << "," << std::endl;
+            metrics_file << "    \"" << pair.first << "\": {"
+                        << "\"errors\": " << h.errors
+                        << ", \"warnings\": " << h.warnings
+                        << ", \"eos\": " << (h.eos ? "true" : "false")
+                        << ", \"qos_messages\": " << h.qos_messages
+                        << ", \"qos_processed\": " << h.qos_processed
+                        << ", \"qos_dropped\": " << h.qos_dropped
+                        << ", \"queue_overruns\": " << h.queue_overruns
+                        << ", \"stalls\": " << h.stalls
+                        << ", \"live\": " << (h.live ? "true" : "false")
+                        << ", \"latency_min_ns\": " << h.latency_min_ns
+                        << ", \"latency_max_ns\": " << h.latency_max_ns << "}";
+            first_health = false;
+        }
+        metrics_file << std::endl << "  }," << std::endl;
+
+        metrics_file << "  \"storage_by_device\": {" << std::endl;
+        bool first_storage = true;
+        for (const auto& pair : storage_by_device_) {
+            const StorageRate& s = pair.second;
+            const double seconds = (s.timestamp_us - s.first_timestamp_us) / 1e6;
+            if (!first_storage) metrics_file << "," << std::endl;
+            metrics_file << "    \"" << pair.first << "\": {"
+                        << "\"device_id\": " << s.device_id
+                        << ", \"bytes\": " << s.bytes
+                        << ", \"mean_mb_per_s\": " << std::fixed << std::setprecision(2) << (seconds > 0 ? s.bytes / 1e6 / seconds : 0.0)
+                        << ", \"peak_mb_per_s\": " << s.peak_mb_per_s << "}";
+            first_storage = false;
+        }
         metrics_file << std::endl << "  }" << std::endl;
         metrics_file << "}" << std::endl;
         
@@ -137,6 +247,7 @@ void PerformanceMonitor::report() {
 }
 
 void PerformanceMonitor::print_live_metrics() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
     std::cout << "\r[LIVE] Frames: " << num_frames_;
     
     if (!mean_latency_by_device_.empty()) {
@@ -160,5 +271,78 @@ void PerformanceMonitor::print_live_metrics() const {
         }
     }
     
+    if (storage_by_device_.size() > 1) {
+        std::cout << " | Disk MB/s: ";
+        bool first = true;
+        for (const auto& pair : storage_by_device_) {
+            if (!first) std::cout << ", ";
+            std::cout << std::fixed << std::setprecision(1) << pair.second.current_mb_per_s;
+            first = false;
+        }
+    }
+
+    for (const auto& pair : pipeline_health_by_device_) {
+        const PipelineHealth& h = pair.second;
+        if (h.errors || h.queue_overruns || h.qos_dropped) {
+            std::cout << " | " << pair.first.substr(pair.first.find_last_of('/') + 1)
+                      << " gst err:" << h.errors << " overrun:" << h.queue_overruns << " qos drop:" << h.qos_dropped;
+        }
+    }
+    
     std::cout << std::flush;
 }
+
+void PerformanceMonitor::update_storage(const std::string& label, uint64_t device_id, uint64_t bytes, uint64_t timestamp_us) {
+    StorageRate& rate = storage_by_device_[label];
+    if (rate.first_timestamp_us == 0) {
+        rate.first_timestamp_us = timestamp_us;
+    } else if (timestamp_us > rate.timestamp_us) {
+        const uint64_t written = bytes > rate.bytes ? bytes - rate.bytes : 0;
+        rate.current_mb_per_s = written / 1e6 / ((timestamp_us - rate.timestamp_us) / 1e6);
+        rate.peak_mb_per_s = std::max(rate.peak_mb_per_s, rate.current_mb_per_s);
+    }
+    rate.device_id = device_id;
+    rate.bytes = bytes;
+    rate.timestamp_us = timestamp_us;
+}
+
+void PerformanceMonitor::update_pipeline_health(const std::string& device_name, const PipelineHealth& health) {
+    pipeline_health_by_device_[device_name] = health;
+}
+
+MonitorSnapshot PerformanceMonitor::snapshot(const std::string& front_device, const std::string& right_device) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    MonitorSnapshot snapshot;
+    snapshot.num_frames = num_frames_;
+    snapshot.num_skipped = num_skipped_;
+    const std::string* devices[2] = {&front_device, &right_device};
+    for (int i = 0; i < 2; i++) {
+        auto gaps = seq_gap_count_by_device_.find(*devices[i]);
+        snapshot.seq_gaps[i] = gaps == seq_gap_count_by_device_.end() ? 0 : gaps->second;
+        auto latency = mean_latency_by_device_.find(*devices[i]);
+        snapshot.mean_latency_us[i] = latency == mean_latency_by_device_.end() ? 0.0 : latency->second;
+    }
+    return snapshot;
+}
+
+int PerformanceMonitor::num_frames() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return num_frames_;
+}
+
+int PerformanceMonitor::num_skipped() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return num_skipped_;
+}
+
+double PerformanceMonitor::mean_latency_us(const std::string& device_name) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto it = mean_latency_by_device_.find(device_name);
+    return it == mean_latency_by_device_.end() ? 0.0 : it->second;
+}
+
+int PerformanceMonitor::seq_gap_count(const std::string& device_name) const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    auto it = seq_gap_count_by_device_.find(device_name);
+    return it == seq_gap_count_by_device_.end() ? 0 : it->second;
+}
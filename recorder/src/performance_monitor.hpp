@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <string>
 #include <iostream>
@@ -7,6 +8,10 @@
 #include <sstream>
 #include <chrono>
 #include <iomanip>
+#include <initializer_list>
+#include <mutex>
+
+#include "pipeline_health.hpp"
 
 struct FrameData {
     uint64_t timestamp_us;
@@ -14,16 +19,52 @@ struct FrameData {
     int latency_us;
 };
 
+// One camera's frame of a bundle. Points at the frame's own device name so
+// ticking doesn't build a map or copy strings per bundle.
+struct DeviceFrameData {
+    const std::string* device_name;
+    FrameData frame_data;
+};
+
+// Per-bundle stats copied out under one lock; [0] = front, [1] = right
+struct MonitorSnapshot {
+    int num_frames = 0;
+    int num_skipped = 0;
+    int seq_gaps[2] = {0, 0};
+    double mean_latency_us[2] = {0, 0};
+};
+
 class PerformanceMonitor {
 private:
+    // Guards the per-bundle stats below (through num_skipped_): tick() runs
+    // on the sync thread while the main thread reads them for the flight
+    // recorder, the status mailbox and the live line
+    mutable std::mutex stats_mutex_;
     std::unordered_map<std::string, uint64_t> last_seq_num_by_device_;
     std::unordered_map<std::string, double> mean_latency_by_device_;
     std::unordered_map<std::string, int> latency_sample_count_by_device_;
     std::unordered_map<std::string, int> seq_gap_count_by_device_;
+    // Frames missing across all gaps; a gap of 500 frames counts 500 here, 1 above
+    std::unordered_map<std::string, uint64_t> missing_frames_by_device_;
+    std::unordered_map<std::string, PipelineHealth> pipeline_health_by_device_;
+
+    // Write bandwidth per output device (OutputStriper), from file sizes
+    struct StorageRate {
+        uint64_t device_id = 0;
+        uint64_t bytes = 0;
+        uint64_t timestamp_us = 0;
+        uint64_t first_timestamp_us = 0;
+        double current_mb_per_s = 0;
+        double peak_mb_per_s = 0;
+    };
+    std::unordered_map<std::string, StorageRate> storage_by_device_;
     int num_frames_;
+    int num_skipped_;
     std::string events_output_path_;
     std::string output_dir_;
     std::ofstream events_file_;
+    // events.jsonl is written from the sync thread and the QC thread
+    std::mutex events_mutex_;
 
     void log_sequence_gap_event_(
         const std::string& device_name,
@@ -31,13 +72,33 @@ private:
         uint64_t gap
     );
     void update_latency_average_(const std::string& device_name, int latency_us);
+    void check_sequence_(const std::string& device_name, const FrameData& frame_data);
 
 public:
-    PerformanceMonitor() : num_frames_(0) {}
+    PerformanceMonitor() : num_frames_(0), num_skipped_(0) {}
     bool initialize(const std::string& output_dir);
-    void tick(const std::unordered_map<std::string, FrameData>& frame_data_by_device);
+    void tick(std::initializer_list<DeviceFrameData> frames);
+    // A bundle the motion gate didn't write: sequence tracking only, no latency
+    void tick_skipped(std::initializer_list<DeviceFrameData> frames);
+    // A frame the sync matcher dropped without a partner ("sync_miss" for the
+    // trigger camera, "sync_discard" for the others): logged as an event and
+    // tracked so its sequence number isn't counted as a camera drop
+    void tick_unmatched(const DeviceFrameData& frame, const char* event_type);
     void report();
+    // Appends one JSON object (no trailing newline) to events.jsonl. Thread-safe.
+    void log_event(const std::string& json_object);
     void print_live_metrics() const;
-    
+    // Latest bus/queue health of a camera pipeline. Same thread as report() and print_live_metrics().
+    void update_pipeline_health(const std::string& device_name, const PipelineHealth& health);
+    // Bytes on one output device so far; rates come from successive calls. Same thread as report().
+    void update_storage(const std::string& label, uint64_t device_id, uint64_t bytes, uint64_t timestamp_us);
+
+    // Safe to call from any thread
+    MonitorSnapshot snapshot(const std::string& front_device, const std::string& right_device) const;
+    int num_frames() const;
+    int num_skipped() const;
+    double mean_latency_us(const std::string& device_name) const;
+    int seq_gap_count(const std::string& device_name) const;
+
 };
 
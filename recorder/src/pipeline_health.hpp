@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+/*
+    Health of one camera's GStreamer pipeline, as seen from its bus and its
+    leaky queue. Filled by CameraPipeline's bus thread, shown by
+    PerformanceMonitor (live metrics, report, metrics.json).
+*/
+struct PipelineHealth {
+    uint64_t errors = 0;            // GST_MESSAGE_ERROR (e.g. v4l2src lost the device)
+    uint64_t warnings = 0;
+    bool eos = false;               // end of stream: the source is gone
+    uint64_t qos_messages = 0;
+    uint64_t qos_processed = 0;     // buffers, from the latest QoS message
+    uint64_t qos_dropped = 0;
+    uint64_t queue_overruns = 0;    // leaky queue full; one buffer dropped each
+    bool live = false;              // from the latest latency query
+    uint64_t latency_min_ns = 0;
+    uint64_t latency_max_ns = 0;    // 0 = unbounded
+    uint64_t stalls = 0;            // times no frame arrived for CAMERA_STALL_US
+};
@@ -0,0 +1,461 @@
+#include "preview_tap.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+constexpr int PREVIEW_ENCODER_NICE = 10;
+constexpr int PREVIEW_MAX_CLIENTS = 8;
+constexpr int PREVIEW_POLL_TIMEOUT_MS = 200;
+constexpr const char* MJPEG_BOUNDARY = "robodaqframe";
+
+bool send_all(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool send_all(int fd, const std::string& text) {
+    return send_all(fd, text.data(), text.size());
+}
+
+// Nearest-neighbour YUYV decimation. Works on 2-pixel macropixels so chroma
+// stays paired with its luma.
+void decimate_yuyv(
+    const uint8_t* src, int src_width, int src_height,
+    uint8_t* dst, int dst_width, int dst_height
+) {
+    const int src_macropixels = src_width / 2;
+    const int dst_macropixels = dst_width / 2;
+    for (int y = 0; y < dst_height; y++) {
+        const uint8_t* src_row = src + static_cast<size_t>(y * src_height / dst_height) * src_width * 2;
+        uint8_t* dst_row = dst + static_cast<size_t>(y) * dst_width * 2;
+        for (int m = 0; m < dst_macropixels; m++) {
+            int src_m = m * src_macropixels / dst_macropixels;
+            std::memcpy(dst_row + m * 4, src_row + src_m * 4, 4);
+        }
+    }
+}
+
+} // namespace
+
+PreviewTap::PreviewTap()
+    : max_width_(PREVIEW_DEFAULT_WIDTH), max_height_(PREVIEW_DEFAULT_HEIGHT),
+      frame_interval_us_(1000000 / PREVIEW_DEFAULT_FPS), port_(PREVIEW_DEFAULT_PORT), listen_fd_(-1),
+      status_mailbox_(nullptr) {}
+
+PreviewTap::~PreviewTap() {
+    stop();
+}
+
+bool PreviewTap::initialize(
+    const std::vector<std::string>& device_names,
+    const std::vector<BroadcastRing<CameraFrame>*>& rings,
+    int port,
+    const std::string& bind_address,
+    int max_width,
+    int max_height,
+    int fps
+) {
+    if (max_width < 2 || max_height < 1 || fps <= 0) {
+        std::cerr << "PreviewTap: invalid preview size or rate" << std::endl;
+        return false;
+    }
+    if (device_names.size() != rings.size()) {
+        std::cerr << "PreviewTap: need one ring per device" << std::endl;
+        return false;
+    }
+    max_width_ = max_width;
+    max_height_ = max_height;
+    frame_interval_us_ = 1000000 / fps;
+    port_ = port;
+    bind_address_ = bind_address;
+
+    for (size_t i = 0; i < device_names.size(); i++) {
+        auto camera = std::make_unique<CameraPreview>();
+        camera->device_name = device_names[i];
+        camera->stream_name = device_names[i].substr(device_names[i].find_last_of('/') + 1);
+        camera->ring = rings[i];
+        camera->consumer = rings[i]->add_consumer(ConsumerPolicy::LOSSY);
+        cameras_.push_back(std::move(camera));
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "PreviewTap: socket() failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "PreviewTap: invalid bind address " << bind_address_ << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, PREVIEW_MAX_CLIENTS) != 0) {
+        std::cerr << "PreviewTap: cannot listen on " << bind_address_ << ":" << port_
+                  << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    std::cout << "Preview: http://" << bind_address_ << ":" << port_ << "/ ("
+              << max_width_ << "x" << max_height_ << " @ " << fps << " fps)" << std::endl;
+    return true;
+}
+
+void PreviewTap::set_status_mailbox(const LatestValueMailbox<RecorderStatus>* mailbox) {
+    status_mailbox_ = mailbox;
+}
+
+bool PreviewTap::start() {
+    if (listen_fd_ < 0) {
+        std::cerr << "PreviewTap not initialized" << std::endl;
+        return false;
+    }
+    running_.store(true);
+    encoder_thread_ = std::make_unique<std::thread>(&PreviewTap::encoder_thread_func_, this);
+    server_thread_ = std::make_unique<std::thread>(&PreviewTap::server_thread_func_, this);
+    return true;
+}
+
+void PreviewTap::stop() {
+    if (running_.exchange(false)) {
+        encoder_cv_.notify_all();
+        jpeg_cv_.notify_all();
+
+        if (encoder_thread_ && encoder_thread_->joinable()) {
+            encoder_thread_->join();
+        }
+        if (server_thread_ && server_thread_->joinable()) {
+            server_thread_->join();
+        }
+        reap_clients_(true);
+    }
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void PreviewTap::reap_clients_(bool all) {
+    std::vector<std::unique_ptr<ClientSession>> done;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (auto it = clients_.begin(); it != clients_.end();) {
+            if (all || (*it)->finished.load()) {
+                if (all) {
+                    ::shutdown((*it)->fd, SHUT_RDWR);
+                }
+                done.push_back(std::move(*it));
+                it = clients_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (auto& client : done) {
+        if (client->thread.joinable()) {
+            client->thread.join();
+        }
+        ::close(client->fd);
+    }
+}
+
+void PreviewTap::encoder_thread_func_() {
+    // Linux applies setpriority to the calling thread only
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), PREVIEW_ENCODER_NICE) != 0) {
+        std::cerr << "PreviewTap: could not lower encoder priority" << std::endl;
+    }
+
+    std::vector<uint8_t> yuyv;
+    cv::Mat bgr;
+    const std::vector<int> encode_params = {cv::IMWRITE_JPEG_QUALITY, PREVIEW_JPEG_QUALITY};
+    auto next_wake = std::chrono::steady_clock::now();
+
+    while (running_.load()) {
+        for (auto& camera : cameras_) {
+            const CameraFrame* frame = camera->ring->peek_latest(camera->consumer);
+            if (!frame) {
+                continue;
+            }
+            if (frame->sequence_number == camera->last_sequence || frame->format != CameraFormat::YUYV ||
+                frame->width < 2 || frame->height < 1 ||
+                frame->image_data.size() < static_cast<size_t>(frame->width) * frame->height * 2) {
+                camera->ring->release(camera->consumer);
+                continue;
+            }
+            camera->last_sequence = frame->sequence_number;
+
+            // Fit the preview box, keeping aspect ratio; YUYV needs an even width
+            int width = max_width_;
+            int height = static_cast<int>(static_cast<int64_t>(frame->height) * width / frame->width);
+            if (height > max_height_) {
+                height = max_height_;
+                width = static_cast<int>(static_cast<int64_t>(frame->width) * height / frame->height);
+            }
+            width = std::max(2, width & ~1);
+            height = std::max(1, height);
+
+            // Only the decimation touches the ring slot; encode works on the small copy
+            yuyv.resize(static_cast<size_t>(width) * height * 2);
+            decimate_yuyv(frame->image_data.data(), frame->width, frame->height, yuyv.data(), width, height);
+            camera->ring->release(camera->consumer);
+
+            cv::Mat yuyv_mat(height, width, CV_8UC2, yuyv.data());
+            cv::cvtColor(yuyv_mat, bgr, cv::COLOR_YUV2BGR_YUY2);
+            auto jpeg = std::make_shared<std::vector<uint8_t>>();
+            if (!cv::imencode(".jpg", bgr, *jpeg, encode_params)) {
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(jpeg_mutex_);
+                camera->jpeg = std::move(jpeg);
+                camera->jpeg_version++;
+                camera->frames_encoded++;
+            }
+            jpeg_cv_.notify_all();
+        }
+
+        next_wake += std::chrono::microseconds(frame_interval_us_);
+        auto now = std::chrono::steady_clock::now();
+        if (next_wake < now) {
+            next_wake = now;
+        }
+        std::unique_lock<std::mutex> lock(encoder_mutex_);
+        encoder_cv_.wait_until(lock, next_wake, [this]() { return !running_.load(); });
+    }
+}
+
+void PreviewTap::server_thread_func_() {
+    while (running_.load()) {
+        pollfd listen_poll = {listen_fd_, POLLIN, 0};
+        int ready = ::poll(&listen_poll, 1, PREVIEW_POLL_TIMEOUT_MS);
+        if (ready <= 0) {
+            continue;
+        }
+
+        int client_fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (client_fd < 0) {
+            continue;
+        }
+
+        reap_clients_(false);
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        if (clients_.size() >= PREVIEW_MAX_CLIENTS) {
+            send_all(client_fd, "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+            ::close(client_fd);
+            continue;
+        }
+        auto client = std::make_unique<ClientSession>();
+        client->fd = client_fd;
+        client->thread = std::thread(&PreviewTap::client_thread_func_, this, client.get());
+        clients_.push_back(std::move(client));
+        clients_served_++;
+    }
+}
+
+void PreviewTap::client_thread_func_(ClientSession* client) {
+    const int client_fd = client->fd;
+
+    // A viewer that stops reading times out instead of pinning this thread forever
+    timeval send_timeout = {1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192 && running_.load()) {
+        pollfd client_poll = {client_fd, POLLIN, 0};
+        if (::poll(&client_poll, 1, PREVIEW_POLL_TIMEOUT_MS) <= 0) {
+            continue;
+        }
+        ssize_t received = ::recv(client_fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    std::istringstream request_line(request);
+    std::string method, path;
+    request_line >> method >> path;
+    path = path.substr(0, path.find('?'));
+
+    if (method == "GET") {
+        size_t dot = path.find_last_of('.');
+        std::string stream_name = path.size() > 1 ? path.substr(1, dot == std::string::npos ? std::string::npos : dot - 1) : "";
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot);
+        CameraPreview* camera = find_stream_(stream_name);
+
+        if (path == "/" || path == "/index.html") {
+            serve_index_(client_fd);
+        } else if (path == "/status.json" && status_mailbox_) {
+            serve_status_(client_fd);
+        } else if (camera && extension == ".mjpg") {
+            serve_stream_(client_fd, *camera);
+        } else if (camera && extension == ".jpg") {
+            serve_snapshot_(client_fd, *camera);
+        } else {
+            send_all(client_fd, "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+        }
+    } else if (!method.empty()) {
+        send_all(client_fd, "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\n\r\n");
+    }
+
+    // The socket is closed when the session is reaped
+    client->finished.store(true);
+}
+
+PreviewTap::CameraPreview* PreviewTap::find_stream_(const std::string& stream_name) {
+    for (auto& camera : cameras_) {
+        if (camera->stream_name == stream_name) {
+            return camera.get();
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> PreviewTap::wait_for_jpeg_(CameraPreview& camera, uint64_t& version) {
+    std::unique_lock<std::mutex> lock(jpeg_mutex_);
+    jpeg_cv_.wait_for(lock, std::chrono::milliseconds(PREVIEW_POLL_TIMEOUT_MS), [&]() {
+        return !running_.load() || camera.jpeg_version != version;
+    });
+    if (camera.jpeg_version == version) {
+        return nullptr;
+    }
+    // Skip straight to the newest JPEG; intermediate ones are never queued
+    version = camera.jpeg_version;
+    return camera.jpeg;
+}
+
+bool PreviewTap::serve_stream_(int client_fd, CameraPreview& camera) {
+    std::ostringstream header;
+    header << "HTTP/1.0 200 OK\r\n"
+           << "Access-Control-Allow-Origin: *\r\n"
+           << "Cache-Control: no-cache, no-store\r\n"
+           << "Content-Type: multipart/x-mixed-replace; boundary=" << MJPEG_BOUNDARY << "\r\n\r\n";
+    if (!send_all(client_fd, header.str())) {
+        return false;
+    }
+
+    uint64_t version = 0;
+    while (running_.load()) {
+        auto jpeg = wait_for_jpeg_(camera, version);
+        if (!jpeg) {
+            continue;
+        }
+        std::ostringstream part;
+        part << "--" << MJPEG_BOUNDARY << "\r\n"
+             << "Content-Type: image/jpeg\r\n"
+             << "Content-Length: " << jpeg->size() << "\r\n\r\n";
+        if (!send_all(client_fd, part.str()) ||
+            !send_all(client_fd, jpeg->data(), jpeg->size()) ||
+            !send_all(client_fd, "\r\n")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PreviewTap::serve_snapshot_(int client_fd, CameraPreview& camera) {
+    std::shared_ptr<const std::vector<uint8_t>> jpeg;
+    {
+        std::lock_guard<std::mutex> lock(jpeg_mutex_);
+        jpeg = camera.jpeg;
+    }
+    if (!jpeg) {
+        return send_all(client_fd, "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+    }
+    std::ostringstream header;
+    header << "HTTP/1.0 200 OK\r\n"
+           << "Access-Control-Allow-Origin: *\r\n"
+           << "Cache-Control: no-cache, no-store\r\n"
+           << "Content-Type: image/jpeg\r\n"
+           << "Content-Length: " << jpeg->size() << "\r\n\r\n";
+    return send_all(client_fd, header.str()) && send_all(client_fd, jpeg->data(), jpeg->size());
+}
+
+bool PreviewTap::serve_index_(int client_fd) {
+    std::ostringstream body;
+    body << "<!DOCTYPE html><html><head><meta charset='utf-8'><title>robodaq preview</title></head><body>";
+    for (const auto& camera : cameras_) {
+        body << "<figure><img src='/" << camera->stream_name << ".mjpg'><figcaption>"
+             << camera->device_name << "</figcaption></figure>";
+    }
+    body << "</body></html>";
+
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Content-Type: text/html\r\n"
+             << "Content-Length: " << body.str().size() << "\r\n\r\n"
+             << body.str();
+    return send_all(client_fd, response.str());
+}
+
+bool PreviewTap::serve_status_(int client_fd) {
+    RecorderStatus status;
+    if (!status_mailbox_->read(status)) {
+        return send_all(client_fd, "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+    }
+
+    std::ostringstream body;
+    body << "{"
+         << "\"timestamp_us\":" << status.timestamp_us << ","
+         << "\"session_start_us\":" << status.session_start_us << ","
+         << "\"recording\":" << (status.recording ? "true" : "false") << ","
+         << "\"frames_recorded\":" << status.frames_recorded << ","
+         << "\"ring_drops\":" << status.ring_drops << ","
+         << "\"seq_gaps\":[" << status.seq_gaps[0] << "," << status.seq_gaps[1] << "],"
+         << "\"mean_latency_us\":[" << status.mean_latency_us[0] << "," << status.mean_latency_us[1] << "],"
+         << "\"ring_fill\":[" << status.ring_fill[0] << "," << status.ring_fill[1] << "],"
+         << "\"buffered_bytes\":" << status.buffered_bytes << ","
+         << "\"memory_budget_bytes\":" << status.memory_budget_bytes
+         << "}";
+
+    std::ostringstream response;
+    response << "HTTP/1.0 200 OK\r\n"
+             << "Access-Control-Allow-Origin: *\r\n"
+             << "Cache-Control: no-cache, no-store\r\n"
+             << "Content-Type: application/json\r\n"
+             << "Content-Length: " << body.str().size() << "\r\n\r\n"
+             << body.str();
+    return send_all(client_fd, response.str());
+}
+
+void PreviewTap::report() const {
+    std::cout << "\nPreview:" << std::endl;
+    for (const auto& camera : cameras_) {
+        std::cout << "  " << camera->stream_name << ": " << camera->frames_encoded << " frames encoded" << std::endl;
+    }
+    std::cout << "  Viewers served: " << clients_served_.load() << std::endl;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "broadcast_ring.hpp"
+#include "camera_capture_pipeline.hpp"
+#include "latest_value_mailbox.hpp"
+#include "recorder_status.hpp"
+
+// Preview defaults: frames are decimated to fit this box at this rate
+constexpr int PREVIEW_DEFAULT_WIDTH = 320;
+constexpr int PREVIEW_DEFAULT_HEIGHT = 240;
+constexpr int PREVIEW_DEFAULT_FPS = 10;
+constexpr int PREVIEW_DEFAULT_PORT = 8090;
+constexpr int PREVIEW_JPEG_QUALITY = 70;
+
+/*
+    Low-rate preview of what is being recorded, served as MJPEG over HTTP.
+
+    A low-priority encoder thread wakes every 1/fps seconds, takes the newest
+    frame of each camera from its BroadcastRing as a lossy consumer, decimates
+    it in place (nearest neighbour, YUYV -> YUYV), releases the slot and then
+    JPEG-encodes the small copy. Viewers always get the newest JPEG, so a slow
+    viewer drops preview frames instead of pushing back on capture.
+
+    Endpoints (per camera, e.g. cam_front):
+        GET /                 index with links
+        GET /cam_front.mjpg   multipart/x-mixed-replace stream
+        GET /cam_front.jpg    latest frame
+        GET /status.json      latest RecorderStatus, if a mailbox is attached
+*/
+class PreviewTap {
+private:
+    struct CameraPreview {
+        std::string device_name;
+        std::string stream_name;  // device basename, used in URLs
+
+        BroadcastRing<CameraFrame>* ring = nullptr;
+        int consumer = -1;
+        uint64_t last_sequence = 0;
+
+        // Latest JPEG, shared with viewers
+        std::shared_ptr<const std::vector<uint8_t>> jpeg;
+        uint64_t jpeg_version = 0;
+
+        uint64_t frames_encoded = 0;
+    };
+
+    std::vector<std::unique_ptr<CameraPreview>> cameras_;
+    int max_width_;
+    int max_height_;
+    uint64_t frame_interval_us_;
+    std::string bind_address_;
+    int port_;
+    int listen_fd_;
+
+    std::atomic<bool> running_{false};
+    std::unique_ptr<std::thread> encoder_thread_;
+    std::unique_ptr<std::thread> server_thread_;
+
+    // Wakes the encoder on stop, and viewers when a JPEG arrives
+    std::mutex encoder_mutex_;
+    std::condition_variable encoder_cv_;
+    std::mutex jpeg_mutex_;
+    std::condition_variable jpeg_cv_;
+
+    struct ClientSession {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> finished{false};
+    };
+
+    std::mutex clients_mutex_;
+    std::vector<std::unique_ptr<ClientSession>> clients_;
+    std::atomic<uint64_t> clients_served_{0};
+
+    const LatestValueMailbox<RecorderStatus>* status_mailbox_;
+
+    void encoder_thread_func_();
+    void server_thread_func_();
+    void client_thread_func_(ClientSession* client);
+    void reap_clients_(bool all);
+    bool serve_stream_(int client_fd, CameraPreview& camera);
+    bool serve_snapshot_(int client_fd, CameraPreview& camera);
+    bool serve_index_(int client_fd);
+    bool serve_status_(int client_fd);
+    CameraPreview* find_stream_(const std::string& stream_name);
+    std::shared_ptr<const std::vector<uint8_t>> wait_for_jpeg_(CameraPreview& camera, uint64_t& version);
+
+public:
+    PreviewTap();
+    ~PreviewTap();
+
+    // rings[i] carries device_names[i]; must be called before frames are published
+    bool initialize(
+        const std::vector<std::string>& device_names,
+        const std::vector<BroadcastRing<CameraFrame>*>& rings,
+        int port = PREVIEW_DEFAULT_PORT,
+        const std::string& bind_address = "127.0.0.1",
+        int max_width = PREVIEW_DEFAULT_WIDTH,
+        int max_height = PREVIEW_DEFAULT_HEIGHT,
+        int fps = PREVIEW_DEFAULT_FPS
+    );
+
+    // Serve /status.json from this mailbox; must outlive the tap
+    void set_status_mailbox(const LatestValueMailbox<RecorderStatus>* mailbox);
+
+    bool start();
+    void stop();
+    void report() const;
+};
@@ -1,5 +1,8 @@
 #include "recorder.hpp"
 
+#include "alloc_stats.hpp"
+#include "trace_probes.hpp"
+
 // Global variables
 std::unordered_map<std::string, std::unordered_map<std::string, int>> CAM_CONFIG = {
     {
@@ -23,51 +26,250 @@ std::unordered_map<std::string, std::unordered_map<std::string, int>> CAM_CONFIG
 // Global flag for signal handling - needs to be accessible from static signal handler
 volatile sig_atomic_t keep_running = 1;
 
+namespace {
+
+// Same clock as CameraFrame::timestamp_us
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
 // Static signal handler function
 void signal_handler(int signal) {
     keep_running = 0;
 }
 
 // Recorder constructor
-Recorder::Recorder(const std::string& output_dir) 
-    : sync_tolerance_us_(SYNC_TOLERANCE_US), output_dir_(output_dir), start_timestamp_us_(0) {
-    // Initialize ring buffers (capacity of 100 frames each)
-    front_buffer_ = std::make_unique<SPSCRingBuffer<CameraFrame>>(100);
-    right_buffer_ = std::make_unique<SPSCRingBuffer<CameraFrame>>(100);
-    
+Recorder::Recorder(const std::string& output_dir, const RecorderOptions& options) 
+    : sync_tolerance_us_(options.sync_tolerance_us),
+      sync_matcher_(options.sync_policy, options.sync_tolerance_us), output_dir_(output_dir), options_(options), 
+      start_timestamp_us_(0) {
+    // Ring buffers are sized in run(), once the camera config is final
+    front_sync_consumer_ = -1;
+    right_sync_consumer_ = -1;
+    front_frame_bytes_ = 0;
+    right_frame_bytes_ = 0;
+    queue_max_buffers_[0] = DEFAULT_QUEUE_MAX_BUFFERS;
+    queue_max_buffers_[1] = DEFAULT_QUEUE_MAX_BUFFERS;
+
     // Initialize video writers and sync logger
     front_video_writer_ = std::make_unique<VideoWriter>();
     right_video_writer_ = std::make_unique<VideoWriter>();
     sync_logger_ = std::make_unique<SyncLogger>();
     performance_monitor_ = std::make_unique<PerformanceMonitor>();
+    if (options_.motion_gate) {
+        motion_gate_ = std::make_unique<MotionGate>(options_.motion_gate_config);
+    }
+
+    if (!options_.joint_device.empty()) {
+        joint_buffer_ = std::make_unique<SPSCRingBuffer<JointState>>(JOINT_STATE_BUFFER_CAPACITY);
+        joint_reader_ = std::make_unique<JointStateReader>();
+        joint_writer_ = std::make_unique<JointStateWriter>();
+    }
+
+    if (options_.flight_recorder_enabled) {
+        std::string path = options_.flight_recorder_path.empty() 
+            ? output_dir_ + "/flight_recorder.bin" : options_.flight_recorder_path;
+        uint64_t capacity = static_cast<uint64_t>(options_.flight_recorder_minutes) * 60 
+            * FLIGHT_RECORDER_RECORDS_PER_SEC;
+        system(("mkdir -p " + output_dir_).c_str());
+
+        // Best effort: a missing flight recorder must not stop a recording
+        flight_recorder_ = std::make_unique<FlightRecorder>();
+        if (!flight_recorder_->initialize(path, capacity)) {
+            std::cerr << "Flight recorder disabled" << std::endl;
+            flight_recorder_.reset();
+        } else {
+            flight_recorder_->record_process_start();
+        }
+    }
 }
 
 // Unified camera frame callback
 void Recorder::on_camera_frame(const CameraFrame& frame, bool trigger_record) {    
-    SPSCRingBuffer<CameraFrame>* buffer = nullptr;
+    BroadcastRing<CameraFrame>* buffer = nullptr;
     if (frame.device_name == "/dev/cam_front") {
         buffer = front_buffer_.get();
     } else if (frame.device_name == "/dev/cam_right") {
         buffer = right_buffer_.get();
     }
 
-    if (buffer && !buffer->push(frame)) {
+    // One copy into the ring; sync, QC and preview all read that slot in place
+    bool pushed;
+    {
+        ROBODAQ_ALLOC_STAGE(AllocStage::RING);
+        pushed = buffer && buffer->push(frame);
+        if (pushed) {
+            ROBODAQ_COUNT_COPY(frame.image_data.size());
+        }
+    }
+    ROBODAQ_PROBE(ring_push, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us, pushed ? 1 : 0);
+    if (buffer && !pushed) {
         std::cerr << "[" << frame.device_name << "] Ring buffer full, dropping frame" << std::endl;
+        ring_drop_count_++;
+        if (flight_recorder_) {
+            flight_recorder_->record_event(
+                FlightEventCode::FRAME_DROP, frame.timestamp_us, frame.sequence_number,
+                frame.device_name.c_str() + frame.device_name.find_last_of('/') + 1
+            );
+        }
     }
 
     // Trigger recording if this is the front camera with trigger_record=true
     if (trigger_record) {
         // Set the first front camera as the start timestamp for this recording.
-        if (start_timestamp_us_ == 0) {
-            start_timestamp_us_ = frame.timestamp_us;
-        }
+        uint64_t unset = 0;
+        start_timestamp_us_.compare_exchange_strong(unset, frame.timestamp_us);
         should_tick_.store(true);
     }
 }
 
+void Recorder::drain_joint_state_() {
+    if (!joint_buffer_) {
+        return;
+    }
+    JointState sample;
+    while (joint_buffer_->pop(sample)) {
+        joint_writer_->write(sample);
+        joint_aligner_.add(sample);
+        if (flight_recorder_) {
+            flight_recorder_->record_joint_state(
+                sample.timestamp_us, sample.sequence_number, sample.position, sample.command
+            );
+        }
+    }
+}
+
+void Recorder::record_metrics_rollup_(uint64_t timestamp_us) {
+    if (!flight_recorder_ || !performance_monitor_) {
+        return;
+    }
+    // The sync thread keeps ticking the monitor; take one consistent copy
+    const MonitorSnapshot snapshot = performance_monitor_->snapshot("/dev/cam_front", "/dev/cam_right");
+    FlightMetricsPayload metrics{};
+    metrics.total_frames = snapshot.num_frames;
+    for (int i = 0; i < 2; i++) {
+        metrics.seq_gaps[i] = snapshot.seq_gaps[i];
+        metrics.mean_latency_us[i] = static_cast<float>(snapshot.mean_latency_us[i]);
+    }
+    metrics.ring_drops = ring_drop_count_.load();
+    flight_recorder_->record_metrics(timestamp_us, metrics);
+    flight_recorder_->flush();
+}
+
+bool Recorder::allocate_frame_buffers_() {
+    memory_budget_ = std::make_unique<MemoryBudget>(
+        options_.memory_budget_bytes ? options_.memory_budget_bytes : MemoryBudget::default_limit_bytes()
+    );
+
+    const char* devices[2] = {"/dev/cam_front", "/dev/cam_right"};
+    uint64_t frame_bytes[2];
+    int fps[2];
+    std::string names[2];
+    for (int i = 0; i < 2; i++) {
+        auto& cam_config = CAM_CONFIG[devices[i]];
+        frame_bytes[i] = static_cast<uint64_t>(cam_config["width"]) * cam_config["height"]
+            * camera_format_bytes_per_pixel(CAMERA_CAPTURE_FORMAT);
+        fps[i] = std::max(1, cam_config["frame_rate"]);
+        names[i] = std::string(devices[i]).substr(std::string(devices[i]).find_last_of('/') + 1);
+    }
+    front_frame_bytes_ = frame_bytes[0];
+    right_frame_bytes_ = frame_bytes[1];
+
+    // Fixed-size consumers first; only the rings can shrink to fit
+    for (int i = 0; i < 2; i++) {
+        if (!replay_) {
+            queue_max_buffers_[i] = std::max(1, static_cast<int>(std::ceil(options_.gst_queue_seconds * fps[i])));
+            if (!memory_budget_->try_reserve(names[i] + "/gst_queue", queue_max_buffers_[i] * frame_bytes[i])) {
+                return false;
+            }
+        }
+        // QC and preview read frames in place from the rings; preview keeps one decimated copy
+        if (options_.preview_port > 0 &&
+            !memory_budget_->try_reserve(names[i] + "/preview", 1ull * PREVIEW_DEFAULT_WIDTH * PREVIEW_DEFAULT_HEIGHT * 2)) {
+            return false;
+        }
+        if (!options_.frame_shm_prefix.empty() &&
+            !memory_budget_->try_reserve(names[i] + "/frame_shm", options_.frame_shm_slots * frame_bytes[i])) {
+            return false;
+        }
+    }
+
+    std::unique_ptr<BroadcastRing<CameraFrame>>* rings[2] = {&front_buffer_, &right_buffer_};
+    int* sync_consumers[2] = {&front_sync_consumer_, &right_sync_consumer_};
+    for (int i = 0; i < 2; i++) {
+        size_t wanted = ring_buffer_frames(options_.ring_buffer_seconds, fps[i]);
+        size_t minimum = ring_buffer_frames(RING_BUFFER_MIN_SECONDS, fps[i]);
+
+        // Split what's left evenly between the rings still to be sized
+        uint64_t share = memory_budget_->available_bytes() / (2 - i);
+        size_t frames = std::min(wanted, static_cast<size_t>(share / frame_bytes[i]));
+        if (frames < minimum) {
+            std::cerr << "Memory budget too small for " << names[i] << ": need at least " << minimum
+                      << " frames (" << RING_BUFFER_MIN_SECONDS << " s), " << frames << " fit. "
+                      << "Raise --memory-budget-mb or lower the resolution." << std::endl;
+            return false;
+        }
+        if (frames < wanted) {
+            std::cerr << "Warning: " << names[i] << " ring shrunk to " << frames << " frames ("
+                      << static_cast<double>(frames) / fps[i] << " s) to fit the memory budget" << std::endl;
+        }
+        if (!memory_budget_->try_reserve(names[i] + "/ring", frames * frame_bytes[i])) {
+            return false;
+        }
+        *rings[i] = std::make_unique<BroadcastRing<CameraFrame>>(frames);
+        // The sync thread feeds the video writers, so it must see every frame
+        *sync_consumers[i] = (*rings[i])->add_consumer(ConsumerPolicy::BLOCKING);
+        std::cout << names[i] << " ring: " << frames << " frames (" << std::fixed << std::setprecision(1)
+                  << static_cast<double>(frames) / fps[i] << " s, "
+                  << frames * frame_bytes[i] / (1024.0 * 1024.0) << " MB)" << std::endl;
+    }
+    return true;
+}
+
+void Recorder::publish_status_(uint64_t timestamp_us, bool recording) {
+    uint64_t buffered_bytes = front_buffer_->size() * front_frame_bytes_ + right_buffer_->size() * right_frame_bytes_;
+    memory_budget_->update_in_use(buffered_bytes);
+
+    RecorderStatus status{};
+    status.buffered_bytes = buffered_bytes;
+    status.memory_budget_bytes = memory_budget_->limit_bytes();
+    status.timestamp_us = timestamp_us;
+    status.session_start_us = start_timestamp_us_.load();
+    status.ring_drops = ring_drop_count_.load();
+    status.ring_fill[0] = static_cast<uint32_t>(front_buffer_->size());
+    status.ring_fill[1] = static_cast<uint32_t>(right_buffer_->size());
+    status.recording = recording ? 1 : 0;
+    if (performance_monitor_) {
+        const MonitorSnapshot snapshot = performance_monitor_->snapshot("/dev/cam_front", "/dev/cam_right");
+        status.frames_recorded = snapshot.num_frames;
+        for (int i = 0; i < 2; i++) {
+            status.seq_gaps[i] = snapshot.seq_gaps[i];
+            status.mean_latency_us[i] = snapshot.mean_latency_us[i];
+        }
+    }
+    status_mailbox_.publish(status);
+}
+
 // Synchronization thread function
 void Recorder::sync_thread_func() {
     const auto poll_interval = std::chrono::microseconds(100); // 10kHz polling
+    ROBODAQ_ALLOC_THREAD_NAME("sync");
+
+    SyncBundleStages stages;
+    stages.front_ring = front_buffer_.get();
+    stages.front_consumer = front_sync_consumer_;
+    stages.right_ring = right_buffer_.get();
+    stages.right_consumer = right_sync_consumer_;
+    stages.matcher = &sync_matcher_;
+    stages.striper = &output_striper_;
+    stages.motion_gate = motion_gate_.get();
+    stages.sync_logger = sync_logger_.get();
+    stages.performance_monitor = performance_monitor_.get();
+    stages.flight_recorder = flight_recorder_.get();
+    stages.joint_aligner = joint_buffer_ ? &joint_aligner_ : nullptr;
     
     while (keep_running) {
         if (!should_tick_.load()) {
@@ -75,70 +277,57 @@ void Recorder::sync_thread_func() {
             continue;
         }
         should_tick_.store(false);
+        ROBODAQ_ALLOC_STAGE(AllocStage::SYNC);
         
-        CameraFrame front_frame;
-        CameraFrame right_frame;
+        // Joint samples keep flowing even if there's no frame to sync this tick
+        drain_joint_state_();
 
-        // Try to get front frame
-        if (!front_buffer_ || !front_buffer_->pop(front_frame)) {
-            continue;
-        }
-        // Look for matching right frame
-        bool found_match = false;
-            
-        // Keep popping right frames until we find one within tolerance
-        uint64_t time_diff = 0;
-        while (right_buffer_ && right_buffer_->pop(right_frame)) {
-            time_diff = std::abs(
-                static_cast<int64_t>(right_frame.timestamp_us) 
-                - static_cast<int64_t>(front_frame.timestamp_us)
-            );
-            
-            if (time_diff <= sync_tolerance_us_) {
-                found_match = true;
-                break;
+        sync_next_bundle(stages);
+    }
+}
+
+std::string Recorder::storage_dir_(
+    const std::string& session_name, const std::string& part, const std::string& fallback_part
+) const {
+    auto it = options_.storage_dirs.find(part);
+    if (it == options_.storage_dirs.end() && !fallback_part.empty()) {
+        it = options_.storage_dirs.find(fallback_part);
+    }
+    const std::string dir = (it == options_.storage_dirs.end() ? output_dir_ : it->second) + "/" + session_name;
+    system(("mkdir -p " + dir).c_str());
+    return dir;
+}
+
+bool Recorder::initialize_video_outputs_(
+    const std::string& session_name,
+    const std::string& default_codec,
+    int fps,
+    std::vector<std::pair<std::string, std::string>>& output_files
+) {
+    for (const VideoOutputSpec& output : options_.video_outputs) {
+        const std::string codec = output.codec.empty() ? default_codec : output.codec;
+        // Raw resized outputs hold BGR, not the camera's YUYV
+        const std::string extension = codec == RAW_VIDEO_CODEC ? ".bgr" : ".mp4";
+        for (const char* camera : {"cam_front", "cam_right"}) {
+            const std::string device = std::string("/dev/") + camera;
+            const std::string label = std::string(camera) + "_" + output.name;
+            const std::string path = storage_dir_(session_name, output.name, camera) + "/" + label + extension;
+            auto writer = std::make_unique<VideoWriter>();
+            if (!writer->initialize_resized(
+                path, CAM_CONFIG[device]["width"], CAM_CONFIG[device]["height"],
+                output.width, output.height, output.mode, fps, codec
+            )) {
+                return false;
             }
-            // If right frame is too old, continue to next one
-            // If right frame is too new, we missed the sync window
-            if (right_frame.timestamp_us > front_frame.timestamp_us + sync_tolerance_us_) {
-                break;
+            const bool front = device == "/dev/cam_front";
+            if (!output_striper_.add_writer(writer.get(), path, front ? 0 : 1, false)) {
+                return false;
             }
-        }
-            
-        if (!found_match) {
-            std::cout << "SYNC: No matching right frame for front ts=" << front_frame.timestamp_us << std::endl;
-            continue;
-        }
-        // std::cout << "SYNC: Seq=" << front_frame.sequence_number 
-        //           << " Front ts=" << front_frame.timestamp_us 
-        //           << " Right ts=" << right_frame.timestamp_us
-        //           << " diff=" << time_diff
-        //           << "us" << " < tol=" << sync_tolerance_us_ << "us" << std::endl;
-        
-        // Write frame to video file
-        int latency_front, latency_right;
-        front_video_writer_->write_frame(front_frame, latency_front);
-        right_video_writer_->write_frame(right_frame, latency_right);
-
-        // Log sync event to JSONL file
-        if (sync_logger_) {
-            sync_logger_->log_sync_event(
-                front_frame.timestamp_us,
-                front_frame.sequence_number,
-                right_frame.sequence_number,
-                front_frame.sequence_number  // Use front frame's seq as aggregate seq
-            );
-        }
-        
-        // Update performance monitor
-        if (performance_monitor_) {
-            std::unordered_map<std::string, FrameData> frame_data_by_device = {
-                {front_frame.device_name, {front_frame.timestamp_us, front_frame.sequence_number, latency_front}},
-                {right_frame.device_name, {right_frame.timestamp_us, right_frame.sequence_number, latency_right}}
-            };
-            performance_monitor_->tick(frame_data_by_device);
+            (front ? front_output_writers_ : right_output_writers_).push_back(std::move(writer));
+            output_files.emplace_back(label + "_video", path);
         }
     }
+    return true;
 }
 
 bool Recorder::start_pipeline(
@@ -148,12 +337,18 @@ bool Recorder::start_pipeline(
     SinkMode mode,
     FrameCallback callback,
     bool trigger_record_flag,
-    bool enable_fps_debug
+    bool enable_fps_debug,
+    int queue_max_buffers
 ) {
+    auto pipeline_template = options_.pipeline_templates.find(device_name);
+    if (pipeline_template != options_.pipeline_templates.end()) {
+        pipeline.set_pipeline_template(pipeline_template->second);
+    }
+
     // Initialize with specific video parameters: 640x480 @ 30fps
     if (!pipeline.initialize(
         device_name, cam_config["width"], cam_config["height"], 
-        cam_config["frame_rate"], mode, callback, trigger_record_flag, enable_fps_debug
+        cam_config["frame_rate"], mode, callback, trigger_record_flag, enable_fps_debug, queue_max_buffers
     )) {
         std::cerr << "Failed to initialize camera pipeline for " << device_name << std::endl;
         return false;
@@ -161,6 +356,12 @@ bool Recorder::start_pipeline(
 
     std::cout << "Camera pipeline " << device_name << " initialized successfully!" << std::endl;
 
+    if (performance_monitor_) {
+        pipeline.set_event_callback([this](const std::string& json_object) {
+            performance_monitor_->log_event(json_object);
+        });
+    }
+
     if (!pipeline.start()) {
         std::cerr << "Failed to start camera pipeline" << std::endl;
         return false;
@@ -181,27 +382,131 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
     std::ostringstream timestamp;
     timestamp << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
     
-    std::string output_subdir = output_dir_ + "/recording_" + timestamp.str();
-    std::string front_video_path = output_subdir + "/cam_front.mp4";
-    std::string right_video_path = output_subdir + "/cam_right.mp4";
-    std::string sync_log_path = output_subdir + "/sync_log.jsonl";
-    std::string metadata_path = output_subdir + "/metadata.json";
-    
+    std::string session_name = "recording_" + timestamp.str();
+    std::string output_subdir = output_dir_ + "/" + session_name;
     // Create output directory
     system(("mkdir -p " + output_subdir).c_str());
+
+    // Cameras and logs can each live on their own disk (--storage)
+    std::string log_subdir = storage_dir_(session_name, "logs");
+    std::string video_ext = options_.raw_video ? ".yuyv" : ".mp4";
+    std::string video_codec = options_.raw_video ? RAW_VIDEO_CODEC : "mp4v";
+    std::string front_video_path = storage_dir_(session_name, "cam_front") + "/cam_front" + video_ext;
+    std::string right_video_path = storage_dir_(session_name, "cam_right") + "/cam_right" + video_ext;
+    std::string sync_log_path = log_subdir + "/sync_log.jsonl";
+    std::string metadata_path = output_subdir + "/metadata.json";
+    std::string joint_state_path = joint_writer_ ? log_subdir + "/joint_state.bin" : "";
+    
+    // Replay takes its camera config from the recorded session
+    if (!options_.replay_session_dir.empty()) {
+        replay_ = std::make_unique<SessionReplay>();
+        if (!replay_->initialize(options_.replay_session_dir, options_.replay_mode, options_.replay_speed)) {
+            std::cerr << "Failed to open replay session " << options_.replay_session_dir << std::endl;
+            return false;
+        }
+        for (const char* device : {"/dev/cam_front", "/dev/cam_right"}) {
+            const SessionCameraConfig& config = replay_->camera_config(device);
+            CAM_CONFIG[device]["width"] = config.width;
+            CAM_CONFIG[device]["height"] = config.height;
+            CAM_CONFIG[device]["frame_rate"] = config.frame_rate;
+        }
+    }
+    
+    if (!allocate_frame_buffers_()) {
+        std::cerr << "Failed to allocate frame buffers" << std::endl;
+        return false;
+    }
     
     // Initialize video writers and sync logger
     int fps = CAM_CONFIG["/dev/cam_front"]["frame_rate"];
     int width = CAM_CONFIG["/dev/cam_front"]["width"];
     int height = CAM_CONFIG["/dev/cam_front"]["height"];
+    std::vector<std::pair<std::string, std::string>> output_files;
     
-    if (!front_video_writer_->initialize(front_video_path, width, height, fps) ||
-        !right_video_writer_->initialize(right_video_path, width, height, fps) ||
+    if (!front_video_writer_->initialize(front_video_path, width, height, fps, video_codec) ||
+        !right_video_writer_->initialize(right_video_path, width, height, fps, video_codec) ||
+        !output_striper_.add_writer(front_video_writer_.get(), front_video_path, 0, true) ||
+        !output_striper_.add_writer(right_video_writer_.get(), right_video_path, 1, true) ||
         !sync_logger_->initialize(sync_log_path) ||
-        !performance_monitor_->initialize(output_subdir)) {
+        !performance_monitor_->initialize(log_subdir) ||
+        !initialize_video_outputs_(session_name, video_codec, fps, output_files)) {
         std::cerr << "Failed to initialize output files" << std::endl;
         return false;
     }
+    output_files.emplace_back("events", log_subdir + "/events.jsonl");
+    output_files.emplace_back("metrics", log_subdir + "/metrics.json");
+    output_striper_.track_file(sync_log_path);
+    output_striper_.track_file(log_subdir + "/events.jsonl");
+    if (!joint_state_path.empty()) {
+        output_striper_.track_file(joint_state_path);
+    }
+    output_striper_.hold_rings(front_buffer_.get(), front_sync_consumer_, right_buffer_.get(), right_sync_consumer_);
+    output_striper_.start();
+
+    performance_monitor_->log_event(
+        "{\"timestamp_us\":" + std::to_string(steady_now_us()) +
+            ",\"event_type\":\"memory_budget\",\"budget\":" + memory_budget_->to_json() + "}"
+    );
+    if (motion_gate_) {
+        const MotionGateConfig& gate = motion_gate_->config();
+        std::ostringstream event;
+        event << "{\"timestamp_us\":" << steady_now_us()
+              << ",\"event_type\":\"motion_gate\",\"threshold\":" << gate.threshold
+              << ",\"hold_us\":" << gate.hold_us << ",\"idle_keep_every\":" << gate.idle_keep_every << "}";
+        performance_monitor_->log_event(event.str());
+    }
+
+    if (options_.qc_every_n > 0) {
+        live_qc_ = std::make_unique<LiveQc>();
+        if (!live_qc_->initialize(
+                {"/dev/cam_front", "/dev/cam_right"}, {front_buffer_.get(), right_buffer_.get()},
+                options_.qc_every_n, performance_monitor_.get())) {
+            std::cerr << "Failed to initialize live QC" << std::endl;
+            return false;
+        }
+    }
+
+    if (!options_.status_shm_name.empty() && !status_mailbox_.create_shared(options_.status_shm_name)) {
+        std::cerr << "Warning: status will not be shared outside the recorder" << std::endl;
+    }
+
+    if (options_.preview_port > 0) {
+        preview_tap_ = std::make_unique<PreviewTap>();
+        preview_tap_->set_status_mailbox(&status_mailbox_);
+        if (!preview_tap_->initialize(
+                {"/dev/cam_front", "/dev/cam_right"}, {front_buffer_.get(), right_buffer_.get()},
+                options_.preview_port, options_.preview_bind_address)) {
+            std::cerr << "Failed to initialize preview server" << std::endl;
+            return false;
+        }
+    }
+
+    if (!options_.frame_shm_prefix.empty()) {
+        frame_shm_tap_ = std::make_unique<FrameShmTap>();
+        if (!frame_shm_tap_->initialize(
+                {"/dev/cam_front", "/dev/cam_right"}, {front_buffer_.get(), right_buffer_.get()},
+                {front_frame_bytes_, right_frame_bytes_}, options_.frame_shm_prefix, options_.frame_shm_slots)) {
+            std::cerr << "Failed to initialize shared-memory frame tap" << std::endl;
+            return false;
+        }
+    }
+
+    // Ring consumers are started only once every one of them is registered
+    if ((live_qc_ && !live_qc_->start()) ||
+        (preview_tap_ && !preview_tap_->start()) ||
+        (frame_shm_tap_ && !frame_shm_tap_->start())) {
+        std::cerr << "Failed to start frame consumers" << std::endl;
+        return false;
+    }
+
+    if (joint_reader_ && !(
+        joint_writer_->initialize(joint_state_path) &&
+        joint_reader_->initialize(options_.joint_device, options_.joint_baud_rate, joint_buffer_.get()) &&
+        joint_reader_->start()
+    )) {
+        std::cerr << "Failed to start joint state recording" << std::endl;
+        return false;
+    }
     
     CameraPipeline pipeline_front;
     CameraPipeline pipeline_right;
@@ -211,14 +516,24 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
         this->on_camera_frame(frame, trigger_record);
     };
 
-    // Triggering recording on front camera.
-    if (!(
+    if (replay_) {
+        replay_->set_frame_callback(camera_callback);
+        // As-fast-as-possible replay waits for the sync thread to take each
+        // bundle instead of overrunning the rings
+        replay_->set_backpressure([this]() {
+            return front_buffer_->is_empty() && !should_tick_.load();
+        });
+        if (!replay_->start()) {
+            return false;
+        }
+    } else if (!(
+        // Triggering recording on front camera.
         start_pipeline(
             pipeline_front, "/dev/cam_front", CAM_CONFIG["/dev/cam_front"],
-            mode, camera_callback, /* trigger_record */ true
+            mode, camera_callback, /* trigger_record */ true, false, queue_max_buffers_[0]
         ) && start_pipeline(
             pipeline_right, "/dev/cam_right", CAM_CONFIG["/dev/cam_right"],
-            mode, camera_callback, /* trigger_record */ false 
+            mode, camera_callback, /* trigger_record */ false, false, queue_max_buffers_[1]
         )
     )) {
         return false;
@@ -228,12 +543,24 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
     sync_thread_ = std::make_unique<std::thread>(&Recorder::sync_thread_func, this);
     
     
-    while (start_timestamp_us_ == 0) {
+    while (start_timestamp_us_ == 0 && keep_running) {
+        if (replay_ && replay_->is_finished()) {
+            std::cerr << "Replay session has no frames" << std::endl;
+            keep_running = false;
+            break;
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
+    if (flight_recorder_) {
+        flight_recorder_->record_event(
+            FlightEventCode::SESSION_START, start_timestamp_us_, 0, timestamp.str().c_str()
+        );
+    }
+
     // Setup timing for duration and live metrics
     uint64_t last_metrics_timestamp_us = start_timestamp_us_;
+    uint64_t last_rollup_timestamp_us = start_timestamp_us_;
     const int metrics_interval_us = 2 * 1e6; // 2s
     
     std::cout << "\nRecording started..." << std::endl;
@@ -257,6 +584,40 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
             }
         }
         
+        // Replay ends once the last bundle has gone through the sync thread
+        if (replay_ && replay_->is_finished() && front_buffer_->is_empty() && !should_tick_.load()) {
+            std::cout << "\nReplay complete (" << replay_->bundles_replayed() << " bundles). Stopping..." << std::endl;
+            keep_running = false;
+            break;
+        }
+
+        publish_status_(current_timestamp_us, true);
+
+        // A camera that errored out or hit EOS won't deliver again; stop instead of recording one side
+        if (!replay_ && (pipeline_front.has_failed() || pipeline_right.has_failed())) {
+            std::cerr << "\nCamera pipeline failed (" << (pipeline_front.has_failed() ? "/dev/cam_front" : "/dev/cam_right")
+                      << "). Stopping..." << std::endl;
+            keep_running = false;
+            break;
+        }
+
+        // Metrics rollup into the flight recorder, same cadence as live metrics
+        if (current_timestamp_us - last_rollup_timestamp_us >= metrics_interval_us) {
+            record_metrics_rollup_(current_timestamp_us);
+            last_rollup_timestamp_us = current_timestamp_us;
+            if (performance_monitor_ && !replay_) {
+                performance_monitor_->update_pipeline_health("/dev/cam_front", pipeline_front.health());
+                performance_monitor_->update_pipeline_health("/dev/cam_right", pipeline_right.health());
+            }
+            if (performance_monitor_) {
+                for (const StorageDeviceStats& device : output_striper_.stats()) {
+                    performance_monitor_->update_storage(
+                        device.label, device.device_id, device.bytes, current_timestamp_us
+                    );
+                }
+            }
+        }
+        
         // Print live metrics if enabled
         if (live_metrics && performance_monitor_) {
             if (current_timestamp_us - last_metrics_timestamp_us >= metrics_interval_us) {
@@ -273,23 +634,89 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
         std::cout << "\r" << std::string(80, ' ') << "\r"; // Clear the line
     }
     std::cout << "\nShutting down..." << std::endl;
+    publish_status_(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count(), false);
     
     // Wait for sync thread to finish
     if (sync_thread_ && sync_thread_->joinable()) {
         sync_thread_->join();
     }
+    output_striper_.stop();
+    if (motion_gate_) {
+        SkippedRun run;
+        if (motion_gate_->finish(run)) {
+            sync_logger_->log_skipped_run(
+                run.first_timestamp_us, run.last_timestamp_us, run.first_seq, run.last_seq, run.count
+            );
+        }
+        const uint64_t total = motion_gate_->kept() + motion_gate_->skipped();
+        std::cout << "Motion gate: kept " << motion_gate_->kept() << " of " << total << " bundles" << std::endl;
+    }
     
     pipeline_front.stop();
     pipeline_right.stop();
+    if (performance_monitor_ && !replay_) {
+        performance_monitor_->update_pipeline_health("/dev/cam_front", pipeline_front.health());
+        performance_monitor_->update_pipeline_health("/dev/cam_right", pipeline_right.health());
+    }
+    if (replay_) {
+        replay_->stop();
+    }
+    if (live_qc_) {
+        live_qc_->stop();
+        live_qc_->report();
+    }
+    if (preview_tap_) {
+        preview_tap_->stop();
+        preview_tap_->report();
+    }
+    if (frame_shm_tap_) {
+        frame_shm_tap_->stop();
+        frame_shm_tap_->report();
+    }
+
+    if (joint_reader_) {
+        joint_reader_->stop();
+        drain_joint_state_();
+        std::cout << "Joint state: " << joint_reader_->samples_read() << " samples, "
+                  << joint_reader_->drops() << " dropped, "
+                  << joint_reader_->parse_errors() << " parse errors" << std::endl;
+        joint_writer_->finalize();
+    }
     
     // Finalize output files
     front_video_writer_->finalize();
     right_video_writer_->finalize();
+    for (auto& writer : front_output_writers_) {
+        writer->finalize();
+    }
+    for (auto& writer : right_output_writers_) {
+        writer->finalize();
+    }
     sync_logger_->finalize();
     
     // Generate performance report
     if (performance_monitor_) {
+        const uint64_t final_timestamp_us = steady_now_us();
+        for (const StorageDeviceStats& device : output_striper_.stats()) {
+            performance_monitor_->update_storage(device.label, device.device_id, device.bytes, final_timestamp_us);
+        }
         performance_monitor_->report();
+        performance_monitor_->log_event(
+            "{\"timestamp_us\":" + std::to_string(steady_now_us()) +
+                ",\"event_type\":\"memory_budget\",\"budget\":" + memory_budget_->to_json() + "}"
+        );
+    }
+    memory_budget_->report();
+    alloc_stats::print_report(std::cout);
+
+    if (options_.compact_logs) {
+        const std::string columns_path = log_subdir + "/" + SESSION_COLUMNS_FILE_NAME;
+        if (compact_session_logs(sync_log_path, log_subdir + "/events.jsonl", columns_path)) {
+            output_files.emplace_back("columns", columns_path);
+            output_striper_.track_file(columns_path);
+            std::cout << "Log columns written to: " << columns_path << std::endl;
+        }
     }
     
     // Write metadata file
@@ -299,8 +726,26 @@ bool Recorder::run(SinkMode mode, int duration_seconds, bool live_metrics) {
         sync_tolerance_us_,
         front_video_path,
         right_video_path,
-        sync_log_path
+        sync_log_path,
+        joint_state_path,
+        output_files,
+        output_striper_.to_json()
     );
+
+    // Index the finished session in <output_dir>/catalog.bin
+    SessionCatalogEntry catalog_entry;
+    if (session_catalog_entry(output_subdir, catalog_entry)) {
+        append_session_catalog(output_dir_ + "/" + SESSION_CATALOG_FILE_NAME, catalog_entry);
+    }
+    
+    if (flight_recorder_) {
+        uint64_t stop_timestamp_us = steady_now_us();
+        record_metrics_rollup_(stop_timestamp_us);
+        flight_recorder_->record_event(
+            FlightEventCode::SESSION_STOP, stop_timestamp_us, 0, timestamp.str().c_str()
+        );
+        flight_recorder_->flush();
+    }
     
     std::cout << "Recording saved to: " << output_subdir << std::endl;
     return true;
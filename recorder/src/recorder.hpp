@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <csignal>
 #include <iostream>
 #include <thread>
@@ -13,20 +15,128 @@
 
 #include "camera_capture_pipeline.hpp"
 #include "spsc_ring_buffer.hpp"
+#include "broadcast_ring.hpp"
 #include "video_writer.hpp"
 #include "sync_logger.hpp"
 #include "metadata_writer.hpp"
 #include "performance_monitor.hpp"
+#include "joint_state.hpp"
+#include "joint_state_reader.hpp"
+#include "joint_state_writer.hpp"
+#include "flight_recorder.hpp"
+#include "replay_source.hpp"
+#include "live_qc.hpp"
+#include "preview_tap.hpp"
+#include "frame_shm_tap.hpp"
+#include "latest_value_mailbox.hpp"
+#include "recorder_status.hpp"
+#include "memory_budget.hpp"
+#include "sync_matcher.hpp"
+#include "sync_bundle.hpp"
+#include "motion_gate.hpp"
+#include "output_striper.hpp"
+#include "session_catalog.hpp"
+#include "session_columns.hpp"
 
-// used for synchronizing frames between the two cameras.
-// Camera frames more than this duration apart won't be considered
-// in the same recorder frame. (in microseconds)
-// TODO(sherry): Just make this the frame_rate of cam_front if we 
-// are using that as the trigger?
+// Default for --sync-tolerance-us: front/right frames captured more than this
+// many microseconds apart aren't bundled. One frame period at 30 fps, tuned
+// with scripts/sync_sim.cpp.
 constexpr int SYNC_TOLERANCE_US = 1'000'000 / 30.0;
 
 extern std::unordered_map<std::string, std::unordered_map<std::string, int>> CAM_CONFIG;
 
+// Joint state ring holds ~2s at the max 500 Hz arm rate.
+constexpr size_t JOINT_STATE_BUFFER_CAPACITY = 1000;
+constexpr int JOINT_STATE_DEFAULT_BAUD = 1'000'000;
+
+// Buffering defaults. 3 s matches the old fixed 100-frame rings at 30 fps;
+// a ring is never shrunk below RING_BUFFER_MIN_SECONDS to fit the budget.
+constexpr double RING_BUFFER_DEFAULT_SECONDS = 3.0;
+constexpr double RING_BUFFER_MIN_SECONDS = 0.5;
+constexpr double GST_QUEUE_DEFAULT_SECONDS = 1.0;
+
+// Camera ring slots for `seconds` of frames at `fps`
+inline size_t ring_buffer_frames(double seconds, int fps) {
+    return std::max<size_t>(2, static_cast<size_t>(std::ceil(seconds * fps)));
+}
+
+// Extra video written from every camera's frames next to the full-resolution
+// one, e.g. a 224x224 crop for training: cam_front_<name>.mp4, ...
+struct VideoOutputSpec {
+    std::string name;
+    int width = 0;
+    int height = 0;
+    ResizeMode mode = ResizeMode::STRETCH;
+    std::string codec;  // empty = same as the main video
+};
+
+// Optional recorder features, set from the command line.
+struct RecorderOptions {
+    // Serial/pty device of the arm controller. Empty disables joint state.
+    std::string joint_device;
+    int joint_baud_rate = JOINT_STATE_DEFAULT_BAUD;
+
+    // Always-on flight recorder ring file. Empty path means
+    // <output_dir>/flight_recorder.bin; lives outside the session dirs so it
+    // also covers the time between sessions.
+    bool flight_recorder_enabled = true;
+    std::string flight_recorder_path;
+    int flight_recorder_minutes = FLIGHT_RECORDER_DEFAULT_MINUTES;
+
+    // Write cam_*.yuyv raw captures instead of encoded cam_*.mp4
+    bool raw_video = false;
+
+    // Replay a recorded session instead of opening the cameras.
+    std::string replay_session_dir;
+    ReplayMode replay_mode = ReplayMode::REALTIME;
+    double replay_speed = 1.0;
+
+    // Live image QC on every Nth frame per camera; 0 disables it.
+    int qc_every_n = QC_DEFAULT_EVERY_N;
+
+    // MJPEG preview server; 0 disables it.
+    int preview_port = 0;
+    std::string preview_bind_address = "127.0.0.1";
+
+    // Shared-memory status mailbox for other processes; empty disables it.
+    std::string status_shm_name = RECORDER_STATUS_SHM_NAME;
+
+    // Shared-memory frame rings (<prefix>_cam_front, ...); empty disables them.
+    std::string frame_shm_prefix;
+    int frame_shm_slots = FRAME_SHM_DEFAULT_SLOTS;
+
+    // Frame buffering, in seconds of video per camera
+    double ring_buffer_seconds = RING_BUFFER_DEFAULT_SECONDS;
+    double gst_queue_seconds = GST_QUEUE_DEFAULT_SECONDS;
+
+    // Cap on all buffered frames; 0 = a quarter of physical RAM
+    uint64_t memory_budget_bytes = 0;
+
+    // Front/right frame matching
+    SyncPolicy sync_policy = SyncPolicy::FIRST_WITHIN;
+    int sync_tolerance_us = SYNC_TOLERANCE_US;
+
+    // Capture pipeline templates by device (see DEFAULT_PIPELINE_TEMPLATE);
+    // cameras without one use the built-in pipeline.
+    std::unordered_map<std::string, std::string> pipeline_templates;
+
+    // Additional scaled/cropped outputs per camera
+    std::vector<VideoOutputSpec> video_outputs;
+
+    // Where parts of the session go, by part: "cam_front", "cam_right",
+    // "logs" or an output name from video_outputs. Each gets its own
+    // recording_<timestamp> directory there; anything not listed stays under
+    // the output dir, which always holds metadata.json.
+    std::unordered_map<std::string, std::string> storage_dirs;
+
+    // Thin out bundles while nothing moves; skipped runs go to the sync log
+    bool motion_gate = false;
+    MotionGateConfig motion_gate_config;
+
+    // Write session_columns.bin from the sync and event logs at the end
+    bool compact_logs = false;
+};
+
 // Global flag for signal handling - needs to be accessible from static signal handler
 extern volatile sig_atomic_t keep_running;
 
@@ -38,27 +148,70 @@ class Recorder {
         // atomic flag for sleep polling
         std::atomic<bool> should_tick_{false};
         
-        // Ring buffers for each camera (storing CameraFrame objects)
-        std::unique_ptr<SPSCRingBuffer<CameraFrame>> front_buffer_;
-        std::unique_ptr<SPSCRingBuffer<CameraFrame>> right_buffer_;
+        // Ring buffers for each camera (storing CameraFrame objects). The sync
+        // thread is the blocking consumer; QC and preview attach as lossy ones.
+        std::unique_ptr<BroadcastRing<CameraFrame>> front_buffer_;
+        std::unique_ptr<BroadcastRing<CameraFrame>> right_buffer_;
+        int front_sync_consumer_;
+        int right_sync_consumer_;
+        std::unique_ptr<SPSCRingBuffer<JointState>> joint_buffer_;
         
         // Synchronization thread
         std::unique_ptr<std::thread> sync_thread_;
         
         // Frame rate for synchronization timing
         int sync_tolerance_us_;
+        SyncMatcher sync_matcher_;
+        // Set with --motion-gate; decides which synced bundles get written
+        std::unique_ptr<MotionGate> motion_gate_;
         
         // Video writers and sync logger
         std::unique_ptr<VideoWriter> front_video_writer_;
         std::unique_ptr<VideoWriter> right_video_writer_;
+        // One per options_.video_outputs entry, fed from the same ring slots
+        std::vector<std::unique_ptr<VideoWriter>> front_output_writers_;
+        std::vector<std::unique_ptr<VideoWriter>> right_output_writers_;
+        // Runs every writer above, one I/O thread per storage device
+        OutputStriper output_striper_;
         std::unique_ptr<SyncLogger> sync_logger_;
+
+        // Arm joint state: reader thread -> joint_buffer_ -> sync thread
+        std::unique_ptr<JointStateReader> joint_reader_;
+        std::unique_ptr<JointStateWriter> joint_writer_;
+        JointStateAligner joint_aligner_;
+
+        std::unique_ptr<FlightRecorder> flight_recorder_;
+
+        // Image QC off the sync path
+        std::unique_ptr<LiveQc> live_qc_;
+
+        // Decimated preview for operators (VR client, browser)
+        std::unique_ptr<PreviewTap> preview_tap_;
+
+        // Live frames for other local processes, zero-copy via shm
+        std::unique_ptr<FrameShmTap> frame_shm_tap_;
+
+        // Newest status for the preview server and, via shm, other processes
+        LatestValueMailbox<RecorderStatus> status_mailbox_;
+
+        // Caps everything that holds raw frames; sized in run() from CAM_CONFIG
+        std::unique_ptr<MemoryBudget> memory_budget_;
+        uint64_t front_frame_bytes_;
+        uint64_t right_frame_bytes_;
+        int queue_max_buffers_[2];
+
+        // Set when replaying a session instead of capturing
+        std::unique_ptr<SessionReplay> replay_;
+        std::atomic<uint64_t> ring_drop_count_{0};
         
         // Performance monitor
         std::unique_ptr<PerformanceMonitor> performance_monitor_;
 
         std::string output_dir_;
+        RecorderOptions options_;
 
-        uint64_t start_timestamp_us_;
+        // First front frame's capture time; set by the capture callback, read by the main thread
+        std::atomic<uint64_t> start_timestamp_us_;
 
         // Unified camera frame callback
         void on_camera_frame(const CameraFrame& frame, bool trigger_record);
@@ -66,6 +219,30 @@ class Recorder {
         // Synchronization thread function
         void sync_thread_func();
 
+        // Moves pending joint samples from the ring to disk and the aligner
+        void drain_joint_state_();
+
+        void record_metrics_rollup_(uint64_t timestamp_us);
+
+        void publish_status_(uint64_t timestamp_us, bool recording);
+
+        // Sizes and creates the camera rings within the memory budget
+        bool allocate_frame_buffers_();
+
+        // Session directory for `part` (see RecorderOptions::storage_dirs),
+        // else for `fallback_part`, else under the output dir; created if needed
+        std::string storage_dir_(
+            const std::string& session_name, const std::string& part, const std::string& fallback_part = ""
+        ) const;
+
+        // Opens the options_.video_outputs writers; adds ("<label>_video", path) per file
+        bool initialize_video_outputs_(
+            const std::string& session_name,
+            const std::string& default_codec,
+            int fps,
+            std::vector<std::pair<std::string, std::string>>& output_files
+        );
+
         bool start_pipeline(
             CameraPipeline& pipeline,
             const std::string& device_name,
@@ -73,11 +250,12 @@ class Recorder {
             SinkMode mode,
             FrameCallback callback = nullptr,
             bool trigger_record_flag = false,
-            bool enable_fps_debug = false
+            bool enable_fps_debug = false,
+            int queue_max_buffers = DEFAULT_QUEUE_MAX_BUFFERS
         );
     
     public:
-        Recorder(const std::string& output_dir);
+        Recorder(const std::string& output_dir, const RecorderOptions& options = RecorderOptions());
         
         bool run(SinkMode mode, int duration_seconds = 0, bool live_metrics = false);
 };
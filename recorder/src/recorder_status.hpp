@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+// Default shm object the recorder publishes its status to
+constexpr const char* RECORDER_STATUS_SHM_NAME = "/robodaq_recorder_status";
+
+// Live recorder status, published through a LatestValueMailbox a few times a
+// second. Plain fixed-size fields so it can cross process boundaries.
+struct RecorderStatus {
+    uint64_t timestamp_us;          // steady clock at publish time
+    uint64_t session_start_us;      // steady clock of the first synced frame, 0 before that
+    uint64_t frames_recorded;
+    uint64_t ring_drops;
+    uint64_t seq_gaps[2];           // [front, right]
+    double mean_latency_us[2];      // [front, right]
+    uint32_t ring_fill[2];          // frames waiting in each camera ring
+    uint32_t recording;             // 1 while the session is running
+    uint32_t reserved;
+    uint64_t buffered_bytes;        // raw frames waiting in the camera rings
+    uint64_t memory_budget_bytes;
+};
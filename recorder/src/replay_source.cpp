@@ -0,0 +1,222 @@
+#include "replay_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "jsonl_parse.hpp"
+
+namespace {
+
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint8_t clamp_u8(int v) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, v)));
+}
+
+// BGR24 -> YUYV (BT.601 limited range), the inverse of COLOR_YUV2BGR_YUY2
+void bgr_to_yuyv(const cv::Mat& bgr, int width, int height, std::vector<uint8_t>& out) {
+    out.resize(static_cast<size_t>(width) * height * 2);
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = bgr.ptr<uint8_t>(y);
+        uint8_t* dst = out.data() + static_cast<size_t>(y) * width * 2;
+        for (int x = 0; x < width; x += 2) {
+            int b0 = src[0], g0 = src[1], r0 = src[2];
+            int b1 = src[3], g1 = src[4], r1 = src[5];
+            int y0 = ((66 * r0 + 129 * g0 + 25 * b0 + 128) >> 8) + 16;
+            int y1 = ((66 * r1 + 129 * g1 + 25 * b1 + 128) >> 8) + 16;
+            int r = (r0 + r1) / 2, g = (g0 + g1) / 2, b = (b0 + b1) / 2;
+            int u = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+            int v = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+            dst[0] = clamp_u8(y0);
+            dst[1] = clamp_u8(u);
+            dst[2] = clamp_u8(y1);
+            dst[3] = clamp_u8(v);
+            src += 6;
+            dst += 4;
+        }
+    }
+}
+
+} // namespace
+
+SessionReplay::SessionReplay() : mode_(ReplayMode::REALTIME), speed_(1.0) {}
+
+SessionReplay::~SessionReplay() {
+    stop();
+}
+
+bool SessionReplay::open_camera_(
+    ReplayCamera& camera, const std::string& device_name, const std::string& stem
+) {
+    if (!read_session_camera_config(session_dir_, device_name, camera.config)) {
+        return false;
+    }
+
+    // Prefer the lossless raw capture when the session has one
+    camera.video_path = find_session_video(session_dir_, stem, camera.is_raw);
+    if (camera.video_path.empty()) {
+        std::cerr << "Replay: no " << stem << " video in " << session_dir_ << std::endl;
+        return false;
+    }
+    if (camera.is_raw) {
+        camera.raw_file.open(camera.video_path, std::ios::in | std::ios::binary);
+        if (!camera.raw_file.is_open()) {
+            std::cerr << "Replay: failed to open " << camera.video_path << std::endl;
+            return false;
+        }
+    } else {
+        camera.capture = std::make_unique<cv::VideoCapture>(camera.video_path);
+        if (!camera.capture->isOpened()) {
+            std::cerr << "Replay: failed to open " << camera.video_path << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "Replay: " << device_name << " from " << camera.video_path 
+              << (camera.is_raw ? " (raw, bit-exact)" : " (decoded)") << std::endl;
+    return true;
+}
+
+bool SessionReplay::initialize(const std::string& session_dir, ReplayMode mode, double speed) {
+    session_dir_ = session_dir;
+    mode_ = mode;
+    speed_ = (mode == ReplayMode::REALTIME) ? 1.0 : speed;
+    if (mode_ == ReplayMode::SCALED && speed_ <= 0.0) {
+        std::cerr << "Replay: speed must be positive" << std::endl;
+        return false;
+    }
+
+    if (!open_camera_(front_, "/dev/cam_front", "cam_front") ||
+        !open_camera_(right_, "/dev/cam_right", "cam_right")) {
+        return false;
+    }
+
+    const std::string sync_log_path = session_output_file(session_dir, "sync_log", "sync_log.jsonl");
+    sync_log_.open(sync_log_path);
+    if (!sync_log_.is_open()) {
+        std::cerr << "Replay: failed to open " << sync_log_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const SessionCameraConfig& SessionReplay::camera_config(const std::string& device_name) const {
+    return device_name == right_.config.device_name ? right_.config : front_.config;
+}
+
+bool SessionReplay::read_frame_(ReplayCamera& camera, CameraFrame& frame) {
+    frame.device_name = camera.config.device_name;
+    frame.width = camera.config.width;
+    frame.height = camera.config.height;
+    frame.format = CameraFormat::YUYV;
+
+    if (camera.is_raw) {
+        frame.image_data.resize(static_cast<size_t>(frame.width) * frame.height * 2);
+        return static_cast<bool>(camera.raw_file.read(
+            reinterpret_cast<char*>(frame.image_data.data()), frame.image_data.size()));
+    }
+
+    if (!camera.capture->read(camera.bgr_image) || camera.bgr_image.empty()) {
+        return false;
+    }
+    bgr_to_yuyv(camera.bgr_image, frame.width, frame.height, frame.image_data);
+    return true;
+}
+
+bool SessionReplay::start() {
+    if (!sync_log_.is_open()) {
+        std::cerr << "SessionReplay not initialized" << std::endl;
+        return false;
+    }
+    running_.store(true);
+    finished_.store(false);
+    replay_thread_ = std::make_unique<std::thread>(&SessionReplay::replay_thread_func_, this);
+    return true;
+}
+
+void SessionReplay::stop() {
+    running_.store(false);
+    if (replay_thread_ && replay_thread_->joinable()) {
+        replay_thread_->join();
+    }
+    replay_thread_.reset();
+}
+
+void SessionReplay::replay_thread_func_() {
+    const uint64_t replay_start_us = steady_now_us();
+    uint64_t first_recorded_us = 0;
+    std::string line;
+    CameraFrame front_frame;
+    CameraFrame right_frame;
+    // AS_FAST_AS_POSSIBLE runs ahead of the recorded timing; this much is
+    // taken off every rebased time so no frame is stamped later than when it
+    // is delivered (latencies stay >= 0, skew and order are kept)
+    uint64_t ahead_us = 0;
+
+    // Maps a recorded capture time onto the replay clock
+    auto rebase = [&](uint64_t recorded_us) -> uint64_t {
+        uint64_t offset_us = recorded_us > first_recorded_us ? recorded_us - first_recorded_us : 0;
+        if (mode_ == ReplayMode::AS_FAST_AS_POSSIBLE) {
+            return replay_start_us + offset_us;
+        }
+        return replay_start_us + static_cast<uint64_t>(offset_us / speed_);
+    };
+
+    while (running_.load() && std::getline(sync_log_, line)) {
+        uint64_t front_ts = 0, right_ts = 0, front_seq = 0, right_seq = 0;
+        if (sync_log_is_skipped_run(line) ||
+            !jsonl_get_uint(line, "timestamp", front_ts) ||
+            !jsonl_get_uint(line, "cam1_frame_id", front_seq) ||
+            !jsonl_get_uint(line, "cam2_frame_id", right_seq)) {
+            continue;
+        }
+        // Logs from before cam2_timestamp was recorded: assume zero skew
+        if (!jsonl_get_uint(line, "cam2_timestamp", right_ts)) {
+            right_ts = front_ts;
+        }
+        if (first_recorded_us == 0) {
+            first_recorded_us = std::min(front_ts, right_ts);
+        }
+
+        // Decode before waiting so decode time doesn't skew delivery
+        if (!read_frame_(front_, front_frame) || !read_frame_(right_, right_frame)) {
+            std::cerr << "Replay: video ended before sync log (row " << bundles_replayed_.load() << ")" << std::endl;
+            break;
+        }
+        front_frame.sequence_number = front_seq;
+        right_frame.sequence_number = right_seq;
+        front_frame.timestamp_us = rebase(front_ts);
+        right_frame.timestamp_us = rebase(right_ts);
+
+        if (mode_ == ReplayMode::AS_FAST_AS_POSSIBLE) {
+            while (running_.load() && can_push_ && !can_push_()) {
+                std::this_thread::yield();
+            }
+            const uint64_t latest_us = std::max(front_frame.timestamp_us, right_frame.timestamp_us);
+            const uint64_t now_us = steady_now_us();
+            if (latest_us > now_us + ahead_us) {
+                ahead_us = latest_us - now_us;
+            }
+            front_frame.timestamp_us -= ahead_us;
+            right_frame.timestamp_us -= ahead_us;
+        } else {
+            uint64_t deliver_at_us = std::max(front_frame.timestamp_us, right_frame.timestamp_us);
+            uint64_t now_us = steady_now_us();
+            if (deliver_at_us > now_us) {
+                std::this_thread::sleep_for(std::chrono::microseconds(deliver_at_us - now_us));
+            }
+        }
+
+        if (frame_callback_) {
+            frame_callback_(right_frame, false);
+            frame_callback_(front_frame, true);
+        }
+        bundles_replayed_++;
+    }
+
+    std::cout << "Replay finished: " << bundles_replayed_.load() << " bundles" << std::endl;
+    finished_.store(true);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+#include "camera_capture_pipeline.hpp"
+#include "session_metadata.hpp"
+
+/*
+    Feeds a recorded session back through the Recorder in place of the live
+    CameraPipelines. Frames come from the session's per-camera videos
+    (cam_*.yuyv raw captures replay bit-for-bit, cam_*.mp4 is decoded and
+    converted back to YUYV) and are timed by sync_log.jsonl.
+
+    Each sync_log row is one bundle: the right frame is delivered, then the
+    front frame (which triggers the sync thread), at the later of the two
+    recorded capture times. Timestamps are rebased onto the current
+    steady_clock so recorder latency metrics stay meaningful; in
+    AS_FAST_AS_POSSIBLE mode they are also pulled back to the delivery time
+    whenever replay gets ahead of the recording, never into the future.
+*/
+
+enum class ReplayMode {
+    REALTIME,             // original timing
+    SCALED,               // original timing divided by `speed`
+    AS_FAST_AS_POSSIBLE,  // no pacing; waits for the consumer instead of dropping
+};
+
+class SessionReplay {
+private:
+    struct ReplayCamera {
+        SessionCameraConfig config;
+        std::string video_path;
+        bool is_raw = false;
+        std::ifstream raw_file;
+        std::unique_ptr<cv::VideoCapture> capture;
+        cv::Mat bgr_image;
+    };
+
+    std::string session_dir_;
+    ReplayMode mode_;
+    double speed_;
+    ReplayCamera front_;
+    ReplayCamera right_;
+    std::ifstream sync_log_;
+
+    FrameCallback frame_callback_;
+    std::function<bool()> can_push_;
+
+    std::unique_ptr<std::thread> replay_thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> finished_{false};
+    std::atomic<uint64_t> bundles_replayed_{0};
+
+    bool open_camera_(ReplayCamera& camera, const std::string& device_name, const std::string& stem);
+    bool read_frame_(ReplayCamera& camera, CameraFrame& frame);
+    void replay_thread_func_();
+
+public:
+    SessionReplay();
+    ~SessionReplay();
+
+    bool initialize(const std::string& session_dir, ReplayMode mode, double speed = 1.0);
+
+    // Same callback the live pipelines get. `can_push` is polled before each
+    // bundle in AS_FAST_AS_POSSIBLE mode so replay waits for the sync thread.
+    void set_frame_callback(FrameCallback callback) { frame_callback_ = callback; }
+    void set_backpressure(std::function<bool()> can_push) { can_push_ = can_push; }
+
+    bool start();
+    void stop();
+
+    bool is_finished() const { return finished_.load(); }
+    uint64_t bundles_replayed() const { return bundles_replayed_.load(); }
+    const SessionCameraConfig& camera_config(const std::string& device_name) const;
+};
@@ -0,0 +1,361 @@
+#include "session_catalog.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jsonl_parse.hpp"
+#include "session_columns.hpp"
+#include "session_metadata.hpp"
+
+namespace {
+
+bool read_file(const std::string& path, std::string& contents) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// Sum of every "key": <uint> in `json` (one per device in metrics.json)
+uint64_t sum_uint_fields(const std::string& json, const char* key) {
+    const std::string pattern = std::string("\"") + key + "\"";
+    uint64_t sum = 0;
+    for (size_t pos = json.find(pattern); pos != std::string::npos; pos = json.find(pattern, pos + 1)) {
+        uint64_t value = 0;
+        if (jsonl_get_uint(json.substr(pos, 64), key, value)) {
+            sum += value;
+        }
+    }
+    return sum;
+}
+
+// Frames missing per camera from the sequence_gap rows of events.jsonl
+void sum_sequence_gap_events(const std::string& events_path, uint32_t& front_drops, uint32_t& right_drops) {
+    std::ifstream events(events_path);
+    std::string line, device_name;
+    uint64_t gap_size = 0;
+    while (events.is_open() && std::getline(events, line)) {
+        if (line.find("\"sequence_gap\"") == std::string::npos ||
+            !jsonl_get_string(line, "device_name", device_name) || !jsonl_get_uint(line, "gap_size", gap_size)) {
+            continue;
+        }
+        if (device_name == "/dev/cam_front") {
+            front_drops += static_cast<uint32_t>(gap_size);
+        } else if (device_name == "/dev/cam_right") {
+            right_drops += static_cast<uint32_t>(gap_size);
+        }
+    }
+}
+
+// "recording_20250101_120000" -> 20250101120000, 0 if the name has another shape
+uint64_t parse_start_stamp(const std::string& name) {
+    const std::string prefix = "recording_";
+    if (name.size() != prefix.size() + 15 || name.compare(0, prefix.size(), prefix) != 0 ||
+        name[prefix.size() + 8] != '_') {
+        return 0;
+    }
+    uint64_t stamp = 0;
+    for (size_t i = prefix.size(); i < name.size(); i++) {
+        if (i == prefix.size() + 8) {
+            continue;
+        }
+        if (name[i] < '0' || name[i] > '9') {
+            return 0;
+        }
+        stamp = stamp * 10 + (name[i] - '0');
+    }
+    return stamp;
+}
+
+// First and last video-frame timestamps of a sync log, reading only its ends
+bool sync_log_span(const std::string& path, uint64_t& first_us, uint64_t& last_us) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    bool found = false;
+    while (!found && std::getline(file, line)) {
+        found = !sync_log_is_skipped_run(line) && jsonl_get_uint(line, "timestamp", first_us);
+    }
+    if (!found) {
+        return false;
+    }
+    constexpr std::streamoff TAIL_BYTES = 64 * 1024;
+    file.clear();
+    file.seekg(0, std::ios::end);
+    const std::streamoff size = file.tellg();
+    file.seekg(std::max<std::streamoff>(0, size - TAIL_BYTES));
+    std::string tail((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    last_us = first_us;
+    for (size_t end = tail.size(); end > 0;) {
+        size_t begin = tail.rfind('\n', end - 1);
+        begin = begin == std::string::npos ? 0 : begin + 1;
+        const std::string row = tail.substr(begin, end - begin);
+        if (begin < end && !sync_log_is_skipped_run(row) && jsonl_get_uint(row, "timestamp", last_us)) {
+            break;
+        }
+        end = begin > 0 ? begin - 1 : 0;
+    }
+    return true;
+}
+
+std::string session_name(const std::string& session_dir) {
+    std::string dir = session_dir;
+    while (dir.size() > 1 && dir.back() == '/') {
+        dir.pop_back();
+    }
+    const size_t slash = dir.find_last_of('/');
+    return slash == std::string::npos ? dir : dir.substr(slash + 1);
+}
+
+}  // namespace
+
+bool session_catalog_entry(const std::string& session_dir, SessionCatalogEntry& entry) {
+    entry = SessionCatalogEntry();
+    const std::string name = session_name(session_dir);
+    if (name.size() >= sizeof(entry.name)) {
+        std::cerr << "Session name too long for the catalog: " << name << std::endl;
+        return false;
+    }
+    std::memcpy(entry.name, name.data(), name.size());
+    entry.start_stamp = parse_start_stamp(name);
+
+    SessionCameraConfig front, right;
+    if (!read_session_camera_config(session_dir, "/dev/cam_front", front) ||
+        !read_session_camera_config(session_dir, "/dev/cam_right", right)) {
+        return false;
+    }
+    entry.front_width = static_cast<uint16_t>(front.width);
+    entry.front_height = static_cast<uint16_t>(front.height);
+    entry.front_fps = static_cast<uint16_t>(front.frame_rate);
+    entry.right_width = static_cast<uint16_t>(right.width);
+    entry.right_height = static_cast<uint16_t>(right.height);
+    entry.right_fps = static_cast<uint16_t>(right.frame_rate);
+
+    std::string metrics;
+    if (!read_file(session_output_file(session_dir, "metrics", "metrics.json"), metrics)) {
+        std::cerr << "No metrics.json for " << session_dir << std::endl;
+        return false;
+    }
+    uint64_t value = 0;
+    if (jsonl_get_uint(metrics, "total_frames", value)) {
+        entry.bundles = value;
+    }
+    if (jsonl_get_uint(metrics, "skipped_bundles", value)) {
+        entry.skipped_bundles = value;
+    }
+    const size_t missing = metrics.find("\"missing_frames_by_device\"");
+    if (missing != std::string::npos) {
+        const std::string block = metrics.substr(missing, metrics.find('}', missing) - missing);
+        if (jsonl_get_uint(block, "/dev/cam_front", value)) {
+            entry.front_drops = static_cast<uint32_t>(value);
+        }
+        if (jsonl_get_uint(block, "/dev/cam_right", value)) {
+            entry.right_drops = static_cast<uint32_t>(value);
+        }
+    } else {
+        // Older metrics.json only counts gaps, not the frames in them
+        sum_sequence_gap_events(
+            session_output_file(session_dir, "events", "events.jsonl"), entry.front_drops, entry.right_drops
+        );
+    }
+    if (sum_uint_fields(metrics, "errors") > 0) {
+        entry.flags |= SESSION_CATALOG_PIPELINE_ERRORS;
+    }
+
+    bool is_raw = false;
+    if (!find_session_video(session_dir, "cam_front", is_raw).empty() && is_raw) {
+        entry.flags |= SESSION_CATALOG_RAW_VIDEO;
+    }
+    const std::string joint_path = session_output_file(session_dir, "joint_state", "joint_state.bin");
+    if (std::ifstream(joint_path).good()) {
+        entry.flags |= SESSION_CATALOG_JOINT_STATE;
+    }
+
+    uint64_t first_us = 0, last_us = 0;
+    SessionColumns columns;
+    const std::string columns_path = session_output_file(session_dir, "columns", SESSION_COLUMNS_FILE_NAME);
+    if (std::ifstream(columns_path).good() && columns.open(columns_path)) {
+        entry.flags |= SESSION_CATALOG_COLUMNS;
+        const ColumnView front_ts = columns.column(COLUMN_SYNC_FRONT_TIMESTAMP_US);
+        if (front_ts.rows > 0) {
+            first_us = front_ts.values[0];
+            last_us = front_ts.values[front_ts.rows - 1];
+        }
+    } else {
+        sync_log_span(session_output_file(session_dir, "sync_log", "sync_log.jsonl"), first_us, last_us);
+    }
+    entry.duration_us = last_us > first_us ? last_us - first_us : 0;
+    return true;
+}
+
+int lock_session_catalog(const std::string& catalog_path) {
+    while (true) {
+        int fd = ::open(catalog_path.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+        if (fd < 0) {
+            std::cerr << "Failed to open catalog " << catalog_path << ": " << strerror(errno) << std::endl;
+            return -1;
+        }
+        if (flock(fd, LOCK_EX) != 0) {
+            std::cerr << "Failed to lock catalog " << catalog_path << ": " << strerror(errno) << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        // A rebuild may have renamed a new file into place while we waited
+        struct stat locked, current;
+        if (fstat(fd, &locked) == 0 && stat(catalog_path.c_str(), &current) == 0 &&
+            locked.st_dev == current.st_dev && locked.st_ino == current.st_ino) {
+            return fd;
+        }
+        ::close(fd);
+    }
+}
+
+bool append_session_catalog(const std::string& catalog_path, const SessionCatalogEntry& entry) {
+    int fd = lock_session_catalog(catalog_path);
+    if (fd < 0) {
+        return false;
+    }
+    SessionCatalogHeader header = {};
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Failed to stat catalog " << catalog_path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    bool ok = true;
+    if (st.st_size < static_cast<off_t>(sizeof(header))) {
+        // New file, or one whose header write was cut short
+        ok = st.st_size == 0 || ftruncate(fd, 0) == 0;
+        std::memcpy(header.magic, SESSION_CATALOG_MAGIC, sizeof(header.magic));
+        header.version = SESSION_CATALOG_VERSION;
+        header.entry_size = sizeof(SessionCatalogEntry);
+        ok = ok && write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+    } else {
+        // Never append to a catalog whose entries we'd misread
+        if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            std::memcmp(header.magic, SESSION_CATALOG_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != SESSION_CATALOG_VERSION || header.entry_size != sizeof(SessionCatalogEntry)) {
+            std::cerr << "Corrupt or unsupported session catalog " << catalog_path
+                      << "; run session_catalog --rebuild" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        // Drop a partial entry left by a crash mid-append, or every later
+        // entry would be misaligned
+        const off_t whole = sizeof(header) + (st.st_size - sizeof(header)) / sizeof(entry) * sizeof(entry);
+        if (whole != st.st_size && ftruncate(fd, whole) != 0) {
+            ok = false;
+        }
+    }
+    ok = ok && write(fd, &entry, sizeof(entry)) == static_cast<ssize_t>(sizeof(entry));
+    if (!ok) {
+        std::cerr << "Failed to append to catalog " << catalog_path << ": " << strerror(errno) << std::endl;
+    }
+    ::close(fd);  // releases the lock
+    return ok;
+}
+
+bool write_session_catalog(const std::string& catalog_path, const std::vector<SessionCatalogEntry>& entries) {
+    const std::string temp_path = catalog_path + ".tmp";
+    std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create " << temp_path << std::endl;
+        return false;
+    }
+    SessionCatalogHeader header = {};
+    std::memcpy(header.magic, SESSION_CATALOG_MAGIC, sizeof(header.magic));
+    header.version = SESSION_CATALOG_VERSION;
+    header.entry_size = sizeof(SessionCatalogEntry);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SessionCatalogEntry));
+    file.close();
+    if (!file.good()) {
+        std::cerr << "Failed to write " << temp_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    if (std::rename(temp_path.c_str(), catalog_path.c_str()) != 0) {
+        std::cerr << "Failed to rename " << temp_path << " to " << catalog_path << ": " << strerror(errno) << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SessionCatalog::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open catalog " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SessionCatalogHeader)) {
+        std::cerr << "Not a session catalog: " << path << std::endl;
+        close();
+        return false;
+    }
+    mapping_size_ = st.st_size;
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "Failed to map catalog " << path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    const auto* header = static_cast<const SessionCatalogHeader*>(mapping_);
+    if (std::memcmp(header->magic, SESSION_CATALOG_MAGIC, 4) != 0 || header->version != SESSION_CATALOG_VERSION ||
+        header->entry_size != sizeof(SessionCatalogEntry)) {
+        std::cerr << "Corrupt or unsupported session catalog: " << path << std::endl;
+        close();
+        return false;
+    }
+    entries_ = reinterpret_cast<const SessionCatalogEntry*>(static_cast<const char*>(mapping_) + sizeof(SessionCatalogHeader));
+    // A partially appended last entry (crash mid-write) is ignored
+    num_entries_ = (mapping_size_ - sizeof(SessionCatalogHeader)) / sizeof(SessionCatalogEntry);
+    return true;
+}
+
+void SessionCatalog::close() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mapping_size_ = 0;
+    entries_ = nullptr;
+    num_entries_ = 0;
+}
+
+std::vector<size_t> SessionCatalog::latest() const {
+    std::vector<size_t> indices;
+    std::unordered_set<std::string> seen;
+    for (size_t i = num_entries_; i-- > 0;) {
+        const SessionCatalogEntry& entry = entries_[i];
+        if (seen.emplace(entry.name, strnlen(entry.name, sizeof(entry.name))).second) {
+            indices.push_back(i);
+        }
+    }
+    std::reverse(indices.begin(), indices.end());
+    return indices;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Catalog of the recordings under one output directory, so sessions can be
+    found by date, duration, drops or camera config without opening every
+    metadata.json and metrics.json.
+
+    <output_dir>/catalog.bin is a SessionCatalogHeader followed by fixed-size
+    SessionCatalogEntry records. Recorder appends one entry when a session
+    is finalized; tools/session_catalog --rebuild rescans every session
+    directory and renames a fresh file over it. Both hold flock(LOCK_EX) on
+    catalog.bin: the rebuild from before its scan until after the rename,
+    so appends wait for it and then go to the new file (a session finished
+    mid-scan is appended after the rebuild instead of being lost). Entries
+    are only ever appended, so a session can appear more than once: the
+    last entry for a name wins.
+*/
+
+constexpr char SESSION_CATALOG_MAGIC[4] = {'R', 'D', 'C', 'T'};
+constexpr uint32_t SESSION_CATALOG_VERSION = 2;       // 2: drops are frames, not gap events
+constexpr const char* SESSION_CATALOG_FILE_NAME = "catalog.bin";
+
+// SessionCatalogEntry::flags
+constexpr uint32_t SESSION_CATALOG_RAW_VIDEO = 1 << 0;        // lossless cam_*.yuyv
+constexpr uint32_t SESSION_CATALOG_JOINT_STATE = 1 << 1;      // joint_state.bin recorded
+constexpr uint32_t SESSION_CATALOG_COLUMNS = 1 << 2;          // session_columns.bin present
+constexpr uint32_t SESSION_CATALOG_PIPELINE_ERRORS = 1 << 3;  // GStreamer errors during capture
+
+struct SessionCatalogHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entry_size;
+    uint32_t reserved;
+};
+
+struct SessionCatalogEntry {
+    char name[64];                // session directory name, NUL-padded
+    uint64_t start_stamp;         // YYYYMMDDHHMMSS (local time) from recording_<date>_<time>
+    uint64_t duration_us;         // first to last bundle of the sync log
+    uint64_t bundles;             // total_frames from metrics.json
+    uint64_t skipped_bundles;     // dropped by the motion gate
+    uint32_t front_drops;         // frames missing per camera (sum of sequence gap sizes)
+    uint32_t right_drops;
+    uint16_t front_width;
+    uint16_t front_height;
+    uint16_t right_width;
+    uint16_t right_height;
+    uint16_t front_fps;
+    uint16_t right_fps;
+    uint32_t flags;               // SESSION_CATALOG_*
+    uint64_t reserved;
+};
+
+static_assert(sizeof(SessionCatalogHeader) == 16, "catalog header layout");
+static_assert(sizeof(SessionCatalogEntry) == 128, "catalog entries are two cache lines on disk");
+
+// Dropped frames over frames the cameras produced, both cameras together
+inline double session_catalog_drop_rate(const SessionCatalogEntry& entry) {
+    const double drops = static_cast<double>(entry.front_drops) + entry.right_drops;
+    const double produced = 2.0 * (entry.bundles + entry.skipped_bundles) + drops;
+    return produced > 0 ? drops / produced : 0.0;
+}
+
+// Fills `entry` from a finalized session's metadata.json, metrics.json and
+// sync log (or session_columns.bin when there is one)
+bool session_catalog_entry(const std::string& session_dir, SessionCatalogEntry& entry);
+
+// Opens catalog_path (creating it empty if needed) and takes LOCK_EX on it.
+// If the file was replaced while waiting, re-opens the new one, so the lock
+// is always on the file currently at catalog_path. Returns the fd (close it
+// to unlock) or -1.
+int lock_session_catalog(const std::string& catalog_path);
+
+// Appends one entry to the catalog file, creating it if needed
+bool append_session_catalog(const std::string& catalog_path, const SessionCatalogEntry& entry);
+
+// Replaces the catalog file with `entries` (written to a temporary and
+// renamed). Hold lock_session_catalog() across the scan and this call.
+bool write_session_catalog(const std::string& catalog_path, const std::vector<SessionCatalogEntry>& entries);
+
+class SessionCatalog {
+    public:
+        SessionCatalog() = default;
+        ~SessionCatalog() { close(); }
+
+        SessionCatalog(const SessionCatalog&) = delete;
+        SessionCatalog& operator=(const SessionCatalog&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        // Every entry in file order, superseded ones included
+        const SessionCatalogEntry* entries() const { return entries_; }
+        size_t size() const { return num_entries_; }
+
+        // Indices of the current entry of each session, in file order
+        std::vector<size_t> latest() const;
+
+    private:
+        int fd_ = -1;
+        void* mapping_ = nullptr;
+        size_t mapping_size_ = 0;
+        const SessionCatalogEntry* entries_ = nullptr;
+        size_t num_entries_ = 0;
+};
@@ -0,0 +1,265 @@
+#include "session_columns.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "jsonl_parse.hpp"
+
+namespace {
+
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+uint64_t align_up(uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+struct PendingColumn {
+    const char* name;
+    std::vector<int64_t> values;
+};
+
+void write_padding(std::ofstream& file, uint64_t& offset, uint64_t target) {
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    file.write(zeros, static_cast<std::streamsize>(target - offset));
+    offset = target;
+}
+
+}  // namespace
+
+bool compact_session_logs(
+    const std::string& sync_log_path, const std::string& events_path, const std::string& output_path
+) {
+    std::ifstream sync_log(sync_log_path);
+    if (!sync_log.is_open()) {
+        std::cerr << "Failed to open " << sync_log_path << std::endl;
+        return false;
+    }
+
+    std::vector<PendingColumn> columns = {
+        {COLUMN_SYNC_FRONT_TIMESTAMP_US, {}},
+        {COLUMN_SYNC_RIGHT_TIMESTAMP_US, {}},
+        {COLUMN_SYNC_FRONT_SEQ, {}},
+        {COLUMN_SYNC_RIGHT_SEQ, {}},
+        {COLUMN_SYNC_SEQ_NUM, {}},
+        {COLUMN_SYNC_SKEW_US, {}},
+        {COLUMN_SKIPPED_FIRST_TIMESTAMP_US, {}},
+        {COLUMN_SKIPPED_LAST_TIMESTAMP_US, {}},
+        {COLUMN_SKIPPED_COUNT, {}},
+        {COLUMN_EVENTS_TIMESTAMP_US, {}},
+        {COLUMN_EVENTS_TYPE, {}},
+    };
+    auto& front_ts = columns[0].values;
+    auto& right_ts = columns[1].values;
+    auto& front_seq = columns[2].values;
+    auto& right_seq = columns[3].values;
+    auto& seq_num = columns[4].values;
+    auto& skew = columns[5].values;
+    auto& skipped_first = columns[6].values;
+    auto& skipped_last = columns[7].values;
+    auto& skipped_count = columns[8].values;
+    auto& event_ts = columns[9].values;
+    auto& event_type = columns[10].values;
+
+    uint64_t source_bytes = 0;
+    std::string line;
+    while (std::getline(sync_log, line)) {
+        source_bytes += line.size() + 1;
+        uint64_t timestamp = 0, cam2_timestamp = 0, cam1_frame_id = 0, cam2_frame_id = 0, seq = 0;
+        if (sync_log_is_skipped_run(line)) {
+            jsonl_get_uint(line, "skipped_first_timestamp", timestamp);
+            jsonl_get_uint(line, "skipped_last_timestamp", cam2_timestamp);
+            jsonl_get_uint(line, "skipped_bundles", seq);
+            skipped_first.push_back(static_cast<int64_t>(timestamp));
+            skipped_last.push_back(static_cast<int64_t>(cam2_timestamp));
+            skipped_count.push_back(static_cast<int64_t>(seq));
+        } else if (jsonl_get_uint(line, "timestamp", timestamp)) {
+            // Logs from before cam2_timestamp was recorded: no skew information
+            if (!jsonl_get_uint(line, "cam2_timestamp", cam2_timestamp)) {
+                cam2_timestamp = timestamp;
+            }
+            jsonl_get_uint(line, "cam1_frame_id", cam1_frame_id);
+            jsonl_get_uint(line, "cam2_frame_id", cam2_frame_id);
+            jsonl_get_uint(line, "seq_num", seq);
+            front_ts.push_back(static_cast<int64_t>(timestamp));
+            right_ts.push_back(static_cast<int64_t>(cam2_timestamp));
+            front_seq.push_back(static_cast<int64_t>(cam1_frame_id));
+            right_seq.push_back(static_cast<int64_t>(cam2_frame_id));
+            seq_num.push_back(static_cast<int64_t>(seq));
+            skew.push_back(static_cast<int64_t>(cam2_timestamp) - static_cast<int64_t>(timestamp));
+        }
+    }
+
+    std::vector<std::string> event_types;
+    std::ifstream events(events_path);
+    while (events.is_open() && std::getline(events, line)) {
+        source_bytes += line.size() + 1;
+        uint64_t timestamp = 0;
+        std::string type;
+        if (!jsonl_get_uint(line, "timestamp_us", timestamp)) {
+            continue;
+        }
+        jsonl_get_string(line, "event_type", type);
+        auto it = std::find(event_types.begin(), event_types.end(), type);
+        if (it == event_types.end()) {
+            it = event_types.insert(it, type);
+        }
+        event_ts.push_back(static_cast<int64_t>(timestamp));
+        event_type.push_back(it - event_types.begin());
+    }
+
+    std::string dictionary;
+    for (const std::string& type : event_types) {
+        dictionary += type + "\n";
+    }
+
+    // Lay out: header, descriptors, dictionary, then each column's values and stats
+    SessionColumnsHeader header = {};
+    std::memcpy(header.magic, SESSION_COLUMNS_MAGIC, sizeof(header.magic));
+    header.version = SESSION_COLUMNS_VERSION;
+    header.block_rows = SESSION_COLUMNS_BLOCK_ROWS;
+    header.num_columns = static_cast<uint32_t>(columns.size());
+    header.dictionary_offset = sizeof(SessionColumnsHeader) + columns.size() * sizeof(SessionColumnDescriptor);
+    header.dictionary_size = dictionary.size();
+    header.source_bytes = source_bytes;
+
+    std::vector<SessionColumnDescriptor> descriptors(columns.size());
+    std::vector<std::vector<ColumnBlockStats>> stats(columns.size());
+    uint64_t offset = align_up(header.dictionary_offset + header.dictionary_size);
+    for (size_t c = 0; c < columns.size(); c++) {
+        const std::vector<int64_t>& values = columns[c].values;
+        for (size_t begin = 0; begin < values.size(); begin += SESSION_COLUMNS_BLOCK_ROWS) {
+            const size_t end = std::min(values.size(), begin + SESSION_COLUMNS_BLOCK_ROWS);
+            const auto [min, max] = std::minmax_element(values.begin() + begin, values.begin() + end);
+            stats[c].push_back({*min, *max});
+        }
+        SessionColumnDescriptor& descriptor = descriptors[c];
+        std::strncpy(descriptor.name, columns[c].name, sizeof(descriptor.name) - 1);
+        descriptor.num_blocks = static_cast<uint32_t>(stats[c].size());
+        descriptor.num_rows = values.size();
+        descriptor.data_offset = offset;
+        descriptor.stats_offset = align_up(offset + values.size() * sizeof(int64_t));
+        offset = align_up(descriptor.stats_offset + stats[c].size() * sizeof(ColumnBlockStats));
+    }
+
+    const std::string temp_path = output_path + ".tmp";
+    std::ofstream file(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Failed to create " << temp_path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(descriptors.data()), descriptors.size() * sizeof(SessionColumnDescriptor));
+    file.write(dictionary.data(), dictionary.size());
+    offset = header.dictionary_offset + header.dictionary_size;
+    for (size_t c = 0; c < columns.size(); c++) {
+        write_padding(file, offset, descriptors[c].data_offset);
+        file.write(reinterpret_cast<const char*>(columns[c].values.data()), columns[c].values.size() * sizeof(int64_t));
+        offset += columns[c].values.size() * sizeof(int64_t);
+        write_padding(file, offset, descriptors[c].stats_offset);
+        file.write(reinterpret_cast<const char*>(stats[c].data()), stats[c].size() * sizeof(ColumnBlockStats));
+        offset += stats[c].size() * sizeof(ColumnBlockStats);
+    }
+    file.close();
+    if (!file.good()) {
+        std::cerr << "Failed to write " << temp_path << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    if (std::rename(temp_path.c_str(), output_path.c_str()) != 0) {
+        std::cerr << "Failed to rename " << temp_path << " to " << output_path << ": " << strerror(errno) << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SessionColumns::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        std::cerr << "Failed to open " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SessionColumnsHeader)) {
+        std::cerr << "Not a session columns file: " << path << std::endl;
+        close();
+        return false;
+    }
+    mapping_size_ = st.st_size;
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        std::cerr << "Failed to map " << path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    const char* base = static_cast<const char*>(mapping_);
+    header_ = reinterpret_cast<const SessionColumnsHeader*>(base);
+    descriptors_ = reinterpret_cast<const SessionColumnDescriptor*>(base + sizeof(SessionColumnsHeader));
+    bool valid = std::memcmp(header_->magic, SESSION_COLUMNS_MAGIC, 4) == 0 &&
+        header_->version == SESSION_COLUMNS_VERSION && header_->block_rows > 0 &&
+        header_->dictionary_offset == sizeof(SessionColumnsHeader) + header_->num_columns * sizeof(SessionColumnDescriptor) &&
+        header_->dictionary_offset + header_->dictionary_size <= mapping_size_;
+    for (uint32_t c = 0; valid && c < header_->num_columns; c++) {
+        const SessionColumnDescriptor& descriptor = descriptors_[c];
+        valid = descriptor.data_offset % alignof(int64_t) == 0 &&
+            descriptor.data_offset + descriptor.num_rows * sizeof(int64_t) <= mapping_size_ &&
+            descriptor.stats_offset + descriptor.num_blocks * sizeof(ColumnBlockStats) <= mapping_size_;
+    }
+    if (!valid) {
+        std::cerr << "Corrupt or unsupported session columns file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    const std::string dictionary(base + header_->dictionary_offset, header_->dictionary_size);
+    for (size_t begin = 0, end; (end = dictionary.find('\n', begin)) != std::string::npos; begin = end + 1) {
+        event_types_.push_back(dictionary.substr(begin, end - begin));
+    }
+    return true;
+}
+
+void SessionColumns::close() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    mapping_size_ = 0;
+    header_ = nullptr;
+    descriptors_ = nullptr;
+    event_types_.clear();
+}
+
+ColumnView SessionColumns::column(const std::string& name) const {
+    ColumnView view;
+    if (!header_) {
+        return view;
+    }
+    const char* base = static_cast<const char*>(mapping_);
+    for (uint32_t c = 0; c < header_->num_columns; c++) {
+        const SessionColumnDescriptor& descriptor = descriptors_[c];
+        if (name.compare(0, std::string::npos, descriptor.name, strnlen(descriptor.name, sizeof(descriptor.name))) == 0) {
+            view.values = reinterpret_cast<const int64_t*>(base + descriptor.data_offset);
+            view.rows = descriptor.num_rows;
+            view.blocks = reinterpret_cast<const ColumnBlockStats*>(base + descriptor.stats_offset);
+            view.num_blocks = descriptor.num_blocks;
+            view.block_rows = header_->block_rows;
+            break;
+        }
+    }
+    return view;
+}
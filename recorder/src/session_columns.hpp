@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/*
+    Columnar copy of a session's logs for analytics. sync_log.jsonl and
+    events.jsonl are parsed once (at the end of a recording with
+    --compact-logs, or later with tools/session_compact) into
+    session_columns.bin:
+
+      SessionColumnsHeader
+      SessionColumnDescriptor[num_columns]
+      event type dictionary ('\n'-separated; events.type indexes it)
+      per column: int64 values[num_rows], then ColumnBlockStats[num_blocks]
+
+    Every column is a plain little-endian int64 array starting on a 64-byte
+    boundary, with min/max for each block of block_rows rows, so readers
+    mmap the file and run straight loops over it (or np.memmap a column at
+    data_offset) and skip whole blocks using the stats. Row i of the sync.*
+    columns is row i of the sync log's video-frame rows.
+*/
+
+constexpr char SESSION_COLUMNS_MAGIC[4] = {'R', 'D', 'C', 'L'};
+constexpr uint32_t SESSION_COLUMNS_VERSION = 1;
+constexpr uint32_t SESSION_COLUMNS_BLOCK_ROWS = 4096;
+constexpr const char* SESSION_COLUMNS_FILE_NAME = "session_columns.bin";
+
+// sync_log.jsonl video-frame rows
+constexpr const char* COLUMN_SYNC_FRONT_TIMESTAMP_US = "sync.front_timestamp_us";
+constexpr const char* COLUMN_SYNC_RIGHT_TIMESTAMP_US = "sync.right_timestamp_us";
+constexpr const char* COLUMN_SYNC_FRONT_SEQ = "sync.front_seq";
+constexpr const char* COLUMN_SYNC_RIGHT_SEQ = "sync.right_seq";
+constexpr const char* COLUMN_SYNC_SEQ_NUM = "sync.seq_num";
+constexpr const char* COLUMN_SYNC_SKEW_US = "sync.skew_us";            // right - front capture time
+// sync_log.jsonl runs dropped by the motion gate
+constexpr const char* COLUMN_SKIPPED_FIRST_TIMESTAMP_US = "skipped.first_timestamp_us";
+constexpr const char* COLUMN_SKIPPED_LAST_TIMESTAMP_US = "skipped.last_timestamp_us";
+constexpr const char* COLUMN_SKIPPED_COUNT = "skipped.count";
+// events.jsonl rows with a timestamp_us
+constexpr const char* COLUMN_EVENTS_TIMESTAMP_US = "events.timestamp_us";
+constexpr const char* COLUMN_EVENTS_TYPE = "events.type";              // index into the dictionary
+
+struct SessionColumnsHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t block_rows;
+    uint32_t num_columns;
+    uint64_t dictionary_offset;
+    uint64_t dictionary_size;
+    uint64_t source_bytes;        // size of the logs that were compacted
+    uint8_t reserved[24];
+};
+
+struct SessionColumnDescriptor {
+    char name[32];                // NUL-padded
+    uint32_t num_blocks;
+    uint32_t reserved;
+    uint64_t num_rows;
+    uint64_t data_offset;         // int64_t[num_rows]
+    uint64_t stats_offset;        // ColumnBlockStats[num_blocks]
+};
+
+struct ColumnBlockStats {
+    int64_t min;
+    int64_t max;
+};
+
+static_assert(sizeof(SessionColumnsHeader) == 64, "header is one cache line on disk");
+static_assert(sizeof(SessionColumnDescriptor) == 64, "descriptor is one cache line on disk");
+
+// One mapped column; empty (rows == 0) if the file doesn't have it
+struct ColumnView {
+    const int64_t* values = nullptr;
+    uint64_t rows = 0;
+    const ColumnBlockStats* blocks = nullptr;
+    uint32_t num_blocks = 0;
+    uint32_t block_rows = 0;
+};
+
+// Parses the two logs into `output_path` (written to a temporary file and
+// renamed, so readers never see a partial one). A missing events log just
+// gives empty events columns.
+bool compact_session_logs(
+    const std::string& sync_log_path, const std::string& events_path, const std::string& output_path
+);
+
+class SessionColumns {
+    public:
+        SessionColumns() = default;
+        ~SessionColumns() { close(); }
+
+        SessionColumns(const SessionColumns&) = delete;
+        SessionColumns& operator=(const SessionColumns&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        ColumnView column(const std::string& name) const;
+        const std::vector<std::string>& event_types() const { return event_types_; }
+        uint64_t source_bytes() const { return header_ ? header_->source_bytes : 0; }
+
+    private:
+        int fd_ = -1;
+        void* mapping_ = nullptr;
+        size_t mapping_size_ = 0;
+        const SessionColumnsHeader* header_ = nullptr;
+        const SessionColumnDescriptor* descriptors_ = nullptr;
+        std::vector<std::string> event_types_;
+};
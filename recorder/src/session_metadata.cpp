@@ -0,0 +1,96 @@
+#include "session_metadata.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstdint>
+
+#include "jsonl_parse.hpp"
+
+bool read_session_camera_config(
+    const std::string& session_dir, const std::string& device_name, SessionCameraConfig& config
+) {
+    std::ifstream metadata_file(session_dir + "/metadata.json");
+    if (!metadata_file.is_open()) {
+        std::cerr << "Failed to open " << session_dir << "/metadata.json" << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << metadata_file.rdbuf();
+    const std::string metadata = buffer.str();
+
+    // "<device>": { "width": .., "height": .., "frame_rate": .. }
+    size_t block_start = metadata.find("\"" + device_name + "\"");
+    size_t block_end = metadata.find('}', block_start);
+    if (block_start == std::string::npos || block_end == std::string::npos) {
+        std::cerr << "No camera_config for " << device_name << " in " << session_dir << "/metadata.json" << std::endl;
+        return false;
+    }
+    std::string block = metadata.substr(block_start, block_end - block_start);
+    uint64_t width = 0, height = 0, frame_rate = 0;
+    if (!jsonl_get_uint(block, "width", width) || !jsonl_get_uint(block, "height", height) ||
+        !jsonl_get_uint(block, "frame_rate", frame_rate)) {
+        std::cerr << "Incomplete camera_config for " << device_name << " in " << session_dir << std::endl;
+        return false;
+    }
+    config.device_name = device_name;
+    config.width = static_cast<int>(width);
+    config.height = static_cast<int>(height);
+    config.frame_rate = static_cast<int>(frame_rate);
+    return true;
+}
+
+namespace {
+
+bool read_manifest_entry(const std::string& session_dir, const std::string& key, std::string& path) {
+    std::ifstream metadata_file(session_dir + "/metadata.json");
+    if (!metadata_file.is_open()) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << metadata_file.rdbuf();
+    const std::string metadata = buffer.str();
+
+    size_t block_start = metadata.find("\"output_files\"");
+    size_t block_end = metadata.find('}', block_start);
+    if (block_start == std::string::npos || block_end == std::string::npos) {
+        return false;
+    }
+    return jsonl_get_string(metadata.substr(block_start, block_end - block_start), key.c_str(), path) &&
+        std::ifstream(path).good();
+}
+
+}  // namespace
+
+std::string session_output_file(
+    const std::string& session_dir, const std::string& key, const std::string& default_name
+) {
+    std::string path;
+    if (read_manifest_entry(session_dir, key, path)) {
+        return path;
+    }
+    return session_dir + "/" + default_name;
+}
+
+std::string find_session_video(const std::string& session_dir, const std::string& stem, bool& is_raw) {
+    const std::string key = stem == "cam_front" ? "front_camera_video"
+        : stem == "cam_right" ? "right_camera_video" : stem + "_video";
+    std::string manifest_path;
+    if (read_manifest_entry(session_dir, key, manifest_path)) {
+        const std::string raw_ext = ".yuyv";
+        is_raw = manifest_path.size() >= raw_ext.size() &&
+            manifest_path.compare(manifest_path.size() - raw_ext.size(), raw_ext.size(), raw_ext) == 0;
+        return manifest_path;
+    }
+    std::string raw_path = session_dir + "/" + stem + ".yuyv";
+    if (std::ifstream(raw_path).good()) {
+        is_raw = true;
+        return raw_path;
+    }
+    std::string mp4_path = session_dir + "/" + stem + ".mp4";
+    if (std::ifstream(mp4_path).good()) {
+        is_raw = false;
+        return mp4_path;
+    }
+    return "";
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+// Per-camera capture settings as recorded in a session's metadata.json.
+struct SessionCameraConfig {
+    std::string device_name;
+    int width = 0;
+    int height = 0;
+    int frame_rate = 0;
+};
+
+// Reads the camera_config block for `device_name` from
+// <session_dir>/metadata.json (as written by MetadataWriter).
+bool read_session_camera_config(
+    const std::string& session_dir, const std::string& device_name, SessionCameraConfig& config
+);
+
+// File `key` of the session's output_files manifest in metadata.json; parts
+// of a session can live on other disks (--storage). Falls back to
+// <session_dir>/<default_name> when the manifest doesn't list it or the
+// listed file isn't there.
+std::string session_output_file(
+    const std::string& session_dir, const std::string& key, const std::string& default_name
+);
+
+// Camera video of a session: the manifest's entry for it if that exists,
+// else prefers the lossless <stem>.yuyv, falls back to <stem>.mp4. Returns
+// an empty path if none exists.
+std::string find_session_video(const std::string& session_dir, const std::string& stem, bool& is_raw);
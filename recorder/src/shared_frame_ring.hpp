@@ -0,0 +1,430 @@
+/*
+Goal: Let other local processes (Python QC, teleop, VR tooling) see live
+camera frames while the recorder owns the devices, without copying frames
+through a socket and without a slow reader ever holding up the recorder.
+
+One POSIX shared memory object per camera, e.g. /robodaq_frames_cam_front:
+
+    FrameRingHeader     magic "RDFR", version, slot_count, slot_bytes,
+                        data_offset, published (frames written so far),
+                        writer_open
+    FrameSlotDescriptor slot_count of them, one cache line each
+    slot data           slot_count * slot_bytes, page aligned
+
+Frame k goes into slot k % slot_count. Each slot descriptor is a seqlock:
+state = 2k+1 while frame k is being written, 2k+2 once it is complete. The
+writer never looks at readers, so it is wait-free and readers can't block it;
+a reader that falls behind loses frames, never the recorder.
+
+Readers map the object read-only and read pixels in place (zero-copy):
+    SharedFrameView view;
+    while (reader.next(view)) {
+        use(view.data, view.info);
+        if (!reader.still_valid(view)) discard();   // writer lapped us mid-read
+    }
+
+The protocol is plain fixed-size fields, so a reader in another language only
+needs the layout below. Readers should reopen when writer_closed() turns true
+(the recorder restarted and created a fresh object).
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t FRAME_RING_MAGIC = 0x52464452;  // "RDFR"
+constexpr uint32_t FRAME_RING_VERSION = 1;
+constexpr const char* FRAME_SHM_DEFAULT_PREFIX = "/robodaq_frames";
+constexpr int FRAME_SHM_DEFAULT_SLOTS = 8;
+
+constexpr uint32_t frame_fourcc(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// V4L2 fourccs, so readers can hand frames straight to their usual decoders
+constexpr uint32_t FRAME_FOURCC_YUYV = frame_fourcc('Y', 'U', 'Y', 'V');
+constexpr uint32_t FRAME_FOURCC_RGB = frame_fourcc('R', 'G', 'B', '3');
+constexpr uint32_t FRAME_FOURCC_GRAY = frame_fourcc('G', 'R', 'E', 'Y');
+
+// Per-frame metadata carried in the slot descriptor
+struct SharedFrameInfo {
+    uint64_t frame_sequence = 0;   // camera sequence number
+    uint64_t timestamp_us = 0;     // capture timestamp
+    uint64_t publish_ns = 0;       // steady clock when the slot was completed
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t fourcc = 0;
+    uint32_t size_bytes = 0;
+};
+
+// What a reader gets back: metadata plus a pointer into the shared mapping
+struct SharedFrameView {
+    SharedFrameInfo info;
+    const uint8_t* data = nullptr;
+    uint64_t ring_sequence = 0;
+};
+
+struct FrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t reserved;
+    uint64_t slot_bytes;
+    uint64_t data_offset;
+    alignas(64) std::atomic<uint64_t> published;
+    std::atomic<uint32_t> writer_open;
+};
+
+struct FrameSlotDescriptor {
+    alignas(64) std::atomic<uint64_t> state;
+    std::atomic<uint64_t> frame_sequence;
+    std::atomic<uint64_t> timestamp_us;
+    std::atomic<uint64_t> publish_ns;
+    std::atomic<uint32_t> width;
+    std::atomic<uint32_t> height;
+    std::atomic<uint32_t> fourcc;
+    std::atomic<uint32_t> size_bytes;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared frame ring needs lock-free 64-bit atomics");
+static_assert(sizeof(FrameSlotDescriptor) == 64, "one descriptor per cache line");
+
+inline size_t frame_ring_data_offset(uint32_t slot_count) {
+    size_t descriptors_end = sizeof(FrameRingHeader) + slot_count * sizeof(FrameSlotDescriptor);
+    return (descriptors_end + 4095) & ~static_cast<size_t>(4095);
+}
+
+inline uint64_t frame_ring_now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+class SharedFrameWriter {
+    public:
+        SharedFrameWriter() = default;
+        ~SharedFrameWriter();
+
+        SharedFrameWriter(const SharedFrameWriter&) = delete;
+        SharedFrameWriter& operator=(const SharedFrameWriter&) = delete;
+
+        // Creates (or takes over) the named shm object with slot_count slots of
+        // slot_bytes each. The object is unlinked when the writer is destroyed.
+        bool create(const std::string& name, uint32_t slot_count, size_t slot_bytes);
+
+        // Zero-copy publish: write up to slot_bytes() into the returned slot,
+        // then end_write(). Marks the slot invalid for readers until then.
+        uint8_t* begin_write();
+        void end_write(const SharedFrameInfo& info);
+
+        // begin_write + memcpy + end_write; false if the frame doesn't fit a slot
+        bool publish(const SharedFrameInfo& info, const uint8_t* data);
+
+        // Marks the ring closed for readers, then unmaps and unlinks it
+        void close();
+
+        uint64_t published() const;
+        size_t slot_bytes() const;
+        size_t mapped_bytes() const;
+
+    private:
+        uint8_t* mapping_ = nullptr;
+        size_t mapping_bytes_ = 0;
+        FrameRingHeader* header_ = nullptr;
+        FrameSlotDescriptor* slots_ = nullptr;
+        std::string shm_name_;
+        uint64_t next_sequence_ = 0;
+};
+
+class SharedFrameReader {
+    public:
+        SharedFrameReader() = default;
+        ~SharedFrameReader();
+
+        SharedFrameReader(const SharedFrameReader&) = delete;
+        SharedFrameReader& operator=(const SharedFrameReader&) = delete;
+
+        // Maps an existing ring read-only and starts at the newest frame
+        bool open(const std::string& name);
+
+        // Next unread frame, or false if caught up. A reader more than half a
+        // ring behind jumps to the newest frame; skipped frames count as dropped.
+        bool next(SharedFrameView& view);
+
+        // Newest complete frame, skipping anything older
+        bool latest(SharedFrameView& view);
+
+        // True if the writer hasn't started overwriting view's slot. Call after
+        // reading view.data in place; if false, what was read may be torn.
+        bool still_valid(const SharedFrameView& view) const;
+
+        uint64_t dropped() const;
+        uint64_t published() const;
+        uint32_t slot_count() const;
+
+        // The recorder stopped; a new one will create a fresh object, so reopen
+        bool writer_closed() const;
+
+    private:
+        bool read_slot_(uint64_t sequence, SharedFrameView& view) const;
+        void release_();
+
+        const uint8_t* mapping_ = nullptr;
+        size_t mapping_bytes_ = 0;
+        const FrameRingHeader* header_ = nullptr;
+        const FrameSlotDescriptor* slots_ = nullptr;
+        uint64_t cursor_ = 0;
+        uint64_t dropped_ = 0;
+};
+
+inline SharedFrameWriter::~SharedFrameWriter() {
+    close();
+}
+
+inline void SharedFrameWriter::close() {
+    if (mapping_) {
+        header_->writer_open.store(0, std::memory_order_release);
+        munmap(mapping_, mapping_bytes_);
+        shm_unlink(shm_name_.c_str());
+    }
+    mapping_ = nullptr;
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+inline bool SharedFrameWriter::create(const std::string& name, uint32_t slot_count, size_t slot_bytes) {
+    if (slot_count < 2 || slot_bytes == 0 || slot_bytes > UINT32_MAX) {
+        std::cerr << "SharedFrameWriter: need at least 2 slots of 1..4G bytes" << std::endl;
+        return false;
+    }
+    slot_bytes = (slot_bytes + 4095) & ~static_cast<size_t>(4095);
+    const size_t data_offset = frame_ring_data_offset(slot_count);
+    const size_t total_bytes = data_offset + slot_count * slot_bytes;
+
+    // A previous recorder may have died without unlinking; its readers keep their own mapping
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "SharedFrameWriter: cannot create shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, total_bytes) != 0) {
+        std::cerr << "SharedFrameWriter: cannot size shm " << name << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* mapping = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "SharedFrameWriter: cannot map shm " << name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    close();
+    mapping_ = static_cast<uint8_t*>(mapping);
+    mapping_bytes_ = total_bytes;
+    shm_name_ = name;
+    header_ = reinterpret_cast<FrameRingHeader*>(mapping_);
+    slots_ = reinterpret_cast<FrameSlotDescriptor*>(mapping_ + sizeof(FrameRingHeader));
+    next_sequence_ = 0;
+
+    // ftruncate zero-fills, so every slot starts in state 0 (never written)
+    header_->version = FRAME_RING_VERSION;
+    header_->slot_count = slot_count;
+    header_->reserved = 0;
+    header_->slot_bytes = slot_bytes;
+    header_->data_offset = data_offset;
+    header_->published.store(0, std::memory_order_relaxed);
+    header_->writer_open.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // Readers validate magic last
+    header_->magic = FRAME_RING_MAGIC;
+    return true;
+}
+
+inline uint8_t* SharedFrameWriter::begin_write() {
+    const uint64_t sequence = next_sequence_;
+    FrameSlotDescriptor& slot = slots_[sequence % header_->slot_count];
+    slot.state.store(2 * sequence + 1, std::memory_order_relaxed);
+    // Odd state must be visible before any pixel or field changes
+    std::atomic_thread_fence(std::memory_order_release);
+    return mapping_ + header_->data_offset + (sequence % header_->slot_count) * header_->slot_bytes;
+}
+
+inline void SharedFrameWriter::end_write(const SharedFrameInfo& info) {
+    const uint64_t sequence = next_sequence_++;
+    FrameSlotDescriptor& slot = slots_[sequence % header_->slot_count];
+    slot.frame_sequence.store(info.frame_sequence, std::memory_order_relaxed);
+    slot.timestamp_us.store(info.timestamp_us, std::memory_order_relaxed);
+    slot.publish_ns.store(frame_ring_now_ns(), std::memory_order_relaxed);
+    slot.width.store(info.width, std::memory_order_relaxed);
+    slot.height.store(info.height, std::memory_order_relaxed);
+    slot.fourcc.store(info.fourcc, std::memory_order_relaxed);
+    slot.size_bytes.store(info.size_bytes, std::memory_order_relaxed);
+    slot.state.store(2 * sequence + 2, std::memory_order_release);
+    header_->published.store(sequence + 1, std::memory_order_release);
+}
+
+inline bool SharedFrameWriter::publish(const SharedFrameInfo& info, const uint8_t* data) {
+    if (info.size_bytes > header_->slot_bytes) {
+        return false;
+    }
+    std::memcpy(begin_write(), data, info.size_bytes);
+    end_write(info);
+    return true;
+}
+
+inline uint64_t SharedFrameWriter::published() const {
+    return next_sequence_;
+}
+
+inline size_t SharedFrameWriter::slot_bytes() const {
+    return header_ ? header_->slot_bytes : 0;
+}
+
+inline size_t SharedFrameWriter::mapped_bytes() const {
+    return mapping_bytes_;
+}
+
+inline SharedFrameReader::~SharedFrameReader() {
+    release_();
+}
+
+inline void SharedFrameReader::release_() {
+    if (mapping_) {
+        munmap(const_cast<uint8_t*>(mapping_), mapping_bytes_);
+    }
+    mapping_ = nullptr;
+    header_ = nullptr;
+    slots_ = nullptr;
+}
+
+inline bool SharedFrameReader::open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "SharedFrameReader: cannot open shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FrameRingHeader)) {
+        std::cerr << "SharedFrameReader: shm " << name << " is not a frame ring" << std::endl;
+        close(fd);
+        return false;
+    }
+    const size_t total_bytes = st.st_size;
+    void* mapping = mmap(nullptr, total_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "SharedFrameReader: cannot map shm " << name << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    const auto* header = static_cast<const FrameRingHeader*>(mapping);
+    if (header->magic != FRAME_RING_MAGIC || header->version != FRAME_RING_VERSION ||
+        header->data_offset != frame_ring_data_offset(header->slot_count) ||
+        header->data_offset + header->slot_count * header->slot_bytes > total_bytes) {
+        std::cerr << "SharedFrameReader: shm " << name << " has a different layout" << std::endl;
+        munmap(mapping, total_bytes);
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    release_();
+    mapping_ = static_cast<const uint8_t*>(mapping);
+    mapping_bytes_ = total_bytes;
+    header_ = header;
+    slots_ = reinterpret_cast<const FrameSlotDescriptor*>(mapping_ + sizeof(FrameRingHeader));
+    const uint64_t published = header_->published.load(std::memory_order_acquire);
+    cursor_ = published ? published - 1 : 0;
+    dropped_ = 0;
+    return true;
+}
+
+inline bool SharedFrameReader::read_slot_(uint64_t sequence, SharedFrameView& view) const {
+    const FrameSlotDescriptor& slot = slots_[sequence % header_->slot_count];
+    const uint64_t expected = 2 * sequence + 2;
+    if (slot.state.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    view.info.frame_sequence = slot.frame_sequence.load(std::memory_order_relaxed);
+    view.info.timestamp_us = slot.timestamp_us.load(std::memory_order_relaxed);
+    view.info.publish_ns = slot.publish_ns.load(std::memory_order_relaxed);
+    view.info.width = slot.width.load(std::memory_order_relaxed);
+    view.info.height = slot.height.load(std::memory_order_relaxed);
+    view.info.fourcc = slot.fourcc.load(std::memory_order_relaxed);
+    view.info.size_bytes = slot.size_bytes.load(std::memory_order_relaxed);
+    // Field loads must complete before the state is re-checked
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.state.load(std::memory_order_relaxed) != expected ||
+        view.info.size_bytes > header_->slot_bytes) {
+        return false;
+    }
+    view.data = mapping_ + header_->data_offset + (sequence % header_->slot_count) * header_->slot_bytes;
+    view.ring_sequence = sequence;
+    return true;
+}
+
+inline bool SharedFrameReader::next(SharedFrameView& view) {
+    while (true) {
+        const uint64_t published = header_->published.load(std::memory_order_acquire);
+        if (cursor_ >= published) {
+            return false;
+        }
+        if (published - cursor_ > header_->slot_count / 2) {
+            dropped_ += published - 1 - cursor_;
+            cursor_ = published - 1;
+        }
+        if (read_slot_(cursor_, view)) {
+            cursor_++;
+            return true;
+        }
+        // Overwritten between the published load and the descriptor read
+        dropped_++;
+        cursor_++;
+    }
+}
+
+inline bool SharedFrameReader::latest(SharedFrameView& view) {
+    const uint64_t published = header_->published.load(std::memory_order_acquire);
+    if (published > cursor_ + 1) {
+        dropped_ += published - 1 - cursor_;
+        cursor_ = published - 1;
+    }
+    return next(view);
+}
+
+inline bool SharedFrameReader::still_valid(const SharedFrameView& view) const {
+    // Pixel reads must complete before the state is re-checked
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const FrameSlotDescriptor& slot = slots_[view.ring_sequence % header_->slot_count];
+    return slot.state.load(std::memory_order_relaxed) == 2 * view.ring_sequence + 2;
+}
+
+inline uint64_t SharedFrameReader::dropped() const {
+    return dropped_;
+}
+
+inline uint64_t SharedFrameReader::published() const {
+    return header_ ? header_->published.load(std::memory_order_acquire) : 0;
+}
+
+inline uint32_t SharedFrameReader::slot_count() const {
+    return header_ ? header_->slot_count : 0;
+}
+
+inline bool SharedFrameReader::writer_closed() const {
+    return !header_ || header_->writer_open.load(std::memory_order_acquire) == 0;
+}
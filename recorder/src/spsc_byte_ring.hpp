@@ -0,0 +1,191 @@
+/*
+Goal: Single-producer/single-consumer transport for variable-size records
+(log lines, JSON events, compressed frames) without a heap allocation per
+record or a fixed slot size.
+
+Layout: one contiguous power-of-two byte array. Each record is an 8-byte
+header (payload size, flags) followed by the payload, padded to 8 bytes so
+payloads stay 8-byte aligned. A record never wraps: if it doesn't fit before
+the end of the array, the producer writes a padding header over the rest and
+starts the record at offset 0.
+
+Zero-copy on both sides:
+    Producer: reserve(n) -> write into the returned pointer -> commit(used <= n)
+    Consumer: peek(size) -> read in place -> release()
+
+Back-pressure: reserve() returns nullptr when the ring is full (caller decides
+whether to drop or retry), same as SPSCRingBuffer::push returning false.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+class SPSCByteRing {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit SPSCByteRing(size_t capacity_bytes);
+
+        // Producer: contiguous space for a payload of up to max_size bytes,
+        // or nullptr if the ring is full. Must be followed by commit().
+        uint8_t* reserve(size_t max_size);
+
+        // Producer: publish the reserved record with its final payload size
+        void commit(size_t size);
+
+        // Producer: reserve + memcpy + commit
+        bool push(const void* data, size_t size);
+
+        // Consumer: oldest record in place, or nullptr if empty. Stays valid until release().
+        const uint8_t* peek(size_t& size);
+
+        // Consumer: drop the record returned by the last peek()
+        void release();
+
+        // Largest payload a single record can carry
+        size_t max_record_size() const;
+
+        size_t capacity() const;
+
+        // Bytes in flight, including headers and padding
+        size_t used_bytes() const;
+
+        bool is_empty() const;
+
+    private:
+        static constexpr size_t HEADER_SIZE = 8;
+        static constexpr uint32_t FLAG_PADDING = 1;
+
+        struct RecordHeader {
+            uint32_t size;
+            uint32_t flags;
+        };
+
+        static size_t record_span_(size_t payload_size) {
+            return (HEADER_SIZE + payload_size + 7) & ~static_cast<size_t>(7);
+        }
+
+        std::unique_ptr<uint8_t[]> buffer_;
+        size_t capacity_;
+        size_t mask_;
+
+        // Producer-owned
+        alignas(64) std::atomic<uint64_t> write_pos_{0};
+        uint64_t cached_read_pos_ = 0;
+        uint64_t reserved_pos_ = 0;     // where the pending record's header goes
+        size_t reserved_size_ = 0;
+
+        // Consumer-owned
+        alignas(64) std::atomic<uint64_t> read_pos_{0};
+        uint64_t cached_write_pos_ = 0;
+        uint64_t peeked_pos_ = 0;
+        size_t peeked_span_ = 0;
+};
+
+inline SPSCByteRing::SPSCByteRing(size_t capacity_bytes) {
+    capacity_ = 64;
+    while (capacity_ < capacity_bytes) {
+        capacity_ <<= 1;
+    }
+    mask_ = capacity_ - 1;
+    // 8-byte records need an 8-byte aligned base
+    buffer_ = std::make_unique<uint8_t[]>(capacity_);
+    assert(reinterpret_cast<uintptr_t>(buffer_.get()) % 8 == 0);
+}
+
+inline uint8_t* SPSCByteRing::reserve(size_t max_size) {
+    if (max_size > max_record_size()) {
+        return nullptr;
+    }
+    const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    const size_t offset = write_pos & mask_;
+    const size_t tail_room = capacity_ - offset;
+    const size_t span = record_span_(max_size);
+    const size_t padding = span > tail_room ? tail_room : 0;
+
+    // Only re-read the consumer's index when the cached one says we're full
+    if (write_pos + padding + span - cached_read_pos_ > capacity_) {
+        cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+        if (write_pos + padding + span - cached_read_pos_ > capacity_) {
+            return nullptr;
+        }
+    }
+
+    if (padding) {
+        RecordHeader pad{static_cast<uint32_t>(padding - HEADER_SIZE), FLAG_PADDING};
+        std::memcpy(buffer_.get() + offset, &pad, sizeof(pad));
+    }
+    reserved_pos_ = write_pos + padding;
+    reserved_size_ = max_size;
+    return buffer_.get() + (reserved_pos_ & mask_) + HEADER_SIZE;
+}
+
+inline void SPSCByteRing::commit(size_t size) {
+    assert(size <= reserved_size_);
+    RecordHeader header{static_cast<uint32_t>(size), 0};
+    std::memcpy(buffer_.get() + (reserved_pos_ & mask_), &header, sizeof(header));
+    // Release makes header and payload visible before the new write position
+    write_pos_.store(reserved_pos_ + record_span_(size), std::memory_order_release);
+    reserved_size_ = 0;
+}
+
+inline bool SPSCByteRing::push(const void* data, size_t size) {
+    uint8_t* payload = reserve(size);
+    if (!payload) {
+        return false;
+    }
+    std::memcpy(payload, data, size);
+    commit(size);
+    return true;
+}
+
+inline const uint8_t* SPSCByteRing::peek(size_t& size) {
+    uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+    while (true) {
+        if (read_pos == cached_write_pos_) {
+            cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
+            if (read_pos == cached_write_pos_) {
+                return nullptr;
+            }
+        }
+
+        RecordHeader header;
+        std::memcpy(&header, buffer_.get() + (read_pos & mask_), sizeof(header));
+        if (header.flags & FLAG_PADDING) {
+            // Skip to the start of the array; the producer gets the space back on release()
+            read_pos += HEADER_SIZE + header.size;
+            continue;
+        }
+
+        peeked_pos_ = read_pos;
+        peeked_span_ = record_span_(header.size);
+        size = header.size;
+        return buffer_.get() + (read_pos & mask_) + HEADER_SIZE;
+    }
+}
+
+inline void SPSCByteRing::release() {
+    read_pos_.store(peeked_pos_ + peeked_span_, std::memory_order_release);
+    peeked_span_ = 0;
+}
+
+inline size_t SPSCByteRing::max_record_size() const {
+    // Worst case a record also needs a full tail of padding in front of it
+    return capacity_ / 2 - HEADER_SIZE;
+}
+
+inline size_t SPSCByteRing::capacity() const {
+    return capacity_;
+}
+
+inline size_t SPSCByteRing::used_bytes() const {
+    return write_pos_.load(std::memory_order_acquire) - read_pos_.load(std::memory_order_acquire);
+}
+
+inline bool SPSCByteRing::is_empty() const {
+    return used_bytes() == 0;
+}
@@ -20,6 +20,7 @@ Critical Behaviors:
 #include <atomic>
 #include <cassert>
 #include <iostream>
+#include <memory>
 
 template<typename T>
 class SPSCRingBuffer {
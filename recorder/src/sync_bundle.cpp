@@ -0,0 +1,111 @@
+#include "sync_bundle.hpp"
+
+#include "alloc_stats.hpp"
+
+SyncBundleResult sync_next_bundle(const SyncBundleStages& stages) {
+    // Try to get front frame. Frames are read in place from the ring; the
+    // striper holds the slots of queued ones after we release them.
+    const CameraFrame* front_slot = stages.front_ring ? stages.front_ring->peek(stages.front_consumer) : nullptr;
+    if (!front_slot) {
+        ROBODAQ_PROBE(ring_pop, "/dev/cam_front", 0, 0, 0);
+        return SyncBundleResult::NO_FRONT_FRAME;
+    }
+    const CameraFrame& front_frame = *front_slot;
+    ROBODAQ_PROBE(ring_pop, front_frame.device_name.c_str(), front_frame.sequence_number, front_frame.timestamp_us, 1);
+
+    // Look for the matching right frame; see SyncMatcher for the policies
+    SyncRingSource right_source(stages.right_ring, stages.right_consumer, stages.performance_monitor);
+    SyncMatch match = stages.matcher->match(front_frame.timestamp_us, right_source);
+    const CameraFrame* right_slot = match.matched ? right_source.peek() : nullptr;
+
+    if (!match.matched) {
+        if (match.discarded == 0 && !right_source.peek()) {
+            ROBODAQ_PROBE(ring_pop, "/dev/cam_right", 0, 0, 0);
+        }
+        ROBODAQ_PROBE(sync_miss, front_frame.sequence_number, front_frame.timestamp_us);
+        std::cout << "SYNC: No matching right frame for front ts=" << front_frame.timestamp_us << std::endl;
+        if (stages.flight_recorder) {
+            stages.flight_recorder->record_event(
+                FlightEventCode::SYNC_MISS, front_frame.timestamp_us, front_frame.sequence_number
+            );
+        }
+        if (stages.performance_monitor) {
+            stages.performance_monitor->tick_unmatched(
+                {&front_frame.device_name, {front_frame.timestamp_us, front_frame.sequence_number, 0}}, "sync_miss"
+            );
+        }
+        stages.front_ring->release(stages.front_consumer);
+        stages.striper->retire();
+        return SyncBundleResult::SYNC_MISS;
+    }
+    const CameraFrame& right_frame = *right_slot;
+    ROBODAQ_PROBE(sync_match, front_frame.sequence_number, right_frame.sequence_number,
+                  front_frame.timestamp_us, right_frame.timestamp_us);
+
+    if (stages.motion_gate) {
+        MotionDecision decision = stages.motion_gate->update(front_frame, right_frame);
+        if (decision.state_changed && stages.performance_monitor) {
+            std::ostringstream event;
+            event << "{\"timestamp_us\":" << front_frame.timestamp_us
+                  << ",\"event_type\":\"" << (decision.active ? "motion_active" : "motion_idle") << "\""
+                  << ",\"score\":" << decision.score << "}";
+            stages.performance_monitor->log_event(event.str());
+        }
+        if (decision.ended_run.count > 0 && stages.sync_logger) {
+            const SkippedRun& run = decision.ended_run;
+            stages.sync_logger->log_skipped_run(
+                run.first_timestamp_us, run.last_timestamp_us, run.first_seq, run.last_seq, run.count
+            );
+        }
+        if (!decision.keep) {
+            ROBODAQ_PROBE(bundle_skipped, front_frame.sequence_number, right_frame.sequence_number,
+                          front_frame.timestamp_us, right_frame.timestamp_us);
+            if (stages.performance_monitor) {
+                stages.performance_monitor->tick_skipped({
+                    {&front_frame.device_name, {front_frame.timestamp_us, front_frame.sequence_number, 0}},
+                    {&right_frame.device_name, {right_frame.timestamp_us, right_frame.sequence_number, 0}}
+                });
+            }
+            stages.front_ring->release(stages.front_consumer);
+            stages.right_ring->release(stages.right_consumer);
+            stages.striper->retire();
+            return SyncBundleResult::SKIPPED;
+        }
+    }
+
+    // Queue both frames on the output devices
+    int latency_front = 0, latency_right = 0;
+    stages.striper->write_bundle(front_frame, right_frame, latency_front, latency_right);
+
+    // Attach the arm state at the front frame's capture time
+    JointState joint_state;
+    bool has_joint_state = stages.joint_aligner &&
+        stages.joint_aligner->sample_at(front_frame.timestamp_us, joint_state);
+
+    // Log sync event to JSONL file
+    if (stages.sync_logger) {
+        stages.sync_logger->log_sync_event(
+            front_frame.timestamp_us,
+            front_frame.sequence_number,
+            right_frame.sequence_number,
+            front_frame.sequence_number,  // Use front frame's seq as aggregate seq
+            right_frame.timestamp_us,
+            has_joint_state ? &joint_state : nullptr
+        );
+    }
+
+    // Update performance monitor
+    if (stages.performance_monitor) {
+        ROBODAQ_ALLOC_STAGE(AllocStage::MONITOR);
+        stages.performance_monitor->tick({
+            {&front_frame.device_name, {front_frame.timestamp_us, front_frame.sequence_number, latency_front}},
+            {&right_frame.device_name, {right_frame.timestamp_us, right_frame.sequence_number, latency_right}}
+        });
+    }
+
+    stages.front_ring->release(stages.front_consumer);
+    stages.right_ring->release(stages.right_consumer);
+    // The striper keeps the slots until every device has written them
+    stages.striper->retire();
+    return SyncBundleResult::WRITTEN;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "broadcast_ring.hpp"
+#include "camera_capture_pipeline.hpp"
+#include "flight_recorder.hpp"
+#include "joint_state.hpp"
+#include "motion_gate.hpp"
+#include "output_striper.hpp"
+#include "performance_monitor.hpp"
+#include "sync_logger.hpp"
+#include "sync_matcher.hpp"
+#include "trace_probes.hpp"
+
+/*
+    One bundle of the sync thread: the oldest front frame is matched with a
+    right frame (SyncMatcher), passed through the motion gate, queued on
+    OutputStriper, logged, and both ring slots are released (the striper
+    keeps them until written; see OutputStriper::hold_rings).
+    Recorder::sync_thread_func calls sync_next_bundle() on every tick, and
+    recorder_e2e_bench --alloc-check drives the same function with
+    synthetic cameras, so the check measures the code that records.
+*/
+
+// SyncMatcher source over a camera ring's blocking sync consumer; fires
+// ring_pop once per new head and reports discards to the monitor, if any
+class SyncRingSource {
+    public:
+        SyncRingSource(BroadcastRing<CameraFrame>* ring, int consumer, PerformanceMonitor* monitor = nullptr)
+            : ring_(ring), consumer_(consumer), monitor_(monitor) {}
+
+        const CameraFrame* peek() {
+            const CameraFrame* frame = ring_ ? ring_->peek(consumer_) : nullptr;
+            if (frame && frame != last_peeked_) {
+                ROBODAQ_PROBE(ring_pop, frame->device_name.c_str(), frame->sequence_number, frame->timestamp_us, 1);
+                last_peeked_ = frame;
+            }
+            return frame;
+        }
+        const CameraFrame* peek_ahead(size_t n) { return ring_ ? ring_->peek_ahead(consumer_, n) : nullptr; }
+        // Only SyncMatcher releases through the source, so this is a discard
+        void release() {
+            const CameraFrame* frame = ring_->peek(consumer_);
+            if (frame) {
+                ROBODAQ_PROBE(sync_discard, frame->device_name.c_str(), frame->sequence_number, frame->timestamp_us);
+                if (monitor_) {
+                    monitor_->tick_unmatched(
+                        {&frame->device_name, {frame->timestamp_us, frame->sequence_number, 0}}, "sync_discard"
+                    );
+                }
+            }
+            ring_->release(consumer_);
+            last_peeked_ = nullptr;
+        }
+
+    private:
+        BroadcastRing<CameraFrame>* ring_;
+        int consumer_;
+        PerformanceMonitor* monitor_;
+        const CameraFrame* last_peeked_ = nullptr;
+};
+
+// Where a bundle comes from and goes to. The rings, matcher and striper are
+// required; a null optional stage is skipped.
+struct SyncBundleStages {
+    BroadcastRing<CameraFrame>* front_ring = nullptr;
+    int front_consumer = -1;
+    BroadcastRing<CameraFrame>* right_ring = nullptr;
+    int right_consumer = -1;
+    const SyncMatcher* matcher = nullptr;
+    OutputStriper* striper = nullptr;
+
+    MotionGate* motion_gate = nullptr;
+    SyncLogger* sync_logger = nullptr;
+    PerformanceMonitor* performance_monitor = nullptr;
+    FlightRecorder* flight_recorder = nullptr;
+    const JointStateAligner* joint_aligner = nullptr;
+};
+
+enum class SyncBundleResult {
+    NO_FRONT_FRAME,   // front ring empty, nothing consumed
+    SYNC_MISS,        // front frame had no right partner and was dropped
+    SKIPPED,          // matched, but the motion gate dropped it
+    WRITTEN
+};
+
+SyncBundleResult sync_next_bundle(const SyncBundleStages& stages);
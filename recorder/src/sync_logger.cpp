@@ -1,5 +1,13 @@
 #include "sync_logger.hpp"
 
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+#include "alloc_stats.hpp"
+#include "jsonl_parse.hpp"
+#include "trace_probes.hpp"
+
 SyncLogger::SyncLogger() {}
 
 bool SyncLogger::initialize(const std::string& path) {
@@ -15,25 +23,85 @@ bool SyncLogger::initialize(const std::string& path) {
     return true;
 }
 
-void SyncLogger::log_sync_event(uint64_t timestamp_us, uint64_t cam1_frame_id, uint64_t cam2_frame_id, uint64_t seq_num) {
+namespace {
+
+// snprintf at `used`, clamped so a truncated line still ends inside `size`
+size_t append(char* buf, size_t size, size_t used, const char* format, ...) {
+    if (used >= size) {
+        return used;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = std::vsnprintf(buf + used, size - used, format, args);
+    va_end(args);
+    if (n < 0) {
+        return used;
+    }
+    return std::min(used + static_cast<size_t>(n), size - 1);
+}
+
+}  // namespace
+
+void SyncLogger::write_line_(size_t length) {
+    log_file_.write(line_, static_cast<std::streamsize>(length));
+    log_file_.flush();  // Ensure data is written immediately
+    ROBODAQ_PROBE(log_flush, "sync", length);
+}
+
+void SyncLogger::log_sync_event(
+    uint64_t timestamp_us, uint64_t cam1_frame_id, uint64_t cam2_frame_id, uint64_t seq_num,
+    uint64_t cam2_timestamp_us, const JointState* joint_state
+) {
+    ROBODAQ_ALLOC_STAGE(AllocStage::LOG);
     if (!log_file_.is_open()) {
         std::cerr << "SyncLogger not initialized" << std::endl;
         return;
     }
     
-    // Create JSON line
-    std::ostringstream json_line;
-    json_line << "{"
-              << "\"timestamp\":" << timestamp_us << ","
-              << "\"cam1_frame_id\":" << cam1_frame_id << ","
-              << "\"cam2_frame_id\":" << cam2_frame_id << ","
-              << "\"seq_num\":" << seq_num
-              << "}" << std::endl;
-    
-    log_file_ << json_line.str();
-    log_file_.flush();  // Ensure data is written immediately
-    
-    // std::cout << "SYNC LOG: " << json_line.str().substr(0, json_line.str().length() - 1) << std::endl;
+    // Create JSON line; %g matches the ostream formatting of the joint floats
+    const size_t size = sizeof(line_) - 1;  // room for the newline
+    size_t used = append(line_, size, 0,
+        "{\"timestamp\":%llu,\"cam1_frame_id\":%llu,\"cam2_frame_id\":%llu,\"seq_num\":%llu,\"cam2_timestamp\":%llu",
+        static_cast<unsigned long long>(timestamp_us), static_cast<unsigned long long>(cam1_frame_id),
+        static_cast<unsigned long long>(cam2_frame_id), static_cast<unsigned long long>(seq_num),
+        static_cast<unsigned long long>(cam2_timestamp_us));
+    if (joint_state) {
+        used = append(line_, size, used, ",\"joint_seq\":%llu,\"joint_pos\":[",
+                      static_cast<unsigned long long>(joint_state->sequence_number));
+        for (int j = 0; j < NUM_JOINTS; j++) {
+            used = append(line_, size, used, j ? ",%g" : "%g", joint_state->position[j]);
+        }
+        used = append(line_, size, used, "],\"joint_cmd\":[");
+        for (int j = 0; j < NUM_JOINTS; j++) {
+            used = append(line_, size, used, j ? ",%g" : "%g", joint_state->command[j]);
+        }
+        used = append(line_, size, used, "]");
+    }
+    used = append(line_, size, used, "}");
+    line_[used++] = '\n';
+    write_line_(used);
+}
+
+void SyncLogger::log_skipped_run(
+    uint64_t first_timestamp_us, uint64_t last_timestamp_us,
+    uint64_t first_cam1_frame_id, uint64_t last_cam1_frame_id, uint64_t count
+) {
+    ROBODAQ_ALLOC_STAGE(AllocStage::LOG);
+    if (!log_file_.is_open()) {
+        std::cerr << "SyncLogger not initialized" << std::endl;
+        return;
+    }
+
+    const size_t size = sizeof(line_) - 1;
+    size_t used = append(line_, size, 0,
+        "{\"type\":\"%s\",\"skipped_first_timestamp\":%llu,\"skipped_last_timestamp\":%llu,"
+        "\"skipped_first_cam1_frame_id\":%llu,\"skipped_last_cam1_frame_id\":%llu,\"skipped_bundles\":%llu}",
+        SYNC_LOG_SKIPPED_RUN_TYPE,
+        static_cast<unsigned long long>(first_timestamp_us), static_cast<unsigned long long>(last_timestamp_us),
+        static_cast<unsigned long long>(first_cam1_frame_id), static_cast<unsigned long long>(last_cam1_frame_id),
+        static_cast<unsigned long long>(count));
+    line_[used++] = '\n';
+    write_line_(used);
 }
 
 void SyncLogger::finalize() {
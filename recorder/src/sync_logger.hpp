@@ -7,6 +7,8 @@
 #include <sstream>
 #include <cstdint>
 
+#include "joint_state.hpp"
+
 struct SyncEvent {
     uint64_t timestamp_us;
     uint64_t cam1_frame_id;  // front camera sequence number
@@ -18,12 +20,31 @@ class SyncLogger {
 private:
     std::ofstream log_file_;
     std::string output_path_;
+    // Lines are formatted here rather than in an ostringstream so logging a
+    // bundle doesn't allocate; a full joint_state line is well under 512 bytes
+    char line_[1024];
+
+    void write_line_(size_t length);
     
 public:
     SyncLogger();
     
     bool initialize(const std::string& path);
-    void log_sync_event(uint64_t timestamp_us, uint64_t cam1_frame_id, uint64_t cam2_frame_id, uint64_t seq_num);
+    // `timestamp_us` is the cam1 (front) capture time, `cam2_timestamp_us` the
+    // matched cam2 (right) capture time; replay uses both to reproduce timing.
+    // `joint_state` is the arm state aligned to this bundle, or nullptr if
+    // joint state isn't recorded / no sample was close enough.
+    void log_sync_event(
+        uint64_t timestamp_us, uint64_t cam1_frame_id, uint64_t cam2_frame_id, uint64_t seq_num,
+        uint64_t cam2_timestamp_us, const JointState* joint_state = nullptr
+    );
+    // Bundles the motion gate dropped between two logged ones, by front
+    // frame. Tagged "type":"skipped_run" (see sync_log_is_skipped_run() in
+    // jsonl_parse.hpp) and has no "timestamp" key.
+    void log_skipped_run(
+        uint64_t first_timestamp_us, uint64_t last_timestamp_us,
+        uint64_t first_cam1_frame_id, uint64_t last_cam1_frame_id, uint64_t count
+    );
     void finalize();
     
     ~SyncLogger();
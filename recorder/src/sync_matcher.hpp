@@ -0,0 +1,113 @@
+/*
+Goal: Pick, for each trigger frame (cam_front), the frame of another camera
+that belongs in the same recorder frame, as a component that can be driven by
+the live rings and by the offline simulator (scripts/sync_sim.cpp) alike, so
+the tolerance and policy can be tuned against synthetic streams instead of
+guessed.
+
+The matcher walks a candidate queue oldest-first. A candidate more than
+tolerance_us older than the trigger is discarded for good (a later trigger
+will be even further away). What happens next depends on the policy:
+
+- FIRST_WITHIN: the first candidate within tolerance wins. A candidate newer
+  than the tolerance window is discarded and the trigger misses. This is what
+  the recorder has always done.
+- KEEP_NEWER: as FIRST_WITHIN, but a too-new candidate stays queued for the
+  next trigger.
+- NEAREST: among consecutive candidates within tolerance, the one closest to
+  the trigger wins (looks one candidate ahead); too-new ones stay queued.
+
+On a match the chosen candidate is left at the head of the queue, so the
+caller can read it in place and release it once written.
+
+A Source provides, for items with a timestamp_us member:
+    const Item* peek();                  // head, nullptr if empty; idempotent
+    const Item* peek_ahead(size_t n);    // n-th after the head, nullptr if not there yet
+    void release();                      // drop the head
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+enum class SyncPolicy {
+    FIRST_WITHIN,
+    KEEP_NEWER,
+    NEAREST
+};
+
+inline const char* sync_policy_name(SyncPolicy policy) {
+    switch (policy) {
+        case SyncPolicy::FIRST_WITHIN: return "first-within";
+        case SyncPolicy::KEEP_NEWER: return "keep-newer";
+        case SyncPolicy::NEAREST: return "nearest";
+    }
+    return "?";
+}
+
+inline bool parse_sync_policy(const std::string& name, SyncPolicy& policy) {
+    for (SyncPolicy p : {SyncPolicy::FIRST_WITHIN, SyncPolicy::KEEP_NEWER, SyncPolicy::NEAREST}) {
+        if (name == sync_policy_name(p)) {
+            policy = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct SyncMatch {
+    bool matched = false;
+    int64_t skew_us = 0;        // candidate - trigger, valid if matched
+    uint32_t discarded = 0;     // candidates released while matching
+};
+
+class SyncMatcher {
+    public:
+        SyncMatcher(SyncPolicy policy, uint64_t tolerance_us)
+            : policy_(policy), tolerance_us_(static_cast<int64_t>(tolerance_us)) {}
+
+        template<typename Source>
+        SyncMatch match(uint64_t trigger_timestamp_us, Source& source) const;
+
+        SyncPolicy policy() const { return policy_; }
+        uint64_t tolerance_us() const { return static_cast<uint64_t>(tolerance_us_); }
+
+    private:
+        SyncPolicy policy_;
+        int64_t tolerance_us_;
+};
+
+template<typename Source>
+SyncMatch SyncMatcher::match(uint64_t trigger_timestamp_us, Source& source) const {
+    SyncMatch result;
+    const int64_t trigger = static_cast<int64_t>(trigger_timestamp_us);
+    while (const auto* candidate = source.peek()) {
+        const int64_t skew = static_cast<int64_t>(candidate->timestamp_us) - trigger;
+        if (std::llabs(skew) <= tolerance_us_) {
+            if (policy_ == SyncPolicy::NEAREST) {
+                const auto* next = source.peek_ahead(1);
+                if (next && std::llabs(static_cast<int64_t>(next->timestamp_us) - trigger) < std::llabs(skew)) {
+                    source.release();
+                    result.discarded++;
+                    continue;
+                }
+            }
+            result.matched = true;
+            result.skew_us = skew;
+            return result;
+        }
+        if (skew > 0) {
+            // Too new: this trigger has no partner
+            if (policy_ == SyncPolicy::FIRST_WITHIN) {
+                source.release();
+                result.discarded++;
+            }
+            return result;
+        }
+        source.release();
+        result.discarded++;
+    }
+    return result;
+}
@@ -0,0 +1,163 @@
+#include "timeline.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include "joint_state_writer.hpp"
+#include "jsonl_parse.hpp"
+#include "session_metadata.hpp"
+
+namespace {
+
+// Large sequential reads; the merge touches each file front to back once
+constexpr size_t TIMELINE_READ_BUFFER_SIZE = 1 << 20;
+
+bool file_exists(const std::string& path) {
+    std::ifstream f(path);
+    return f.good();
+}
+
+} // namespace
+
+const char* timeline_event_kind_name(TimelineEventKind kind) {
+    switch (kind) {
+        case TimelineEventKind::SYNC: return "sync";
+        case TimelineEventKind::EVENT: return "event";
+        case TimelineEventKind::JOINT_STATE: return "joint_state";
+    }
+    return "unknown";
+}
+
+JsonlTimelineSource::JsonlTimelineSource(
+    const std::string& name, const std::string& timestamp_key, TimelineEventKind kind
+) : name_(name), timestamp_key_(timestamp_key), kind_(kind), index_(0), skipped_lines_(0) {}
+
+bool JsonlTimelineSource::open(const std::string& path) {
+    read_buffer_.resize(TIMELINE_READ_BUFFER_SIZE);
+    file_.rdbuf()->pubsetbuf(read_buffer_.data(), read_buffer_.size());
+    file_.open(path);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JsonlTimelineSource::next(TimelineEvent& event) {
+    while (std::getline(file_, event.json)) {
+        if (event.json.empty()) {
+            continue;
+        }
+        if (!jsonl_get_uint(event.json, timestamp_key_.c_str(), event.timestamp_us)) {
+            skipped_lines_++;
+            continue;
+        }
+        event.kind = kind_;
+        event.index = index_++;
+        return true;
+    }
+    return false;
+}
+
+JointStateTimelineSource::JointStateTimelineSource() : name_("joint_state"), index_(0) {}
+
+bool JointStateTimelineSource::open(const std::string& path) {
+    file_.open(path, std::ios::in | std::ios::binary);
+    if (!file_.is_open()) {
+        std::cerr << "Failed to open " << path << std::endl;
+        return false;
+    }
+    JointStateFileHeader header;
+    if (!file_.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, JOINT_STATE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.record_size != sizeof(JointState)) {
+        std::cerr << "Not a joint state file: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+    return true;
+}
+
+bool JointStateTimelineSource::next(TimelineEvent& event) {
+    if (!file_.read(reinterpret_cast<char*>(&event.joint_state), sizeof(JointState))) {
+        return false;
+    }
+    event.timestamp_us = event.joint_state.timestamp_us;
+    event.kind = TimelineEventKind::JOINT_STATE;
+    event.index = index_++;
+    event.json.clear();
+    return true;
+}
+
+SessionTimeline::SessionTimeline() : out_of_order_count_(0), started_(false) {}
+
+void SessionTimeline::add_source(std::unique_ptr<TimelineSource> source) {
+    if (started_) {
+        std::cerr << "SessionTimeline: cannot add " << source->name() << " after iteration started" << std::endl;
+        return;
+    }
+    sources_.push_back(std::move(source));
+}
+
+bool SessionTimeline::open_session(const std::string& session_dir) {
+    auto sync_log = std::make_unique<JsonlTimelineSource>("sync_log", "timestamp", TimelineEventKind::SYNC);
+    if (sync_log->open(session_output_file(session_dir, "sync_log", "sync_log.jsonl"))) {
+        add_source(std::move(sync_log));
+    }
+
+    std::string events_path = session_output_file(session_dir, "events", "events.jsonl");
+    if (file_exists(events_path)) {
+        auto events = std::make_unique<JsonlTimelineSource>("events", "timestamp_us", TimelineEventKind::EVENT);
+        if (events->open(events_path)) {
+            add_source(std::move(events));
+        }
+    }
+
+    std::string joint_path = session_output_file(session_dir, "joint_state", "joint_state.bin");
+    if (file_exists(joint_path)) {
+        auto joints = std::make_unique<JointStateTimelineSource>();
+        if (joints->open(joint_path)) {
+            add_source(std::move(joints));
+        }
+    }
+
+    return !sources_.empty();
+}
+
+void SessionTimeline::advance_(size_t source) {
+    if (!sources_[source]->next(heads_[source])) {
+        return;
+    }
+    uint64_t ts = heads_[source].timestamp_us;
+    if (ts < last_timestamp_us_[source]) {
+        // Still emitted, just not in global order
+        out_of_order_count_++;
+    }
+    last_timestamp_us_[source] = ts;
+    heap_.push({ts, source});
+}
+
+bool SessionTimeline::next(TimelineEvent& event, const std::string** source_name) {
+    if (!started_) {
+        started_ = true;
+        heads_.resize(sources_.size());
+        last_timestamp_us_.assign(sources_.size(), 0);
+        for (size_t i = 0; i < sources_.size(); i++) {
+            advance_(i);
+        }
+    }
+    if (heap_.empty()) {
+        return false;
+    }
+
+    size_t source = heap_.top().source;
+    heap_.pop();
+    // Swap keeps the head's string capacity around for the next line
+    std::swap(event, heads_[source]);
+    if (source_name) {
+        *source_name = &sources_[source]->name();
+    }
+    advance_(source);
+    return true;
+}
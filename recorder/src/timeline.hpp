@@ -0,0 +1,126 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "joint_state.hpp"
+
+/*
+    Timestamp-ordered view over all streams of one recording directory.
+
+    Each stream is read by a TimelineSource in a single sequential pass and
+    holds exactly one look-ahead event; SessionTimeline k-way merges them with
+    a min-heap, so memory is O(number of streams) no matter how long the
+    session is. Every source must already be sorted by timestamp (true for
+    everything the recorder writes).
+
+    Video frames carry no timestamps of their own: row i of sync_log.jsonl is
+    frame i of every cam_*.mp4, so SYNC events double as video frame events
+    (TimelineEvent::index is the frame index).
+*/
+
+enum class TimelineEventKind {
+    SYNC,          // sync_log.jsonl row == one frame of each camera video
+    EVENT,         // events.jsonl row
+    JOINT_STATE,   // joint_state.bin record
+};
+
+const char* timeline_event_kind_name(TimelineEventKind kind);
+
+struct TimelineEvent {
+    uint64_t timestamp_us;
+    TimelineEventKind kind;
+    uint64_t index;           // row / record number within its stream
+    std::string json;         // original line for JSONL streams
+    JointState joint_state;   // valid for JOINT_STATE
+
+    TimelineEvent() : timestamp_us(0), kind(TimelineEventKind::SYNC), index(0) {}
+};
+
+class TimelineSource {
+public:
+    virtual ~TimelineSource() = default;
+    // Reads the next event. Returns false at end of stream.
+    virtual bool next(TimelineEvent& event) = 0;
+    virtual const std::string& name() const = 0;
+};
+
+// One JSON object per line with an integer microsecond timestamp field.
+class JsonlTimelineSource : public TimelineSource {
+private:
+    std::ifstream file_;
+    std::string name_;
+    std::string timestamp_key_;
+    TimelineEventKind kind_;
+    uint64_t index_;
+    uint64_t skipped_lines_;
+    std::vector<char> read_buffer_;
+
+public:
+    JsonlTimelineSource(const std::string& name, const std::string& timestamp_key, TimelineEventKind kind);
+
+    bool open(const std::string& path);
+    bool next(TimelineEvent& event) override;
+    const std::string& name() const override { return name_; }
+    uint64_t skipped_lines() const { return skipped_lines_; }
+};
+
+// joint_state.bin as written by JointStateWriter.
+class JointStateTimelineSource : public TimelineSource {
+private:
+    std::ifstream file_;
+    std::string name_;
+    uint64_t index_;
+
+public:
+    JointStateTimelineSource();
+
+    bool open(const std::string& path);
+    bool next(TimelineEvent& event) override;
+    const std::string& name() const override { return name_; }
+};
+
+class SessionTimeline {
+private:
+    struct HeapEntry {
+        uint64_t timestamp_us;
+        size_t source;
+        // Min-heap on time; ties go to the lower source index so the order is deterministic
+        bool operator>(const HeapEntry& other) const {
+            return timestamp_us != other.timestamp_us 
+                ? timestamp_us > other.timestamp_us : source > other.source;
+        }
+    };
+
+    std::vector<std::unique_ptr<TimelineSource>> sources_;
+    std::vector<TimelineEvent> heads_;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap_;
+    std::vector<uint64_t> last_timestamp_us_;
+    uint64_t out_of_order_count_;
+    bool started_;
+
+    void advance_(size_t source);
+
+public:
+    SessionTimeline();
+
+    // Adds a stream. Must be called before the first next().
+    void add_source(std::unique_ptr<TimelineSource> source);
+
+    // Opens every known stream present in `session_dir`. Missing optional
+    // streams (e.g. joint_state.bin) are skipped. Returns false if no stream
+    // could be opened.
+    bool open_session(const std::string& session_dir);
+
+    // Next event across all streams in timestamp order; false when all are exhausted.
+    // `source_name` is set to the stream the event came from.
+    bool next(TimelineEvent& event, const std::string** source_name = nullptr);
+
+    size_t num_sources() const { return sources_.size(); }
+    // Events whose timestamp went backwards within their own stream
+    uint64_t out_of_order_count() const { return out_of_order_count_; }
+};
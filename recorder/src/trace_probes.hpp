@@ -0,0 +1,46 @@
+/*
+Goal: Let us profile a production rig with eBPF (bpftrace, bcc) without a
+special build or a restart. Static USDT probes compile to a single NOP plus a
+note in the ELF; they cost nothing until a tracer attaches.
+
+Provider "robodaq". Probes and their arguments:
+
+    frame_arrival     camera, seq, capture_ts_us, bytes
+    ring_push         camera, seq, capture_ts_us, ok (1 pushed, 0 ring full)
+    ring_pop          camera, seq, capture_ts_us, ok (0 ring empty; seq/ts 0)
+    sync_match        front_seq, right_seq, front_ts_us, right_ts_us
+    sync_miss         front_seq, front_ts_us
+    sync_discard      camera, seq, capture_ts_us (dropped while matching)
+    bundle_skipped    front_seq, right_seq, front_ts_us, right_ts_us (motion gate)
+    convert_start     camera, seq, capture_ts_us
+    convert_end       camera, seq, capture_ts_us
+    encode_start      camera, seq, capture_ts_us
+    encode_end        camera, seq, capture_ts_us
+    frame_written     camera, seq, capture_ts_us (primary writer done)
+    log_flush         log ("sync", "events", "flight"), bytes
+
+camera is the device path as a C string (bpftrace: str(arg0)). Timestamps
+are the frame's capture time on the steady clock; durations come from the
+tracer's own clock (nsecs). Ready-made latency histograms live in
+recorder/scripts/bpftrace/.
+
+Probes need <sys/sdt.h> (systemtap-sdt-dev) at build time and nothing at run
+time. Without the header, or with -DRECORDER_USDT=OFF, they compile away.
+Probe arguments must stay cheap: they are evaluated even when no tracer is
+attached.
+*/
+
+#pragma once
+
+#if !defined(ROBODAQ_DISABLE_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define ROBODAQ_HAVE_USDT 1
+#endif
+#endif
+
+#ifdef ROBODAQ_HAVE_USDT
+#define ROBODAQ_PROBE(name, ...) STAP_PROBEV(robodaq, name, ##__VA_ARGS__)
+#else
+#define ROBODAQ_PROBE(name, ...) do {} while (0)
+#endif
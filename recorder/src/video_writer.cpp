@@ -1,13 +1,44 @@
 #include "video_writer.hpp"
 
-VideoWriter::VideoWriter() : is_initialized_(false) {}
+#include "alloc_stats.hpp"
+#include "trace_probes.hpp"
+
+namespace {
+
+uint64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+VideoWriter::VideoWriter() : is_initialized_(false), is_raw_(false) {}
 
 bool VideoWriter::initialize(const std::string& path, int width, int height, double fps, const std::string& codec) {
     output_path_ = path;
+    is_raw_ = (codec == RAW_VIDEO_CODEC);
+
+    if (is_raw_) {
+        raw_file_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!raw_file_.is_open()) {
+            std::cerr << "Failed to initialize raw VideoWriter for " << path << std::endl;
+            return false;
+        }
+        is_initialized_ = true;
+        std::cout << "VideoWriter initialized: " << path << " (raw " << width << "x" << height << " @ " << fps << "fps)" << std::endl;
+        return true;
+    }
     
-    // Create VideoWriter with specified codec
-    int fourcc = cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]);
-    writer_ = std::make_unique<cv::VideoWriter>(path, fourcc, fps, cv::Size(width, height));
+    if (codec == GST_X264_VIDEO_CODEC) {
+        // OpenCV feeds BGR into appsrc; the encoder wants I420
+        std::string pipeline = "appsrc ! videoconvert ! video/x-raw,format=I420 ! "
+            "x264enc speed-preset=ultrafast tune=zerolatency ! h264parse ! mp4mux ! filesink location=" + path;
+        writer_ = std::make_unique<cv::VideoWriter>(pipeline, cv::CAP_GSTREAMER, 0, fps, cv::Size(width, height));
+    } else {
+        // Create VideoWriter with specified codec
+        int fourcc = cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]);
+        writer_ = std::make_unique<cv::VideoWriter>(path, fourcc, fps, cv::Size(width, height));
+    }
     
     if (!writer_->isOpened()) {
         std::cerr << "Failed to initialize VideoWriter for " << path << std::endl;
@@ -19,50 +50,95 @@ bool VideoWriter::initialize(const std::string& path, int width, int height, dou
     return true;
 }
 
+bool VideoWriter::initialize_resized(
+    const std::string& path,
+    int source_width,
+    int source_height,
+    int width,
+    int height,
+    ResizeMode mode,
+    double fps,
+    const std::string& codec
+) {
+    resizer_ = std::make_unique<YuyvResizer>();
+    if (!resizer_->configure(source_width, source_height, width, height, mode)) {
+        std::cerr << "Can't resize " << source_width << "x" << source_height << " to "
+                  << width << "x" << height << " for " << path << std::endl;
+        resizer_.reset();
+        return false;
+    }
+    resized_bgr_.create(height, width, CV_8UC3);
+    return initialize(path, width, height, fps, codec);
+}
+
 bool VideoWriter::write_frame(const CameraFrame& frame, int& latency_us) {
-    if (!is_initialized_ || !writer_) {
+    if (!is_initialized_ || (!writer_ && !raw_file_.is_open())) {
         std::cerr << "VideoWriter not initialized" << std::endl;
         return false;
     }
+
+    if (resizer_) {
+        return write_resized_(frame, latency_us);
+    }
+
+    if (is_raw_) {
+        ROBODAQ_ALLOC_STAGE(AllocStage::ENCODE);
+        ROBODAQ_PROBE(encode_start, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+        uint64_t encode_start_ns = steady_now_ns();
+        raw_file_.write(reinterpret_cast<const char*>(frame.image_data.data()), frame.image_data.size());
+        last_timings_.convert_ns = 0;
+        last_timings_.encode_ns = steady_now_ns() - encode_start_ns;
+        ROBODAQ_PROBE(encode_end, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+        auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        latency_us = static_cast<int64_t>(now) - static_cast<int64_t>(frame.timestamp_us);
+        return raw_file_.good();
+    }
     
     // Convert based on explicit format
-    cv::Mat bgr_image;
+    ROBODAQ_PROBE(convert_start, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+    ROBODAQ_ALLOC_STAGE(AllocStage::CONVERT);
+    uint64_t convert_start_ns = steady_now_ns();
     
     switch (frame.format) {
         case CameraFormat::YUYV: {
             int expected_size = frame.width * frame.height * 2;
             
-            // Create YUYV Mat - OpenCV expects this as CV_8UC2
-            cv::Mat yuyv_image(frame.height, frame.width, CV_8UC2);
+            // YUYV Mat - OpenCV expects this as CV_8UC2; create() keeps the
+            // buffer from the previous frame when the size matches
+            source_image_.create(frame.height, frame.width, CV_8UC2);
             
             // Copy YUYV data
             size_t bytes_to_copy = std::min(frame.image_data.size(), (size_t)expected_size);
-            std::memcpy(yuyv_image.data, frame.image_data.data(), bytes_to_copy);
+            std::memcpy(source_image_.data, frame.image_data.data(), bytes_to_copy);
+            ROBODAQ_COUNT_COPY(bytes_to_copy);
             
             // Convert YUYV to BGR using OpenCV
-            cv::cvtColor(yuyv_image, bgr_image, cv::COLOR_YUV2BGR_YUY2);
+            cv::cvtColor(source_image_, bgr_image_, cv::COLOR_YUV2BGR_YUY2);
             break;
         }
         
         case CameraFormat::RGB: {
             int expected_size = frame.width * frame.height * 3;
             
-            cv::Mat rgb_image(frame.height, frame.width, CV_8UC3);
+            source_image_.create(frame.height, frame.width, CV_8UC3);
             size_t bytes_to_copy = std::min(frame.image_data.size(), (size_t)expected_size);
-            std::memcpy(rgb_image.data, frame.image_data.data(), bytes_to_copy);
+            std::memcpy(source_image_.data, frame.image_data.data(), bytes_to_copy);
+            ROBODAQ_COUNT_COPY(bytes_to_copy);
             
-            cv::cvtColor(rgb_image, bgr_image, cv::COLOR_RGB2BGR);
+            cv::cvtColor(source_image_, bgr_image_, cv::COLOR_RGB2BGR);
             break;
         }
         
         case CameraFormat::GRAY: {
             int expected_size = frame.width * frame.height;
             
-            cv::Mat gray_image(frame.height, frame.width, CV_8UC1);
+            source_image_.create(frame.height, frame.width, CV_8UC1);
             size_t bytes_to_copy = std::min(frame.image_data.size(), (size_t)expected_size);
-            std::memcpy(gray_image.data, frame.image_data.data(), bytes_to_copy);
+            std::memcpy(source_image_.data, frame.image_data.data(), bytes_to_copy);
+            ROBODAQ_COUNT_COPY(bytes_to_copy);
             
-            cv::cvtColor(gray_image, bgr_image, cv::COLOR_GRAY2BGR);
+            cv::cvtColor(source_image_, bgr_image_, cv::COLOR_GRAY2BGR);
             break;
         }
         
@@ -71,7 +147,17 @@ bool VideoWriter::write_frame(const CameraFrame& frame, int& latency_us) {
             return false;
     }
     
-    writer_->write(bgr_image);
+    uint64_t encode_start_ns = steady_now_ns();
+    last_timings_.convert_ns = encode_start_ns - convert_start_ns;
+    ROBODAQ_PROBE(convert_end, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+
+    {
+        ROBODAQ_ALLOC_STAGE(AllocStage::ENCODE);
+        ROBODAQ_PROBE(encode_start, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+        writer_->write(bgr_image_);
+        last_timings_.encode_ns = steady_now_ns() - encode_start_ns;
+        ROBODAQ_PROBE(encode_end, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+    }
 
     auto now = std::chrono::duration_cast<std::chrono::microseconds>(
         std::chrono::steady_clock::now().time_since_epoch()).count();
@@ -79,11 +165,54 @@ bool VideoWriter::write_frame(const CameraFrame& frame, int& latency_us) {
     return true;
 }
 
+bool VideoWriter::write_resized_(const CameraFrame& frame, int& latency_us) {
+    if (frame.format != CameraFormat::YUYV || frame.width != resizer_->source_width() ||
+        frame.height != resizer_->source_height() ||
+        frame.image_data.size() < static_cast<size_t>(frame.width) * frame.height * 2) {
+        std::cerr << "Resized output " << output_path_ << " needs " << resizer_->source_width() << "x"
+                  << resizer_->source_height() << " YUYV frames" << std::endl;
+        return false;
+    }
+
+    ROBODAQ_PROBE(convert_start, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+    uint64_t convert_start_ns = steady_now_ns();
+    {
+        ROBODAQ_ALLOC_STAGE(AllocStage::CONVERT);
+        // Straight from the ring slot into the preallocated output image
+        resizer_->resize_to_bgr(frame.image_data.data(), resized_bgr_.data);
+    }
+    uint64_t encode_start_ns = steady_now_ns();
+    last_timings_.convert_ns = encode_start_ns - convert_start_ns;
+    ROBODAQ_PROBE(convert_end, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+
+    bool ok = true;
+    {
+        ROBODAQ_ALLOC_STAGE(AllocStage::ENCODE);
+        ROBODAQ_PROBE(encode_start, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+        if (is_raw_) {
+            raw_file_.write(reinterpret_cast<const char*>(resized_bgr_.data), resized_bgr_.total() * resized_bgr_.elemSize());
+            ok = raw_file_.good();
+        } else {
+            writer_->write(resized_bgr_);
+        }
+        last_timings_.encode_ns = steady_now_ns() - encode_start_ns;
+        ROBODAQ_PROBE(encode_end, frame.device_name.c_str(), frame.sequence_number, frame.timestamp_us);
+    }
+
+    auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    latency_us = static_cast<int64_t>(now) - static_cast<int64_t>(frame.timestamp_us);
+    return ok;
+}
+
 void VideoWriter::finalize() {
     if (writer_) {
         writer_->release();
         writer_.reset();
     }
+    if (raw_file_.is_open()) {
+        raw_file_.close();
+    }
     is_initialized_ = false;
     std::cout << "VideoWriter finalized: " << output_path_ << std::endl;
 }
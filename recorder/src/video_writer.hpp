@@ -1,25 +1,69 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <fstream>
 #include <string>
 #include <memory>
 #include "camera_capture_pipeline.hpp"
+#include "frame_resize.hpp"
+
+// Codec name for lossless capture: frames are appended to the file exactly
+// as they came off the camera (e.g. back-to-back YUYV), no container.
+constexpr const char* RAW_VIDEO_CODEC = "raw";
+
+// Codec name for H.264 through a GStreamer pipeline (appsrc ! x264enc ! mp4mux).
+// Needs OpenCV built with GStreamer and the x264 plugin (gst-plugins-ugly).
+constexpr const char* GST_X264_VIDEO_CODEC = "x264";
+
+// Where the time of the last write_frame went
+struct WriteTimings {
+    uint64_t convert_ns = 0;   // copy into a Mat + colour conversion (0 for raw)
+    uint64_t encode_ns = 0;    // encoder / raw file write
+};
 
 class VideoWriter {
 private:
     std::unique_ptr<cv::VideoWriter> writer_;
+    std::ofstream raw_file_;
     std::string output_path_;
     bool is_initialized_;
+    bool is_raw_;
+    WriteTimings last_timings_;
+    // Reused across write_frame calls so steady-state writes don't allocate
+    cv::Mat source_image_;
+    cv::Mat bgr_image_;
+
+    // Set by initialize_resized: frames are scaled/cropped on the way in
+    std::unique_ptr<YuyvResizer> resizer_;
+    cv::Mat resized_bgr_;
+
+    bool write_resized_(const CameraFrame& frame, int& latency_us);
     
 public:
     VideoWriter();
     
     bool initialize(const std::string& path, int width, int height, double fps, const std::string& codec = "mp4v");
+    /*
+        Output of width x height fed with source_width x source_height YUYV
+        frames, converted in one fused resize+convert pass (YuyvResizer).
+        With the raw codec the file holds back-to-back BGR frames.
+    */
+    bool initialize_resized(
+        const std::string& path,
+        int source_width,
+        int source_height,
+        int width,
+        int height,
+        ResizeMode mode,
+        double fps,
+        const std::string& codec = "mp4v"
+    );
     /*
         Writes `frame` to video. Stores capture->disk latency in `latency_us`.
         Returns if the write is successful.
     */
     bool write_frame(const CameraFrame& frame, int& latency_us);
+    const WriteTimings& last_write_timings() const { return last_timings_; }
     void finalize();
     
     ~VideoWriter();
@@ -0,0 +1,76 @@
+/*
+    dataset_export: convert recording directories into the chunked,
+    mmap-friendly training format (see dataset_exporter.hpp).
+
+    Usage:
+      dataset_export --output <dir> [OPTIONS] <session_dir> [<session_dir> ...]
+*/
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dataset_exporter.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " --output <dir> [OPTIONS] <session_dir>...\n"
+              << "\nOptions:\n"
+              << "  --output <dir>        Dataset output directory (required)\n"
+              << "  --width <px>          Output frame width (default: 224)\n"
+              << "  --height <px>         Output frame height (default: 224)\n"
+              << "  --chunk-frames <n>    Frames per chunk file (default: 256)\n"
+              << "  --threads <n>         Worker threads (default: all cores)\n"
+              << "  --no-crop             Resize the full frame instead of center-cropping\n"
+              << "  --help                Show this help message\n"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ExportOptions options;
+    std::string output_dir;
+    std::vector<std::string> sessions;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--no-crop") {
+                options.center_crop = false;
+            } else if (arg == "--output" && i + 1 < argc) {
+                output_dir = argv[++i];
+            } else if (arg == "--width" && i + 1 < argc) {
+                options.width = std::stoi(argv[++i]);
+            } else if (arg == "--height" && i + 1 < argc) {
+                options.height = std::stoi(argv[++i]);
+            } else if (arg == "--chunk-frames" && i + 1 < argc) {
+                options.chunk_frames = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.num_threads = std::stoi(argv[++i]);
+            } else if (arg[0] != '-') {
+                sessions.push_back(arg);
+            } else {
+                std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid value for " << arg << "\n" << std::endl;
+            return 1;
+        }
+    }
+
+    if (output_dir.empty() || sessions.empty() || options.width <= 0 || 
+        options.height <= 0 || options.chunk_frames <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    DatasetExporter exporter(options);
+    return exporter.export_sessions(sessions, output_dir) ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/*
+    frame_tap: read live frames a running recorder publishes with --frame-shm.
+    Doubles as the reference reader for SharedFrameReader from another process.
+
+    Prints one JSON line per second: frames read, frames the reader skipped,
+    frames torn while being read, and publish-to-read latency. Optionally
+    saves frames (raw, as published) to a file.
+
+    Usage:
+      frame_tap [--shm <name>] [--count <n>] [--save <path>] [--latest]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "shared_frame_ring.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n"
+              << "\nOptions:\n"
+              << "  --shm <name>     Frame ring shm object (default: " << FRAME_SHM_DEFAULT_PREFIX << "_cam_front)\n"
+              << "  --count <n>      Stop after n frames (default: until the recorder stops)\n"
+              << "  --save <path>    Append each frame's raw bytes to this file\n"
+              << "  --latest         Only read the newest frame each time (like a viewer)\n"
+              << "  --help           Show this help message\n"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string shm_name = std::string(FRAME_SHM_DEFAULT_PREFIX) + "_cam_front";
+    uint64_t count = 0;
+    std::string save_path;
+    bool latest_only = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (arg == "--count" && i + 1 < argc) {
+            try {
+                count = std::stoull(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid count '" << argv[i] << "'\n" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--save" && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (arg == "--latest") {
+            latest_only = true;
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    SharedFrameReader reader;
+    if (!reader.open(shm_name)) {
+        std::cerr << "Is the recorder running with --frame-shm?" << std::endl;
+        return 1;
+    }
+
+    std::ofstream save;
+    if (!save_path.empty()) {
+        save.open(save_path, std::ios::binary);
+        if (!save) {
+            std::cerr << "Error: cannot write " << save_path << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t total_frames = 0;
+    uint64_t interval_frames = 0;
+    uint64_t torn_frames = 0;
+    double latency_sum_ms = 0.0;
+    double latency_max_ms = 0.0;
+    SharedFrameInfo last_info;
+    std::vector<uint8_t> frame_copy;
+    auto next_print = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+    while (count == 0 || total_frames < count) {
+        SharedFrameView view;
+        bool got = latest_only ? reader.latest(view) : reader.next(view);
+        if (got) {
+            double latency_ms = (frame_ring_now_ns() - view.info.publish_ns) / 1e6;
+            if (save.is_open()) {
+                frame_copy.assign(view.data, view.data + view.info.size_bytes);
+            }
+            // Anything read in place is only trustworthy if the slot wasn't reused meanwhile
+            if (!reader.still_valid(view)) {
+                torn_frames++;
+                continue;
+            }
+            if (save.is_open()) {
+                save.write(reinterpret_cast<const char*>(frame_copy.data()), frame_copy.size());
+            }
+            total_frames++;
+            interval_frames++;
+            latency_sum_ms += latency_ms;
+            latency_max_ms = std::max(latency_max_ms, latency_ms);
+            last_info = view.info;
+        } else if (reader.writer_closed()) {
+            break;
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(latest_only ? 10 : 1));
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_print) {
+            std::cout << "{\"frames\":" << interval_frames
+                      << ",\"total_frames\":" << total_frames
+                      << ",\"dropped\":" << reader.dropped()
+                      << ",\"torn\":" << torn_frames
+                      << ",\"mean_latency_ms\":" << (interval_frames ? latency_sum_ms / interval_frames : 0.0)
+                      << ",\"max_latency_ms\":" << latency_max_ms
+                      << ",\"last_sequence\":" << last_info.frame_sequence
+                      << ",\"size\":[" << last_info.width << "," << last_info.height << "]"
+                      << "}" << std::endl;
+            interval_frames = 0;
+            latency_sum_ms = 0.0;
+            latency_max_ms = 0.0;
+            next_print = now + std::chrono::seconds(1);
+        }
+    }
+
+    std::cout << "Read " << total_frames << " frames (" << reader.dropped() << " dropped, "
+              << torn_frames << " torn)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+    recorder_status: print the live status a running recorder publishes to
+    shared memory. Doubles as the reference reader for LatestValueMailbox from
+    another process (e.g. a C++ teleop loop).
+
+    Usage:
+      recorder_status [--shm <name>] [--watch] [--interval-ms <ms>]
+*/
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <cstdint>
+
+#include "latest_value_mailbox.hpp"
+#include "recorder_status.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS]\n"
+              << "\nOptions:\n"
+              << "  --shm <name>         Status shm object (default: " << RECORDER_STATUS_SHM_NAME << ")\n"
+              << "  --watch              Keep printing until interrupted\n"
+              << "  --interval-ms <ms>   Print interval with --watch (default: 500)\n"
+              << "  --help               Show this help message\n"
+              << std::endl;
+}
+
+uint64_t steady_now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void print_status(const RecorderStatus& status) {
+    uint64_t now_us = steady_now_us();
+    double age_ms = now_us > status.timestamp_us ? (now_us - status.timestamp_us) / 1000.0 : 0.0;
+    double elapsed_s = status.session_start_us && status.timestamp_us > status.session_start_us
+        ? (status.timestamp_us - status.session_start_us) / 1e6 : 0.0;
+    std::cout << "{\"recording\":" << (status.recording ? "true" : "false")
+              << ",\"age_ms\":" << age_ms
+              << ",\"elapsed_s\":" << elapsed_s
+              << ",\"frames_recorded\":" << status.frames_recorded
+              << ",\"ring_drops\":" << status.ring_drops
+              << ",\"seq_gaps\":[" << status.seq_gaps[0] << "," << status.seq_gaps[1] << "]"
+              << ",\"mean_latency_us\":[" << status.mean_latency_us[0] << "," << status.mean_latency_us[1] << "]"
+              << ",\"ring_fill\":[" << status.ring_fill[0] << "," << status.ring_fill[1] << "]"
+              << ",\"buffered_mb\":" << status.buffered_bytes / (1024.0 * 1024.0)
+              << ",\"memory_budget_mb\":" << status.memory_budget_bytes / (1024.0 * 1024.0)
+              << "}" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string shm_name = RECORDER_STATUS_SHM_NAME;
+    bool watch = false;
+    int interval_ms = 500;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg == "--shm" && i + 1 < argc) {
+            shm_name = argv[++i];
+        } else if (arg == "--interval-ms" && i + 1 < argc) {
+            try {
+                interval_ms = std::stoi(argv[++i]);
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid interval '" << argv[i] << "'\n" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--watch") {
+            watch = true;
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    LatestValueMailbox<RecorderStatus> mailbox;
+    if (!mailbox.open_shared(shm_name)) {
+        std::cerr << "Is the recorder running?" << std::endl;
+        return 1;
+    }
+
+    RecorderStatus status;
+    if (!watch) {
+        if (!mailbox.read(status)) {
+            std::cerr << "No status published yet" << std::endl;
+            return 1;
+        }
+        print_status(status);
+        return 0;
+    }
+
+    // Only print when the recorder has published something new
+    uint64_t last_version = 0;
+    while (true) {
+        uint64_t version = mailbox.version();
+        if (version != last_version && mailbox.read(status)) {
+            last_version = version;
+            print_status(status);
+            if (!status.recording) {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+
+    return 0;
+}
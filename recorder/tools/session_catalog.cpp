@@ -0,0 +1,251 @@
+/*
+    session_catalog: query the catalog.bin of a recordings directory (see
+    session_catalog.hpp), or rebuild it by scanning every session in it.
+
+    Usage:
+      session_catalog <recordings_dir> [FILTERS] [--count]
+      session_catalog <recordings_dir> --rebuild [--threads <n>]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+
+#include "session_catalog.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <recordings_dir> [OPTIONS]\n"
+              << "\nFilters:\n"
+              << "  --since <date>          Sessions started at or after YYYYMMDD[HHMMSS]\n"
+              << "  --until <date>          Sessions started at or before YYYYMMDD[HHMMSS]\n"
+              << "  --min-duration-s <s>    At least this long\n"
+              << "  --max-duration-s <s>    At most this long\n"
+              << "  --max-drop-rate <r>     Dropped camera frames over produced, 0-1\n"
+              << "  --size <WxH>            Both cameras at this resolution\n"
+              << "  --fps <n>               Both cameras at this frame rate\n"
+              << "  --raw-video             Only lossless (.yuyv) sessions\n"
+              << "  --joint-state           Only sessions with joint_state.bin\n"
+              << "  --no-errors             Skip sessions with pipeline errors\n"
+              << "\nOptions:\n"
+              << "  --count                 Print the number of matches instead of the sessions\n"
+              << "  --rebuild               Rescan every session directory and rewrite catalog.bin\n"
+              << "  --threads <n>           Rebuild worker threads (default: all cores)\n"
+              << "  --help                  Show this help message\n"
+              << std::endl;
+}
+
+struct CatalogFilter {
+    uint64_t since = 0;
+    uint64_t until = UINT64_MAX;
+    uint64_t min_duration_us = 0;
+    uint64_t max_duration_us = UINT64_MAX;
+    double max_drop_rate = 1.0;
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    uint32_t required_flags = 0;
+    uint32_t excluded_flags = 0;
+
+    bool matches(const SessionCatalogEntry& entry) const {
+        return entry.start_stamp >= since && entry.start_stamp <= until &&
+            entry.duration_us >= min_duration_us && entry.duration_us <= max_duration_us &&
+            (width == 0 || (entry.front_width == width && entry.right_width == width)) &&
+            (height == 0 || (entry.front_height == height && entry.right_height == height)) &&
+            (fps == 0 || (entry.front_fps == fps && entry.right_fps == fps)) &&
+            (entry.flags & required_flags) == required_flags && (entry.flags & excluded_flags) == 0 &&
+            session_catalog_drop_rate(entry) <= max_drop_rate;
+    }
+};
+
+// YYYYMMDD or YYYYMMDDHHMMSS -> YYYYMMDDHHMMSS, filling the time for a bare date
+uint64_t parse_date(const std::string& value, bool end_of_day) {
+    if ((value.size() != 8 && value.size() != 14) ||
+        !std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        throw std::invalid_argument(value);
+    }
+    const uint64_t stamp = std::stoull(value);
+    return value.size() == 14 ? stamp : stamp * 1'000'000 + (end_of_day ? 235959 : 0);
+}
+
+void print_entry(const SessionCatalogEntry& entry) {
+    std::cout << "{\"session\":\"" << std::string(entry.name, strnlen(entry.name, sizeof(entry.name))) << "\""
+              << ",\"start\":" << entry.start_stamp
+              << ",\"duration_s\":" << entry.duration_us / 1e6
+              << ",\"bundles\":" << entry.bundles
+              << ",\"skipped_bundles\":" << entry.skipped_bundles
+              << ",\"drops\":[" << entry.front_drops << "," << entry.right_drops << "]"
+              << ",\"drop_rate\":" << session_catalog_drop_rate(entry)
+              << ",\"front\":\"" << entry.front_width << "x" << entry.front_height << "@" << entry.front_fps << "\""
+              << ",\"right\":\"" << entry.right_width << "x" << entry.right_height << "@" << entry.right_fps << "\""
+              << ",\"raw_video\":" << ((entry.flags & SESSION_CATALOG_RAW_VIDEO) ? "true" : "false")
+              << ",\"joint_state\":" << ((entry.flags & SESSION_CATALOG_JOINT_STATE) ? "true" : "false")
+              << ",\"pipeline_errors\":" << ((entry.flags & SESSION_CATALOG_PIPELINE_ERRORS) ? "true" : "false")
+              << "}\n";
+}
+
+int rebuild_locked(const std::string& recordings_dir, const std::string& catalog_path, int num_threads) {
+    std::vector<std::string> sessions;
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(recordings_dir, error)) {
+        if (item.is_directory() && std::filesystem::exists(item.path() / "metadata.json")) {
+            sessions.push_back(item.path().string());
+        }
+    }
+    if (error) {
+        std::cerr << "Failed to list " << recordings_dir << ": " << error.message() << std::endl;
+        return 1;
+    }
+    std::sort(sessions.begin(), sessions.end());
+
+    std::vector<SessionCatalogEntry> entries(sessions.size());
+    std::vector<char> valid(sessions.size(), 0);
+    std::atomic<size_t> next_session{0};
+    auto worker = [&]() {
+        for (size_t s; (s = next_session.fetch_add(1)) < sessions.size();) {
+            valid[s] = session_catalog_entry(sessions[s], entries[s]);
+        }
+    };
+    if (num_threads <= 0) {
+        num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    num_threads = std::max(1, std::min(num_threads, static_cast<int>(sessions.size())));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<SessionCatalogEntry> catalog;
+    for (size_t s = 0; s < sessions.size(); s++) {
+        if (valid[s]) {
+            catalog.push_back(entries[s]);
+        } else {
+            std::cerr << "Skipping " << sessions[s] << std::endl;
+        }
+    }
+    if (!write_session_catalog(catalog_path, catalog)) {
+        return 1;
+    }
+    std::cout << "Catalog rebuilt: " << catalog.size() << " of " << sessions.size()
+              << " sessions -> " << catalog_path << std::endl;
+    return 0;
+}
+
+int rebuild(const std::string& recordings_dir, int num_threads) {
+    // Recorders finishing a session block on this until the new file is in place
+    const std::string catalog_path = recordings_dir + "/" + SESSION_CATALOG_FILE_NAME;
+    const int lock_fd = lock_session_catalog(catalog_path);
+    if (lock_fd < 0) {
+        return 1;
+    }
+    const int status = rebuild_locked(recordings_dir, catalog_path, num_threads);
+    close(lock_fd);
+    return status;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string recordings_dir;
+    CatalogFilter filter;
+    bool count_only = false;
+    bool rebuild_catalog = false;
+    int num_threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--count") {
+                count_only = true;
+            } else if (arg == "--rebuild") {
+                rebuild_catalog = true;
+            } else if (arg == "--raw-video") {
+                filter.required_flags |= SESSION_CATALOG_RAW_VIDEO;
+            } else if (arg == "--joint-state") {
+                filter.required_flags |= SESSION_CATALOG_JOINT_STATE;
+            } else if (arg == "--no-errors") {
+                filter.excluded_flags |= SESSION_CATALOG_PIPELINE_ERRORS;
+            } else if (arg == "--since" && i + 1 < argc) {
+                filter.since = parse_date(argv[++i], false);
+            } else if (arg == "--until" && i + 1 < argc) {
+                filter.until = parse_date(argv[++i], true);
+            } else if (arg == "--min-duration-s" && i + 1 < argc) {
+                filter.min_duration_us = static_cast<uint64_t>(std::stod(argv[++i]) * 1e6);
+            } else if (arg == "--max-duration-s" && i + 1 < argc) {
+                filter.max_duration_us = static_cast<uint64_t>(std::stod(argv[++i]) * 1e6);
+            } else if (arg == "--max-drop-rate" && i + 1 < argc) {
+                filter.max_drop_rate = std::stod(argv[++i]);
+            } else if (arg == "--size" && i + 1 < argc) {
+                const std::string size = argv[++i];
+                const size_t x = size.find('x');
+                if (x == std::string::npos) {
+                    throw std::invalid_argument(size);
+                }
+                filter.width = std::stoi(size.substr(0, x));
+                filter.height = std::stoi(size.substr(x + 1));
+            } else if (arg == "--fps" && i + 1 < argc) {
+                filter.fps = std::stoi(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                num_threads = std::stoi(argv[++i]);
+            } else if (recordings_dir.empty() && arg[0] != '-') {
+                recordings_dir = arg;
+            } else {
+                std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid value for " << arg << ": '" << argv[i] << "'\n" << std::endl;
+            return 1;
+        }
+    }
+    if (recordings_dir.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (rebuild_catalog) {
+        return rebuild(recordings_dir, num_threads);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    SessionCatalog catalog;
+    if (!catalog.open(recordings_dir + "/" + SESSION_CATALOG_FILE_NAME)) {
+        std::cerr << "Run " << argv[0] << " " << recordings_dir << " --rebuild to create it" << std::endl;
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    const std::vector<size_t> current = catalog.latest();
+    size_t matches = 0;
+    for (size_t index : current) {
+        const SessionCatalogEntry& entry = catalog.entries()[index];
+        if (!filter.matches(entry)) {
+            continue;
+        }
+        matches++;
+        if (!count_only) {
+            print_entry(entry);
+        }
+    }
+    if (count_only) {
+        std::cout << matches << std::endl;
+    }
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << matches << " of " << current.size() << " sessions in " << elapsed_ms << " ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+    session_compact: convert recording directories' sync_log.jsonl and
+    events.jsonl into session_columns.bin (see session_columns.hpp), then
+    optionally scan the columns for per-session QC numbers.
+
+    Usage:
+      session_compact [OPTIONS] <session_dir> [<session_dir> ...]
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "session_columns.hpp"
+#include "session_metadata.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [OPTIONS] <session_dir>...\n"
+              << "\nOptions:\n"
+              << "  --force               Rebuild even if the columns file is newer than the logs\n"
+              << "  --scan                Print one JSON line of QC numbers per session\n"
+              << "  --skew-over-us <us>   With --scan, count bundles with |skew| above this (default: 5000)\n"
+              << "  --threads <n>         Worker threads (default: all cores)\n"
+              << "  --help                Show this help message\n"
+              << std::endl;
+}
+
+bool is_stale(const std::string& columns_path, const std::vector<std::string>& sources) {
+    std::error_code error;
+    const auto built = std::filesystem::last_write_time(columns_path, error);
+    if (error) {
+        return true;
+    }
+    for (const std::string& source : sources) {
+        const auto modified = std::filesystem::last_write_time(source, error);
+        if (!error && modified > built) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Frames missing between consecutive rows of a sequence-number column
+int64_t count_gaps(const ColumnView& seq) {
+    int64_t gaps = 0;
+    for (uint64_t i = 1; i < seq.rows; i++) {
+        const int64_t step = seq.values[i] - seq.values[i - 1];
+        gaps += step > 1 ? step - 1 : 0;
+    }
+    return gaps;
+}
+
+// Rows of one event type with first_us < timestamp_us < last_us
+int64_t count_events(const SessionColumns& columns, const char* type, int64_t first_us, int64_t last_us) {
+    const std::vector<std::string>& types = columns.event_types();
+    const auto it = std::find(types.begin(), types.end(), type);
+    if (it == types.end()) {
+        return 0;
+    }
+    const int64_t index = it - types.begin();
+    const ColumnView event_ts = columns.column(COLUMN_EVENTS_TIMESTAMP_US);
+    const ColumnView event_type = columns.column(COLUMN_EVENTS_TYPE);
+    int64_t count = 0;
+    for (uint64_t i = 0; i < event_type.rows; i++) {
+        count += event_type.values[i] == index && event_ts.values[i] > first_us && event_ts.values[i] < last_us;
+    }
+    return count;
+}
+
+// Camera drops: gaps between written bundles, less the frames that reached
+// the sync thread and were dropped there on purpose (skipped by the motion
+// gate, or released by the matcher without a partner)
+int64_t count_drops(const ColumnView& seq, int64_t gated, int64_t unmatched) {
+    return std::max<int64_t>(0, count_gaps(seq) - gated - unmatched);
+}
+
+std::string scan_session(const std::string& session_dir, const SessionColumns& columns, int64_t skew_threshold_us) {
+    const ColumnView front_ts = columns.column(COLUMN_SYNC_FRONT_TIMESTAMP_US);
+    const ColumnView skew = columns.column(COLUMN_SYNC_SKEW_US);
+    const ColumnView skipped = columns.column(COLUMN_SKIPPED_COUNT);
+    const ColumnView events = columns.column(COLUMN_EVENTS_TYPE);
+
+    int64_t max_interval_us = 0;
+    for (uint64_t i = 1; i < front_ts.rows; i++) {
+        max_interval_us = std::max(max_interval_us, front_ts.values[i] - front_ts.values[i - 1]);
+    }
+    const double mean_interval_us = front_ts.rows > 1
+        ? static_cast<double>(front_ts.values[front_ts.rows - 1] - front_ts.values[0]) / (front_ts.rows - 1) : 0.0;
+
+    // Whole blocks within +-threshold are skipped on their stats alone
+    int64_t skew_min = 0, skew_max = 0, skew_sum = 0, skew_over = 0;
+    for (uint32_t b = 0; b < skew.num_blocks; b++) {
+        const ColumnBlockStats& block = skew.blocks[b];
+        skew_min = b ? std::min(skew_min, block.min) : block.min;
+        skew_max = b ? std::max(skew_max, block.max) : block.max;
+        const uint64_t begin = static_cast<uint64_t>(b) * skew.block_rows;
+        const uint64_t end = std::min(skew.rows, begin + skew.block_rows);
+        int64_t block_sum = 0;
+        for (uint64_t i = begin; i < end; i++) {
+            block_sum += skew.values[i];
+        }
+        skew_sum += block_sum;
+        if (block.max <= skew_threshold_us && block.min >= -skew_threshold_us) {
+            continue;
+        }
+        for (uint64_t i = begin; i < end; i++) {
+            skew_over += skew.values[i] > skew_threshold_us || skew.values[i] < -skew_threshold_us;
+        }
+    }
+
+    // Gated bundles and matcher drops only open gaps between the first and
+    // last written bundle
+    const ColumnView right_ts = columns.column(COLUMN_SYNC_RIGHT_TIMESTAMP_US);
+    const ColumnView skipped_first = columns.column(COLUMN_SKIPPED_FIRST_TIMESTAMP_US);
+    const ColumnView skipped_last = columns.column(COLUMN_SKIPPED_LAST_TIMESTAMP_US);
+    const int64_t first_us = front_ts.rows ? front_ts.values[0] : 0;
+    const int64_t last_us = front_ts.rows ? front_ts.values[front_ts.rows - 1] : 0;
+    int64_t skipped_bundles = 0, gated = 0;
+    for (uint64_t i = 0; i < skipped.rows; i++) {
+        skipped_bundles += skipped.values[i];
+        if (skipped_first.values[i] > first_us && skipped_last.values[i] < last_us) {
+            gated += skipped.values[i];
+        }
+    }
+    const int64_t sync_misses = count_events(columns, "sync_miss", first_us, last_us);
+    const int64_t sync_discards = right_ts.rows
+        ? count_events(columns, "sync_discard", right_ts.values[0], right_ts.values[right_ts.rows - 1]) : 0;
+
+    std::ostringstream json;
+    json << "{\"session\":\"" << session_dir << "\""
+         << ",\"bundles\":" << front_ts.rows
+         << ",\"front_drops\":" << count_drops(columns.column(COLUMN_SYNC_FRONT_SEQ), gated, sync_misses)
+         << ",\"right_drops\":" << count_drops(columns.column(COLUMN_SYNC_RIGHT_SEQ), gated, sync_discards)
+         << ",\"skipped_bundles\":" << skipped_bundles
+         << ",\"sync_misses\":" << sync_misses
+         << ",\"sync_discards\":" << sync_discards
+         << ",\"interval_us\":{\"mean\":" << mean_interval_us << ",\"max\":" << max_interval_us << "}"
+         << ",\"skew_us\":{\"min\":" << skew_min << ",\"max\":" << skew_max
+         << ",\"mean\":" << (skew.rows ? static_cast<double>(skew_sum) / skew.rows : 0.0)
+         << ",\"over_threshold\":" << skew_over << "}"
+         << ",\"events\":" << events.rows
+         << "}";
+    return json.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> sessions;
+    bool force = false;
+    bool scan = false;
+    int64_t skew_threshold_us = 5000;
+    int num_threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "--force") {
+                force = true;
+            } else if (arg == "--scan") {
+                scan = true;
+            } else if (arg == "--skew-over-us" && i + 1 < argc) {
+                skew_threshold_us = std::stoll(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                num_threads = std::stoi(argv[++i]);
+            } else if (arg[0] != '-') {
+                sessions.push_back(arg);
+            } else {
+                std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: Invalid value for " << arg << ": '" << argv[i] << "'\n" << std::endl;
+            return 1;
+        }
+    }
+    if (sessions.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (num_threads <= 0) {
+        num_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    num_threads = std::min(num_threads, static_cast<int>(sessions.size()));
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> results(sessions.size());
+    std::atomic<size_t> next_session{0};
+    std::atomic<int> failures{0};
+    std::atomic<int> compacted{0};
+    std::atomic<uint64_t> rows{0};
+    std::atomic<uint64_t> source_bytes{0};
+
+    auto worker = [&]() {
+        for (size_t s; (s = next_session.fetch_add(1)) < sessions.size();) {
+            const std::string& session_dir = sessions[s];
+            const std::string sync_log_path = session_output_file(session_dir, "sync_log", "sync_log.jsonl");
+            const std::string events_path = session_output_file(session_dir, "events", "events.jsonl");
+            const std::string columns_path = session_output_file(session_dir, "columns", SESSION_COLUMNS_FILE_NAME);
+            if (force || is_stale(columns_path, {sync_log_path, events_path})) {
+                if (!compact_session_logs(sync_log_path, events_path, columns_path)) {
+                    failures++;
+                    continue;
+                }
+                compacted++;
+            }
+            if (!scan) {
+                continue;
+            }
+            SessionColumns columns;
+            if (!columns.open(columns_path)) {
+                failures++;
+                continue;
+            }
+            results[s] = scan_session(session_dir, columns, skew_threshold_us);
+            rows += columns.column(COLUMN_SYNC_FRONT_TIMESTAMP_US).rows;
+            source_bytes += columns.source_bytes();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const std::string& result : results) {
+        if (!result.empty()) {
+            std::cout << result << "\n";
+        }
+    }
+    const double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << sessions.size() << " sessions (" << compacted.load() << " compacted, " << failures.load()
+              << " failed) in " << elapsed_ms << " ms";
+    if (scan) {
+        std::cerr << ", scanned " << rows.load() << " bundles from " << source_bytes.load() / 1e6 << " MB of logs";
+    }
+    std::cerr << std::endl;
+    return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/*
+    session_timeline: print every stream of a recording directory as one
+    timestamp-ordered JSONL stream.
+
+    Usage:
+      session_timeline <session_dir> [--from-us <ts>] [--to-us <ts>] [--only <kind>] [--count]
+*/
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include "timeline.hpp"
+
+namespace {
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " <session_dir> [OPTIONS]\n"
+              << "\nOptions:\n"
+              << "  --from-us <ts>   Skip events before this timestamp (us)\n"
+              << "  --to-us <ts>     Stop at the first event after this timestamp (us)\n"
+              << "  --only <kind>    Only print sync | event | joint_state\n"
+              << "  --count          Print per-kind counts instead of events\n"
+              << "  --help           Show this help message\n"
+              << std::endl;
+}
+
+void print_event(const TimelineEvent& event, const std::string& source_name) {
+    std::cout << "{\"timestamp_us\":" << event.timestamp_us
+              << ",\"source\":\"" << source_name << "\""
+              << ",\"kind\":\"" << timeline_event_kind_name(event.kind) << "\""
+              << ",\"index\":" << event.index;
+    if (event.kind == TimelineEventKind::JOINT_STATE) {
+        std::cout << ",\"record\":{\"seq\":" << event.joint_state.sequence_number << ",\"pos\":[";
+        for (int j = 0; j < NUM_JOINTS; j++) {
+            std::cout << (j ? "," : "") << event.joint_state.position[j];
+        }
+        std::cout << "],\"cmd\":[";
+        for (int j = 0; j < NUM_JOINTS; j++) {
+            std::cout << (j ? "," : "") << event.joint_state.command[j];
+        }
+        std::cout << "]}";
+    } else {
+        std::cout << ",\"record\":" << event.json;
+    }
+    std::cout << "}\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string session_dir;
+    uint64_t from_us = 0;
+    uint64_t to_us = UINT64_MAX;
+    std::string only;
+    bool count_only = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if ((arg == "--from-us" || arg == "--to-us" || arg == "--only") && i + 1 < argc) {
+            std::string value = argv[++i];
+            try {
+                if (arg == "--from-us") from_us = std::stoull(value);
+                else if (arg == "--to-us") to_us = std::stoull(value);
+                else only = value;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: Invalid value for " << arg << ": '" << value << "'\n" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--count") {
+            count_only = true;
+        } else if (session_dir.empty() && arg[0] != '-') {
+            session_dir = arg;
+        } else {
+            std::cerr << "Error: Unknown argument '" << arg << "'\n" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (session_dir.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    SessionTimeline timeline;
+    if (!timeline.open_session(session_dir)) {
+        std::cerr << "No streams found in " << session_dir << std::endl;
+        return 1;
+    }
+
+    std::ios::sync_with_stdio(false);
+    uint64_t counts[3] = {0, 0, 0};
+    TimelineEvent event;
+    const std::string* source_name = nullptr;
+    while (timeline.next(event, &source_name)) {
+        if (event.timestamp_us < from_us) {
+            continue;
+        }
+        if (event.timestamp_us > to_us) {
+            break;
+        }
+        if (!only.empty() && only != timeline_event_kind_name(event.kind)) {
+            continue;
+        }
+        if (count_only) {
+            counts[static_cast<int>(event.kind)]++;
+        } else {
+            print_event(event, *source_name);
+        }
+    }
+
+    if (count_only) {
+        std::cout << "{\"sync\":" << counts[0] << ",\"event\":" << counts[1] 
+                  << ",\"joint_state\":" << counts[2] << "}" << std::endl;
+    }
+    if (timeline.out_of_order_count() > 0) {
+        std::cerr << "Warning: " << timeline.out_of_order_count() 
+                  << " events were out of order within their own stream" << std::endl;
+    }
+    return 0;
+}
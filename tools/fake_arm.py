@@ -0,0 +1,52 @@
+"""Fake SO-101 arm controller on a pty.
+
+Streams joint state lines in the recorder's serial protocol
+("J <pos0..pos5> <cmd0..cmd5>") so the recorder's joint state path can be
+exercised without the real arm:
+
+    python3 tools/fake_arm.py --rate 200
+    recorder --output-dir ./recordings --joint-device <printed pty path>
+"""
+import argparse, math, os, time, tty
+
+NUM_JOINTS = 6
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--rate", type=float, default=200.0, help="samples per second (100-500 on the real arm)")
+    ap.add_argument("--link", default="", help="optional symlink to create for the pty, e.g. /tmp/fake_arm")
+    args = ap.parse_args()
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    slave_path = os.ttyname(slave)
+    if args.link:
+        if os.path.lexists(args.link):
+            os.remove(args.link)
+        os.symlink(slave_path, args.link)
+    print(f"Fake arm streaming at {args.rate:.0f} Hz on {args.link or slave_path}", flush=True)
+
+    period = 1.0 / args.rate
+    t0 = time.monotonic()
+    i = 0
+    try:
+        while True:
+            t = i * period
+            cmd = [30.0 * math.sin(2 * math.pi * 0.2 * t + j) for j in range(NUM_JOINTS)]
+            # Position lags the command a little, like a real servo
+            pos = [30.0 * math.sin(2 * math.pi * 0.2 * (t - 0.05) + j) for j in range(NUM_JOINTS)]
+            line = "J " + " ".join(f"{v:.3f}" for v in pos + cmd) + "\n"
+            try:
+                os.write(master, line.encode())
+            except BlockingIOError:
+                pass
+            i += 1
+            time.sleep(max(0.0, t0 + i * period - time.monotonic()))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if args.link and os.path.islink(args.link):
+            os.remove(args.link)
+
+if __name__ == "__main__":
+    main()
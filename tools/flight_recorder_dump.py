@@ -0,0 +1,92 @@
+"""Decode the recorder's flight recorder ring file after a crash or incident.
+
+    python3 tools/flight_recorder_dump.py recordings/flight_recorder.bin
+    python3 tools/flight_recorder_dump.py recordings/flight_recorder.bin --last-seconds 60 --type event
+    python3 tools/flight_recorder_dump.py recordings/flight_recorder.bin --summary
+
+Prints one JSON object per record, oldest first. Layout matches
+recorder/src/flight_recorder.hpp. Timestamps are steady_clock (reset at
+boot); records after a surviving process_start event also get "wall_time",
+from the wall clock that event recorded.
+"""
+import argparse, datetime, json, struct, sys
+
+MAGIC = b"RDFR"
+HEADER = struct.Struct("<4sIIIQQQ")   # magic, version, record_size, reserved, capacity, realtime/monotonic anchor
+CURSOR_OFFSET = 64
+HEADER_SIZE = 4096
+RECORD = struct.Struct("<QQQHHI32s")  # commit, timestamp_us, seq, type, source, payload_size, payload
+NUM_JOINTS = 6
+
+TYPES = {1: "robot_state", 2: "teleop_command", 3: "event", 4: "metrics"}
+EVENTS = {1: "process_start", 2: "session_start", 3: "session_stop", 4: "frame_drop", 5: "sync_miss"}
+
+def decode_payload(rtype, payload):
+    if rtype == 1:
+        return {"position": [round(v, 3) for v in struct.unpack_from(f"<{NUM_JOINTS}f", payload)]}
+    if rtype == 2:
+        return {"command": [round(v, 3) for v in struct.unpack_from(f"<{NUM_JOINTS}f", payload)]}
+    if rtype == 3:
+        code, _, arg, text = struct.unpack_from("<IIQ16s", payload)
+        return {"event": EVENTS.get(code, code), "arg": arg,
+                "text": text.split(b"\0", 1)[0].decode(errors="replace")}
+    if rtype == 4:
+        frames, gap_f, gap_r, lat_f, lat_r, drops = struct.unpack_from("<IIIffI", payload)
+        return {"total_frames": frames, "seq_gaps": [gap_f, gap_r],
+                "mean_latency_us": [round(lat_f, 1), round(lat_r, 1)], "ring_drops": drops}
+    return {"raw": payload.hex()}
+
+def read_records(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, record_size, _, capacity, _, _ = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or record_size != RECORD.size:
+        sys.exit(f"{path}: not a flight recorder file (magic={magic!r}, record_size={record_size})")
+    (cursor,) = struct.unpack_from("<Q", data, CURSOR_OFFSET)
+    records = []
+    wall_offset_us = None  # CLOCK_REALTIME - steady_clock of the process that wrote the record
+    for slot in range(max(0, cursor - capacity), cursor):
+        off = HEADER_SIZE + (slot % capacity) * RECORD.size
+        commit, ts, seq, rtype, source, size, payload = RECORD.unpack_from(data, off)
+        if commit != slot + 1:
+            continue  # being written when the process died, or overwritten since
+        rec = {"slot": slot, "timestamp_us": ts, "type": TYPES.get(rtype, rtype), "source": source}
+        if seq:
+            rec["sequence_number"] = seq
+        rec.update(decode_payload(rtype, payload[:size]))
+        if rec.get("event") == "process_start":
+            wall_offset_us = rec["arg"] - ts if rec["arg"] else None
+        if wall_offset_us is not None:
+            rec["wall_time"] = datetime.datetime.fromtimestamp(
+                (ts + wall_offset_us) / 1e6, datetime.timezone.utc).isoformat()
+        records.append(rec)
+    return records, capacity, cursor
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("path")
+    ap.add_argument("--last-seconds", type=float, default=0, help="only records this close to the newest one")
+    ap.add_argument("--type", choices=sorted(TYPES.values()), action="append", help="filter by record type")
+    ap.add_argument("--summary", action="store_true", help="print counts and time span instead of records")
+    args = ap.parse_args()
+
+    records, capacity, cursor = read_records(args.path)
+    if records and args.last_seconds > 0:
+        newest = max(r["timestamp_us"] for r in records)
+        records = [r for r in records if newest - r["timestamp_us"] <= args.last_seconds * 1e6]
+    if args.type:
+        records = [r for r in records if r["type"] in args.type]
+
+    if args.summary:
+        counts = {}
+        for r in records:
+            counts[r["type"]] = counts.get(r["type"], 0) + 1
+        span = (records[-1]["timestamp_us"] - records[0]["timestamp_us"]) / 1e6 if records else 0
+        print(json.dumps({"capacity": capacity, "records_written": cursor, "records_valid": len(records),
+                          "span_seconds": round(span, 3), "counts": counts}, indent=2))
+        return
+    for r in records:
+        print(json.dumps(r))
+
+if __name__ == "__main__":
+    main()